@@ -0,0 +1,55 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "board.h"
+#include <stdint.h>
+
+/* Autopiloto de um pacman (--autopilot): a cada jogada, uma procura em árvore
+   de Monte Carlo (UCT) sobre as jogadas do pacman (W, S, A, D ou ficar).
+   Cada playout copia o estado atual para uma cópia privada (sim_clone, ver
+   sim.h), desce a árvore e joga ao acaso até completar 'depth' ticks do sim_step;
+   no fim, pontua: chegar ao portal vale 1; morrer quase nada (menos quanto
+   mais cedo); sobreviver vale mais com pontos apanhados e perto do portal.
+   Os fantasmas jogam os seus scripts; o 'R' sai da seed de cada cópia.
+
+   Paralelismo pela raiz: cada thread tem a sua cópia, a sua árvore e a sua
+   seed, e no fim somam-se as visitas de cada jogada da raiz (ganha a mais
+   visitada). As threads são criadas a cada decisão (sobrevivem ao fork do
+   quicksave); tudo o resto é alocado no autopilot_create. */
+
+typedef struct {
+    int threads;       // Threads da procura (0 = uma por core)
+    int playouts;      // Playouts por decisão, somados entre as threads
+    int depth;         // Ticks de cada playout
+    int budget_ms;     // Tempo máximo por decisão (0 = só o limite de playouts)
+    unsigned int seed;
+} autopilot_opts_t;
+
+#define AUTOPILOT_DEFAULT_PLAYOUTS 1000
+#define AUTOPILOT_DEFAULT_DEPTH 30
+
+typedef struct autopilot autopilot_t;
+
+/* Valores por omissão (uma thread por core, seed do relógio) */
+void autopilot_default_opts(autopilot_opts_t* opts);
+
+/* Autopiloto do pacman 'pacman' do nível em board (as cópias são do mesmo
+   nível: depois de um load_level novo, outro autopilot_create) */
+autopilot_t* autopilot_create(const board_t* board, int pacman, const autopilot_opts_t* opts);
+void autopilot_destroy(autopilot_t* autopilot);
+
+/* Escolhe a próxima jogada ('W', 'S', 'A', 'D' ou 'T' = ficar). Copia o
+   estado de board com todas as linhas trancadas (exceto em boards de uma só
+   thread, rows_owned) e procura sem tocar mais em board */
+char autopilot_decide(autopilot_t* autopilot, board_t* board);
+
+typedef struct {
+    unsigned long decisions;
+    unsigned long playouts;   // Somados entre decisões
+    unsigned long ticks;      // Ticks simulados (sim_step) nos playouts
+    uint64_t search_ns;       // Tempo total das decisões
+} autopilot_stats_t;
+
+void autopilot_get_stats(const autopilot_t* autopilot, autopilot_stats_t* stats);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef BANDS_H
+#define BANDS_H
+
+#include "board.h"
+
+/* Execução por faixas (decomposição espacial): o tabuleiro é dividido em faixas
+   horizontais de linhas, cada uma de um worker (fixo num core) que joga todos os
+   agentes que lá estão. Enquanto os workers correm, cada linha tem um só escritor
+   (board->rows_owned) e as jogadas não tocam nos row locks.
+
+   Um tick tem três fases separadas por barreiras:
+   1. cada faixa joga os seus agentes (pacmans e depois fantasmas, por índice);
+      uma jogada que sai da faixa vira uma mensagem de handoff para a vizinha,
+      e o agente continua na célula de origem até ao fim do tick;
+   2. cada faixa aceita ou recusa os handoffs que recebeu (só escreve nas suas células);
+   3. quem enviou limpa as células de origem dos handoffs aceites.
+   As jogadas de fantasmas carregados (que varrem linhas de outras faixas) ficam
+   para o fim do tick, numa só thread. O estado do jogo (vitória, derrota, Q)
+   é decidido no fim do tick e não a meio, como no sim_step. */
+
+typedef struct bands bands_t;
+
+/* n_bands <= 0: uma faixa por core (no máximo uma por linha) */
+bands_t* bands_create(board_t* board, int n_bands);
+void bands_destroy(bands_t* bands);
+
+int bands_count(const bands_t* bands);
+
+/* Um tick; devolve board->game_running (como o sim_step) */
+int bands_step(bands_t* bands);
+
+/* Como o sim_run, mas com faixas */
+long bands_run(board_t* board, int n_bands, long max_ticks, int* status);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+/* Estado final de um nível nos modos headless (além dos GAME_* do board.h e sim.h) */
+#define BATCH_LOAD_ERROR 5
+#define BATCH_CRASH 6
+
+/* Modo batch: corre headless todos os níveis de uma ou mais pastas num pool
+   limitado de processos e escreve um resumo CSV/JSON por nível.
+   argv[0] é "--batch"; devolve o exit code do programa. */
+int run_batch(int argc, char** argv);
+
+/* Nome de um estado final ("win", "dead", "quit", "timeout", "load_error", "crash") */
+const char* batch_status_name(int status);
+
+#endif
@@ -1,16 +1,16 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#include <ncurses.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include "script.h"
+#include "spinlock.h"
 
-#define MAX_MOVES 100 // Aumentado para suportar ficheiros maiores
 #define MAX_LEVELS 20
 #define MAX_FILENAME 256
-#define MAX_GHOSTS 25
 
 typedef enum {
     REACHED_PORTAL = 1,
@@ -19,10 +19,22 @@ typedef enum {
     DEAD_PACMAN = -2,
 } move_t;
 
+/* Valores de board->exit_status */
+#define GAME_WON 1
+#define GAME_LOST 2
+#define GAME_QUIT 3
+
+/* Lock de uma linha: pthread_mutex_t ou, com -DSPIN_ROW_LOCKS, o lock adaptativo de spinlock.h */
+#ifdef SPIN_ROW_LOCKS
+typedef spin_lock_t row_lock_t;
+#else
+typedef pthread_mutex_t row_lock_t;
+#endif
+
 typedef struct {
     char command;
     int turns;
-    int turns_left;
+    int scripted; // 1 = veio do script do agente (avança a VM), 0 = teclado
 } command_t;
 
 typedef struct {
@@ -30,18 +42,16 @@ typedef struct {
     int alive; 
     int points; 
     int passo; 
-    command_t moves[MAX_MOVES];
-    int current_move;
-    int n_moves; 
+    script_t* script; // Bytecode do ficheiro .p (NULL = só teclado)
+    vm_state_t vm;
     int waiting;
 } pacman_t;
 
 typedef struct {
     int pos_x, pos_y; 
     int passo; 
-    command_t moves[MAX_MOVES];
-    int n_moves; 
-    int current_move;
+    script_t* script; // Bytecode do ficheiro .m (NULL = movimento aleatório)
+    vm_state_t vm;
     int waiting;
     int charged;
 } ghost_t;
@@ -50,18 +60,38 @@ typedef struct {
     char content;   
     int has_dot;    
     int has_portal; 
+    int pacman;     // índice+1 do pacman nesta célula (0 = nenhum)
 } board_pos_t;
 
+/* Armazenamento por tiles de BOARD_TILE x BOARD_TILE células, para mapas
+   enormes e quase só de paredes: um tile só é alocado se tiver alguma célula
+   que não seja parede. As células dos tiles por alocar são board_wall_cell
+   (partilhada e nunca escrita: nenhum agente entra numa parede). */
+#define BOARD_TILE_SHIFT 3
+#define BOARD_TILE (1 << BOARD_TILE_SHIFT)
+
+typedef struct {
+    int tiles_w, tiles_h;
+    board_pos_t** tiles;    // tiles_w * tiles_h; NULL = tile só com paredes
+    long n_allocated;       // Tiles alocados
+    int* tile_order;        // tiles_w * tiles_h: ordem de alocação do tile (-1 = por alocar), ver board_slot
+    long* allocated;        // Índice (na tabela) de cada tile alocado, por essa ordem
+    long allocated_cap;
+} board_chunks_t;
+
+extern board_pos_t board_wall_cell;
+
 typedef struct {
     int width, height;      
-    board_pos_t* board;     
+    board_pos_t* board;     // Células por linhas (denso); NULL se o nível usa chunks
+    board_chunks_t* chunks; // Células por tiles (esparso); NULL se o nível é denso
     int n_pacmans;          
     pacman_t* pacmans;      
     int n_ghosts;           
     ghost_t* ghosts;        
     char level_name[256];   
-    char pacman_file[256];  
-    char ghosts_files[MAX_GHOSTS][256]; 
+    char (*pacman_files)[MAX_FILENAME]; // Array dinâmico: tamanho = n_pacmans
+    char (*ghosts_files)[MAX_FILENAME]; // Array dinâmico: tamanho = n_ghosts
     int tempo;              
     
     // --- NOVO EXERCÍCIO 3 ---
@@ -71,8 +101,19 @@ typedef struct {
     int save_request;      // Comunicação entre Main (Teclado) e Thread Pacman
     // ------------------------
     int exit_status;
-    pthread_mutex_t* row_locks; // Array dinâmico: tamanho = board->height
+    row_lock_t* row_locks; // Array dinâmico: tamanho = board->height
     pthread_mutex_t global_stats_lock;
+    struct row_lock_stats* row_stats; // Só alocado com -DLOCK_PROFILE (make profile)
+    _Atomic(struct chase_field*) chase; // Campo BFS dos fantasmas em caça (alocado no 1º 'H')
+    atomic_ulong pacman_version;        // Incrementa sempre que um pacman muda de célula ou morre
+    atomic_ulong generation;            // Incrementa a cada alteração visível (ver board_changed)
+    atomic_int render_armed;            // A UI está parada à espera de uma nova geração
+    int wake_fd[2];                     // Pipe que acorda a UI (-1 nos modos headless)
+    int rows_owned;                     // 1 = cada linha tem um só escritor (bands.c): sem row locks
+    struct sim_sched* sched;            // Agenda dos fantasmas do sim_step (sim.c); NULL até ao 1º tick
+    unsigned int* rand_seed;            // 'R' com rand_r sobre esta seed (cópias do sim_clone); NULL = rand()
+    int quiet;                          // 1 = nada no debug.log nem nas métricas (playouts do autopiloto)
+    struct event_queue* events;         // Fila de eventos para a UI (events.h); NULL nos modos headless
 } board_t;
 
 /*Makes the current thread sleep for 'int milliseconds' miliseconds*/
@@ -82,15 +123,80 @@ void sleep_ms(int milliseconds);
 int move_pacman(board_t* board, int pacman_index, command_t* command);
 int move_ghost(board_t* board, int ghost_index, command_t* command);
 
+/*Runs the control flow of an agent script (LOOP/IF/jumps) from vm->pc and
+  returns the next action, or NULL if the script has none; (x,y) is the agent's
+  position, used by the IF conditions*/
+const instr_t* script_fetch(const board_t* board, const script_t* script, vm_state_t* vm, int x, int y);
+
+/*Bumps board->generation after a visible change (move, dot, charge, game over)
+  and, if the UI is waiting for one, wakes it through wake_fd*/
+void board_changed(board_t* board);
+
+/*Creates the UI wake pipe (only the interactive game needs it)*/
+int board_wake_open(board_t* board);
+void board_wake_close(board_t* board);
+
 /*Process the death of a Pacman*/
 void kill_pacman(board_t* board, int pacman_index);
 
+/*Number of pacmans still alive (the level is lost when it reaches 0)*/
+int pacmans_alive(board_t* board);
+
+/*Applies the result of a pacman move to exit_status/game_running:
+  any pacman on a portal wins, the level is lost when no pacman is alive*/
+void update_game_status(board_t* board, int result);
+
 /* Loads a level from a file into board 
    dir_path: path to the directory containing the files
    level_file: name of the .lvl file
 */
 
-int get_board_index(board_t* board, int x, int y);
+/* Index of (x,y) in row-major order (64-bit: width*height can exceed INT_MAX) */
+long get_board_index(const board_t* board, int x, int y);
+
+/* Cell (x,y), whatever the storage (dense or chunked). Chunked walls return the
+   shared board_wall_cell, which must never be written */
+static inline board_pos_t* board_cell(const board_t* board, int x, int y) {
+    if (board->board) return &board->board[(long)y * board->width + x];
+    board_pos_t* tile = board->chunks->tiles[(long)(y >> BOARD_TILE_SHIFT) * board->chunks->tiles_w
+                                             + (x >> BOARD_TILE_SHIFT)];
+    if (!tile) return &board_wall_cell;
+    return &tile[((y & (BOARD_TILE - 1)) << BOARD_TILE_SHIFT) | (x & (BOARD_TILE - 1))];
+}
+
+static inline board_pos_t* board_cell_at(const board_t* board, long index) {
+    if (board->board) return &board->board[index];
+    return board_cell(board, (int)(index % board->width), (int)(index / board->width));
+}
+
+/* Slot of (x,y) in the cells that are actually stored: row-major when dense;
+   when chunked, the allocated tiles one after another (in allocation order),
+   with board_cell's layout inside each tile. -1 for a cell of an unallocated
+   (all-wall) tile. Per-cell arrays of the analyses (chase field, autopilot)
+   have board_slots entries, so they stay as small as the chunked storage */
+static inline long board_slot(const board_t* board, int x, int y) {
+    if (board->board) return (long)y * board->width + x;
+    int order = board->chunks->tile_order[(long)(y >> BOARD_TILE_SHIFT) * board->chunks->tiles_w
+                                          + (x >> BOARD_TILE_SHIFT)];
+    if (order < 0) return -1;
+    return ((long)order << (2 * BOARD_TILE_SHIFT)) | ((y & (BOARD_TILE - 1)) << BOARD_TILE_SHIFT) | (x & (BOARD_TILE - 1));
+}
+
+/* Number of slots (width*height when dense) */
+long board_slots(const board_t* board);
+
+/* Cell of a slot (inverse of board_slot) */
+void board_slot_xy(const board_t* board, long slot, int* x, int* y);
+
+/* Allocates the storage for a width x height level (chunked if 'chunked') */
+int board_storage_init(board_t* board, int chunked);
+void board_storage_free(board_t* board);
+
+/* Like board_cell, but allocates the tile (filled with walls) if needed: for the loader */
+board_pos_t* board_cell_alloc(board_t* board, int x, int y);
+
+/* Bytes used by the cells (to compare dense and chunked storage) */
+size_t board_storage_bytes(const board_t* board);
 
 /*Unloads levels loaded by load_level*/
 
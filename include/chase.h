@@ -0,0 +1,29 @@
+#ifndef CHASE_H
+#define CHASE_H
+
+#include "board.h"
+
+/* Campo de distâncias (BFS) partilhado por todos os fantasmas em modo caça ('H').
+   É reconstruído no máximo uma vez por cada jogada de um pacman, por quem o
+   pedir primeiro; os restantes fantasmas só leem 4 vizinhos. */
+
+/* Direção ('W','A','S','D') que aproxima o fantasma do pacman vivo mais próximo,
+   ou 'R' se não houver caminho */
+char chase_direction(board_t* board, int ghost_index);
+
+/* Marca o campo como desatualizado (um pacman mudou de posição ou morreu) */
+void chase_invalidate(board_t* board);
+
+/* No filho de um fork (save): o build_lock pode ter ficado preso por uma thread que já não existe */
+void chase_after_fork(board_t* board);
+
+void chase_free(board_t* board);
+
+/* Campo num bloco de chase_shared_bytes bytes dado por quem chama (memória
+   partilhada entre processos, ver procs.h), com o build_lock process-shared
+   e robusto. chase_release_shared desliga-o do board sem libertar o bloco */
+size_t chase_shared_bytes(const board_t* board);
+void chase_place_shared(board_t* board, void* mem);
+void chase_release_shared(board_t* board);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+/* Modo controlo: um bot (ou um teste) joga os níveis de uma pasta através de
+   um socket UNIX, sem terminal e ao ritmo que quiser (lockstep: um tick só
+   corre quando o cliente pede). O protocolo é de linhas de texto; o cliente
+   pode mandar vários comandos num só write() e recebe a resposta a todos
+   num só write().
+
+   Cliente -> jogo:
+     CMD [@tick] <p> <dirs>   jogadas do pacman p, uma por tick a partir de
+                              @tick (por omissão, a seguir às que já estão na
+                              fila); dirs: W A S D, R (ao acaso), T (parado), Q
+     STEP [n]                 corre n ticks (1 por omissão); pára no fim do nível
+     STATE                    reenvia o estado completo do nível
+   Um pacman sem jogada para um tick segue o seu script (como sem teclas).
+
+   Jogo -> cliente:
+     LEVEL <nome> <altura> <largura> <pacmans> <fantasmas>
+     R <linha>                uma por linha do mapa (X parede, o ponto, @ portal)
+     P <i> <x> <y> <pontos> <vivo>
+     M <i> <x> <y> <carregado>
+     T <tick>                 seguido das linhas P/M dos agentes que mudaram
+     E <estado> <tick>        fim do nível (win, dead, quit); se ganhou, segue-se o LEVEL seguinte
+     OK <tick>                fim do estado inicial e da resposta a um STEP/STATE
+     DONE <estado>            fim do jogo (a ligação fecha)
+     ERR <mensagem>
+   Os pontos comidos não são enviados: desaparecem das células por onde passa um pacman.
+
+   argv[0] é "--control"; devolve o exit code do programa. */
+int run_control(int argc, char** argv);
+
+#endif
@@ -2,7 +2,6 @@
 #define DISPLAY_H
 
 #include "board.h"
-#include <ncurses.h>
 
 
 #define DRAW_GAME_OVER 0
@@ -11,15 +10,78 @@
 
 
 /*
-Potential Structures for ncurses
+Render backends: the functions below dispatch to the selected backend.
+- "ncurses": the original curses screen (default)
+- "ansi": builds each frame in one buffer with ANSI escapes and emits it with a single write()
+- "null": draws nothing (benchmarks, measuring the engine without rendering)
 */
+typedef struct {
+    const char* name;
+    int (*init)(void);
+    void (*draw_board)(board_t* board, int mode);
+    void (*draw)(char c, int colour_i, int pos_x, int pos_y);
+    void (*present)(void);
+    void (*clear_screen)(void);
+    char (*get_input)(void);
+    void (*after_fork)(void); // May be NULL
+    void (*cleanup)(void);
+} render_backend_t;
 
-/*Initialize everything ncurses requires*/
+extern const render_backend_t ncurses_backend;
+extern const render_backend_t ansi_backend;
+extern const render_backend_t null_backend;
+
+/*Selects the backend by name (before terminal_init); returns -1 if unknown*/
+int display_select(const char* name);
+
+/*Name of the selected backend*/
+const char* display_backend_name();
+
+/*ANSI backend: file descriptor the frames are written to (default STDOUT_FILENO)*/
+void display_set_output(int fd);
+
+/*ANSI backend: terminal size assumed when the output is not a terminal (0 = whole board)*/
+void display_set_size(int rows, int cols);
+
+/*Clears the whole screen (e.g. after returning from a quicksave)*/
+void display_clear();
+
+/*Restores the terminal state in the child of a fork (quicksave)*/
+void display_after_fork();
+
+/*Initialize everything the selected backend requires*/
 int terminal_init();
 
-/*Draw the board on the screen*/
+/*Draw the board on the screen (only the part inside the viewport)*/
 void draw_board(board_t* board, int mode);
 
+/*
+Visible part of the board: cells [x, x+width) x [y, y+height).
+When the board is larger than the terminal the viewport follows pacman 0,
+re-centering only when it gets within a quarter of the view from an edge
+(the backends cache the static layer per viewport position).
+*/
+typedef struct {
+    int x, y;
+    int width, height;
+} viewport_t;
+
+/*Rows above and below the board: title, mode line, blank / blank, points*/
+#define VIEWPORT_TOP_ROWS 3
+#define VIEWPORT_BOTTOM_ROWS 2
+
+/*
+Overlay drawn under the "Points:" line (performance HUD, see hud.h): lines
+separated by '\n', NULL or "" to hide it. The text is copied; the backends
+shrink the viewport by display_overlay_lines() rows.
+*/
+void display_set_overlay(const char* text);
+const char* display_overlay();
+int display_overlay_lines();
+
+/*Updates vp for a terminal of term_rows x term_cols; returns 1 if it moved or resized*/
+int viewport_follow(viewport_t* vp, const board_t* board, int term_rows, int term_cols);
+
 /*Add a specific character with colour i into position (pos_x,pos_y) of the creen
 Pre loaded colours:
 1- Yellow
@@ -32,10 +94,10 @@ Pre loaded colours:
 */
 void draw(char c, int colour_i, int pos_x, int pos_y);
 
-/*Call ncurses refresh() to update the screen*/
+/*Update the physical screen (ncurses refresh(), or the ANSI frame write())*/
 void refresh_screen();
 
-/*Ncurses will be reading the player's inputs*/
+/*Reads the player's inputs (non-blocking, '\0' if none)*/
 char get_input();
 
 void terminal_cleanup();
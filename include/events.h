@@ -0,0 +1,110 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "board.h"
+#include "histogram.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/* Eventos do jogo: os agentes (threads dos pacmans e dos fantasmas, ou os
+   workers de --procs) publicam o que aconteceu numa fila MPSC sem locks e a
+   thread da UI, a única consumidora, entrega cada evento aos subscritores
+   (desenho, debug.log, estatísticas, trace). Publicar nunca bloqueia: com a
+   fila cheia o evento é descartado e contado em 'dropped'.
+
+   A fila é um anel com um número de sequência por slot: um produtor reserva
+   a posição com um CAS na cauda, escreve o evento e publica-o com o número
+   de sequência; o consumidor lê pela ordem das posições. Não tem ponteiros,
+   por isso pode viver em memória partilhada (procs.c). Um produtor que morra
+   entre o CAS e a publicação deixa a fila presa nesse slot até ao fim do
+   nível (os eventos seguintes passam a ser descartados; o jogo continua). */
+
+typedef enum {
+    EVENT_DOT_EATEN = 0,  // Pacman apanhou um ponto em (x, y)
+    EVENT_PACMAN_KILLED,  // Pacman morreu em (x, y)
+    EVENT_PORTAL_REACHED, // Pacman chegou ao portal em (x, y)
+    EVENT_GHOST_CHARGED,  // Fantasma carregou ('C') em (x, y)
+    EVENT_MOVE,           // Jogada feita: o agente está agora em (x, y)
+    N_EVENT_TYPES
+} event_type_t;
+
+typedef struct {
+    uint64_t time_ns; // now_ns() quando foi publicado
+    int type;         // event_type_t
+    int ghost;        // 0 = pacman, 1 = fantasma
+    int agent;        // Índice do agente
+    int x, y;
+} game_event_t;
+
+typedef struct event_queue event_queue_t;
+
+/* Bytes de uma fila de 'capacity' eventos (potência de 2) */
+size_t event_queue_bytes(int capacity);
+
+/* Fila vazia em 'mem' (event_queue_bytes bytes, alinhados a 8) */
+event_queue_t* event_queue_init(void* mem, int capacity);
+int event_queue_capacity(const event_queue_t* queue);
+
+/* Qualquer thread/processo. 0, ou -1 se a fila estava cheia (evento descartado) */
+int event_queue_push(event_queue_t* queue, const game_event_t* event);
+
+/* Só o consumidor. 1 e *event preenchido, ou 0 se não há eventos prontos */
+int event_queue_pop(event_queue_t* queue, game_event_t* event);
+
+unsigned long event_queue_dropped(const event_queue_t* queue);
+
+/* Publica um evento na fila do board (nada se board->events for NULL: modos headless e cópias) */
+static inline void event_emit(board_t* board, event_type_t type, int ghost, int agent, int x, int y) {
+    if (!board->events) return;
+    game_event_t event = { now_ns(), type, ghost, agent, x, y };
+    event_queue_push(board->events, &event);
+}
+
+/* --- Subscritores (lado do consumidor) --- */
+
+#define EVENT_MAX_SUBSCRIBERS 8
+#define EVENT_DEFAULT_CAPACITY 4096
+
+typedef void (*event_handler_t)(const game_event_t* event, void* ctx);
+
+typedef struct event_bus event_bus_t;
+
+/* Bus com a sua fila (malloc); event_bus_queue é o que se põe em board->events */
+event_bus_t* event_bus_create(int capacity);
+void event_bus_destroy(event_bus_t* bus);
+event_queue_t* event_bus_queue(event_bus_t* bus);
+
+/* Regista um subscritor (antes de os agentes começarem). -1 se já houver EVENT_MAX_SUBSCRIBERS */
+int event_bus_subscribe(event_bus_t* bus, event_handler_t handler, void* ctx);
+
+/* Tira todos os eventos prontos de 'queue' (a do bus, ou a cópia em memória
+   partilhada de --procs) e entrega cada um a todos os subscritores, por ordem
+   de registo. Devolve quantos foram entregues */
+int event_bus_dispatch(event_bus_t* bus, event_queue_t* queue);
+
+const char* event_type_name(int type);
+
+/* Logger: os eventos que não são jogadas vão para o debug.log */
+void event_log_handler(const game_event_t* event, void* ctx);
+
+/* Estatísticas: contagem por tipo (ctx = event_stats_t*) */
+typedef struct {
+    unsigned long count[N_EVENT_TYPES];
+} event_stats_t;
+
+void event_stats_handler(const game_event_t* event, void* ctx);
+
+/* Trace: uma linha CSV por evento (level,t_ms,event,agent,index,x,y), com
+   o tempo contado desde event_trace_level */
+typedef struct {
+    FILE* file;
+    char level[256];
+    uint64_t level_start;
+} event_trace_t;
+
+int event_trace_open(event_trace_t* trace, const char* path);
+void event_trace_level(event_trace_t* trace, const char* level_name);
+void event_trace_close(event_trace_t* trace);
+void event_trace_handler(const game_event_t* event, void* ctx);
+
+#endif
@@ -4,11 +4,36 @@
 #include "board.h"
 #include <dirent.h>
 
-/* Carrega um nível a partir de ficheiros para a estrutura board */
-int load_level(board_t* board, const char* dir_path, const char* level_file, int accumulated_points);
+/* Carrega um nível a partir de ficheiros para a estrutura board.
+   accumulated_points[i] (se i < n_accumulated) são os pontos iniciais do pacman i */
+int load_level(board_t* board, const char* dir_path, const char* level_file,
+               const int* accumulated_points, int n_accumulated);
+
+/* Ficheiro de agente (.p/.m) em memória, para o load_level_memory */
+typedef struct {
+    const char* name; // Nome como aparece nas linhas PAC/MON do nível
+    const char* text; // Conteúdo do ficheiro
+} agent_text_t;
+
+/* Como o load_level, mas o .lvl e os ficheiros dos agentes são strings (não
+   passam pela cache). Um agente cujo ficheiro não esteja em agents[] fica como
+   se o ficheiro não existisse (posição por omissão, sem script). */
+int load_level_memory(board_t* board, const char* level_name, const char* level_text,
+                      const agent_text_t* agents, int n_agents,
+                      const int* accumulated_points, int n_accumulated);
 
 void unload_level(board_t * board);
 
+/* Lê um ficheiro .p/.m (PASSO, POS e comandos); os comandos são compilados
+   para *script (libertar com script_free) */
+int parse_agent_file(const char* filepath, int* start_x, int* start_y, int* passo, script_t** script);
+
+/* Os ficheiros de agentes usados pelo load_level ficam numa cache do processo
+   (chave: caminho + inode/tamanho/mtime), com os scripts partilhados por todos
+   os agentes e níveis que os usam. Liberta a cache (os níveis carregados
+   continuam válidos: cada agente tem a sua referência para o script). */
+void agent_cache_clear(void);
+
 /* Filtro para o scandir encontrar ficheiros .lvl */
 int filter_levels(const struct dirent *entry);
 
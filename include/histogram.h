@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Histograma logarítmico: o bucket i guarda valores em [2^(i-1), 2^i) */
+#define HIST_BUCKETS 48
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[HIST_BUCKETS];
+} histogram_t;
+
+void hist_record(histogram_t* h, uint64_t value);
+void hist_merge(histogram_t* dst, const histogram_t* src);
+
+/* Limite superior do bucket que contém o percentil p (0..100) */
+uint64_t hist_percentile(const histogram_t* h, double p);
+
+/* Histograma HDR: cada potência de 2 é dividida em HDR_SUB_BUCKETS buckets
+   lineares (erro relativo < 1/HDR_SUB_BUCKETS, ~6%). Os contadores são atómicos:
+   várias threads (ou processos, se estiver em memória partilhada) podem
+   registar ao mesmo tempo sem locks. Valores < HDR_SUB_BUCKETS são exatos. */
+#define HDR_SUB_BITS 4
+#define HDR_SUB_BUCKETS (1 << HDR_SUB_BITS)
+#define HDR_BUCKETS ((64 - HDR_SUB_BITS + 1) * HDR_SUB_BUCKETS)
+
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint64_t max;
+    _Atomic uint64_t buckets[HDR_BUCKETS];
+} hdr_histogram_t;
+
+void hdr_record(hdr_histogram_t* h, uint64_t value);
+void hdr_reset(hdr_histogram_t* h);
+
+/* Soma src em dst (src parado: p.ex. o de uma thread depois do join) */
+void hdr_merge(hdr_histogram_t* dst, const hdr_histogram_t* src);
+
+/* Limite superior do bucket que contém o percentil p (0..100), no máximo o max */
+uint64_t hdr_percentile(const hdr_histogram_t* h, double p);
+
+/* Tempo monotónico em nanosegundos */
+uint64_t now_ns(void);
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* HUD de desempenho do jogo interativo (tecla H): jogadas por segundo, FPS,
+   latência das jogadas, espera nos row locks, threads ativas e CPU de cada
+   thread. Cada thread do jogo (UI, pacmans, fantasmas e workers de --procs)
+   ocupa um slot e só ela escreve nele, com loads/stores relaxed: não há
+   locks nem read-modify-write partilhados no caminho das jogadas. A UI lê os
+   slots quando atualiza o HUD e calcula as taxas pela diferença para a
+   leitura anterior.
+
+   Os contadores são escritos quer o HUD esteja visível quer não (mostrá-lo
+   só acrescenta a leitura na UI). Os slots ficam numa página partilhada
+   criada antes de qualquer fork, como os histogramas de latency.h, para que
+   os workers de --procs e o filho de um quicksave também apareçam. Sem
+   hud_init os registos não fazem nada (batch, servidor, bench).
+
+   Os mesmos slots alimentam o endpoint de métricas (metrics.h) através de
+   hud_totals: quando uma thread sai, os seus contadores passam para os
+   totais de threads terminadas, para que os totais nunca desçam. */
+
+#define HUD_MAX_THREADS 128
+
+typedef enum {
+    HUD_THREAD_UI = 0,
+    HUD_THREAD_PACMAN, // index = pacman
+    HUD_THREAD_GHOSTS, // fantasmas [index, index + count)
+    N_HUD_KINDS
+} hud_kind_t;
+
+/* Contadores de eventos de cada thread (hud_count) */
+typedef enum {
+    HUD_DOTS = 0,   // Pontos apanhados
+    HUD_DEATHS,     // Pacmans mortos (conta a thread que matou ou morreu)
+    HUD_SAVES,      // Quicksaves feitos
+    HUD_SAVE_NS,    // Desde o pedido até o filho do save estar a jogar
+    HUD_RESTORES,   // Regressos a um quicksave
+    HUD_RESTORE_NS, // Desde a saída do filho (derrota) até o pai voltar a jogar
+    N_HUD_COUNTERS
+} hud_counter_t;
+
+int hud_init(void);
+void hud_close(void);
+
+/* Ocupa um slot para a thread atual. Sem slots livres a thread soma num
+   contador partilhado, com RMW atómicos (conta nas métricas e nas taxas do
+   HUD, mas sem CPU nem máximo). Sem hud_init os registos não fazem nada */
+void hud_thread_start(hud_kind_t kind, int index, int count);
+void hud_thread_exit(void);
+
+/* Liberta os slots de um processo que terminou sem hud_thread_exit
+   (worker de --procs morto, filho de um quicksave que saiu com exit) */
+void hud_forget(pid_t pid);
+
+/* Registos da thread atual: uma jogada de ns, inválida ou não, uma espera
+   por um row lock ocupado, um frame desenhado e um contador que soma 'n' */
+void hud_record_move(uint64_t ns, int invalid);
+void hud_record_lock_wait(uint64_t ns);
+void hud_record_frame(void);
+void hud_count(hud_counter_t counter, uint64_t n);
+
+/* CPU das threads: a UI lê o relógio de cada thread do seu processo
+   (pthread_getcpuclockid) quando formata o HUD. Uma thread noutro processo
+   (worker de --procs) publica a sua com hud_sample_cpu, uma vez por volta */
+void hud_sample_cpu(void);
+
+/* Quicksave: o filho marca a derrota antes do exit e o pai, já a jogar, regista
+   o regresso (HUD_RESTORES e HUD_RESTORE_NS) */
+void hud_restore_begin(void);
+void hud_restore_end(void);
+
+/* Nível atual (só a UI; lido sem locks por hud_totals) */
+void hud_set_level(int index, const char* name);
+
+typedef struct {
+    unsigned long moves[N_HUD_KINDS];
+    unsigned long invalid_moves[N_HUD_KINDS];
+    unsigned long move_ns[N_HUD_KINDS];
+    unsigned long lock_waits, lock_wait_ns;
+    unsigned long frames;
+    unsigned long counts[N_HUD_COUNTERS];
+    int threads;      // Slots ocupados
+    int level_index;  // -1 antes do primeiro nível
+    char level[256];
+} hud_totals_t;
+
+/* Totais desde o hud_init: threads ativas mais as que já saíram. Qualquer
+   thread (não precisa de slot). -1 sem hud_init */
+int hud_totals(hud_totals_t* totals);
+
+/* Só a UI: lê os slots e escreve em buf o texto do HUD (linhas separadas
+   por '\n', no máximo 'width' colunas e 'max_lines' linhas), com as taxas
+   desde a chamada anterior */
+void hud_format(char* buf, size_t size, int width, int max_lines);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+/* Histogramas de latência do jogo interativo (--stats), escritos em JSON à saída.
+   Ficam numa página partilhada (MAP_SHARED) criada antes de qualquer fork: o
+   processo filho de um quicksave regista nos mesmos histogramas que o pai, e o
+   relatório final inclui o tempo jogado nos dois. Sem latency_init() os
+   registos não fazem nada (batch, servidor, bench). */
+
+typedef enum {
+    LAT_MOVE_PACMAN = 0, // move_pacman numa thread de pacman
+    LAT_MOVE_GHOST,      // move_ghost numa thread de fantasma (sem o script_fetch)
+    LAT_SLEEP_OVERSHOOT, // quanto o sleep_ms dormiu a mais do que o pedido
+    LAT_FRAME,           // draw_board + refresh_screen de um frame
+    LAT_KEY_TO_SCREEN,   // tecla WASD lida até ao fim do primeiro frame depois da jogada
+    N_LAT_CATEGORIES
+} latency_category_t;
+
+int latency_init(void);
+void latency_close(void);
+int latency_enabled(void);
+
+void latency_record(latency_category_t category, uint64_t ns);
+
+/* p50/p90/p99/max (ns) de cada categoria; dir e render identificam a corrida */
+int latency_report(const char* path, const char* dir, const char* render);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+
+/* Endpoint de métricas do jogo interativo (--metrics): uma thread aceita
+   ligações num socket UNIX ou numa porta TCP de 127.0.0.1 e responde a cada
+   pedido HTTP (GET /metrics, ou /) com os contadores do motor no formato de
+   texto do Prometheus:
+
+     curl --unix-socket /tmp/pacmanist.sock http://localhost/metrics
+     curl http://127.0.0.1:9100/metrics
+
+   Os valores vêm dos slots por thread do HUD (hud_totals, ver hud.h),
+   somados a cada pedido: as jogadas não passam por nenhum lock por causa
+   das métricas. A thread corre no processo principal e continua a servir
+   enquanto o filho de um quicksave joga (os slots são partilhados). */
+
+typedef struct metrics_server metrics_server_t;
+
+/* 'where' só com dígitos: porta TCP em 127.0.0.1; senão, caminho do socket
+   UNIX (um socket antigo no mesmo caminho é apagado). NULL se falhar */
+metrics_server_t* metrics_start(const char* where);
+
+/* Pára a thread e fecha (e apaga) o socket. Num processo filho só liberta a memória */
+void metrics_stop(metrics_server_t* server);
+
+/* Escreve as métricas atuais em formato Prometheus (0, ou -1 sem hud_init) */
+int metrics_write(FILE* out);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PACMANIST_H
+#define PACMANIST_H
+
+#include "files.h"
+
+/* libpacmanist: o motor do jogo (board.c, files.c, sim.c, ...) sem terminal,
+   sem threads de agentes e sem scandir, para ferramentas que queiram correr
+   muitos ticks no próprio processo (análise, bots, validação em lote).
+   Cada instância é um nível, simulado como no modo batch (sim.c): um tick
+   joga cada pacman e depois cada fantasma, sem TEMPO.
+
+   make lib gera bin/libpacmanist.a e bin/libpacmanist.so; o programa inclui
+   este header (-I include) e liga com -lpacmanist -pthread (sem ncurses).
+
+   Instâncias diferentes podem correr em threads diferentes; uma instância
+   só numa thread de cada vez. O movimento aleatório ('R') usa rand_r sobre
+   uma seed de cada instância (1 ao abrir, ver pacmanist_seed): a mesma seed
+   dá sempre os mesmos ticks, corram as outras instâncias ou não. */
+
+typedef struct pacmanist pacmanist_t;
+typedef struct pacmanist_snapshot pacmanist_snapshot_t;
+
+/* Ficheiro de agente em memória: name é o nome usado nas linhas PAC/MON */
+typedef agent_text_t pacmanist_file_t;
+
+/* Carrega dir_path/level_file (os .p/.m vêm da mesma pasta). NULL se falhar */
+pacmanist_t* pacmanist_open(const char* dir_path, const char* level_file);
+
+/* Carrega um nível a partir do texto do .lvl e dos ficheiros dos agentes */
+pacmanist_t* pacmanist_open_memory(const char* level_text, const pacmanist_file_t* files, int n_files);
+
+void pacmanist_close(pacmanist_t* game);
+
+/* Seed do movimento aleatório ('R') desta instância a partir do próximo step */
+void pacmanist_seed(pacmanist_t* game, unsigned int seed);
+
+/* Jogada do pacman p no próximo tick, em vez do seu script (W A S D, R, T, Q).
+   '\0' volta a deixar o script decidir. Devolve -1 se p ou o comando forem inválidos */
+int pacmanist_command(pacmanist_t* game, int pacman, char command);
+
+/* Corre até n_ticks ticks; pára antes se o nível acabar. As jogadas de
+   pacmanist_command só valem para o primeiro. Devolve os ticks executados */
+long pacmanist_step(pacmanist_t* game, long n_ticks);
+
+/* 0 enquanto o nível corre; depois GAME_WON, GAME_LOST ou GAME_QUIT */
+int pacmanist_status(const pacmanist_t* game);
+
+/* Ticks executados desde o open */
+long pacmanist_tick(const pacmanist_t* game);
+
+/* Vista só de leitura do estado (células, pacmans, fantasmas). Continua
+   válida enquanto a instância existir; muda a cada step/restore. O waiting
+   dos fantasmas só é acertado nos ticks em que jogam (ver sim.h) */
+const board_t* pacmanist_board(const pacmanist_t* game);
+
+/* Célula (x,y) como nos .lvl: 'X' parede, 'o' ponto, '@' portal, ' ' vazia,
+   'P' pacman, 'M' fantasma; '\0' fora do mapa */
+char pacmanist_cell(const pacmanist_t* game, int x, int y);
+
+/* Cópia do estado (células, agentes, tick) para voltar a ele com
+   pacmanist_restore, quantas vezes se quiser. Só serve para a instância
+   que a criou. Inclui a seed: depois de um restore o 'R' repete as mesmas jogadas */
+pacmanist_snapshot_t* pacmanist_snapshot(pacmanist_t* game);
+int pacmanist_restore(pacmanist_t* game, const pacmanist_snapshot_t* snapshot);
+void pacmanist_snapshot_free(pacmanist_snapshot_t* snapshot);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+
+/* Thread pool com work stealing: cada worker tem a sua deque (push/pop no fundo
+   pelo dono, roubo pelo topo pelos outros) e há um heap de tarefas com hora
+   marcada para o ritmo (TEMPO) das sessões. Um worker sem trabalho rouba a
+   outro; se não houver nada para roubar dorme até à próxima tarefa marcada. */
+
+typedef void (*task_fn_t)(void* arg);
+
+typedef struct pool pool_t;
+
+/* n_workers <= 0: um por core */
+pool_t* pool_create(int n_workers);
+
+/* Agenda uma tarefa; chamada de dentro de um worker vai para a deque desse worker */
+void pool_submit(pool_t* pool, task_fn_t fn, void* arg);
+
+/* Agenda uma tarefa para correr a partir do instante 'deadline' (now_ns()) */
+void pool_submit_at(pool_t* pool, uint64_t deadline, task_fn_t fn, void* arg);
+
+/* Espera até não haver tarefas por correr nem marcadas */
+void pool_wait(pool_t* pool);
+
+/* Para e junta os workers (chamar depois do pool_wait) */
+void pool_destroy(pool_t* pool);
+
+typedef struct {
+    int workers;
+    uint64_t executed; // Tarefas corridas
+    uint64_t stolen;   // ... das quais roubadas a outro worker
+    uint64_t timed;    // ... das quais vindas do heap de tarefas marcadas
+} pool_stats_t;
+
+void pool_get_stats(pool_t* pool, pool_stats_t* stats);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PROCS_H
+#define PROCS_H
+
+#include "board.h"
+
+/* Fantasmas em processos (--procs=N): o estado mutável do nível (board_t,
+   células, agentes, row locks, campo de caça e fila de eventos) passa para um segmento de
+   memória partilhada POSIX (shm_open + mmap, herdado pelo fork) e os
+   fantasmas são divididos em N grupos, cada um num processo filho. Os
+   pacmans e a UI continuam a ser threads do processo principal.
+
+   Os row locks do segmento são mutexes process-shared e robustos: se um
+   worker morrer com uma linha trancada, quem a tranca a seguir recebe
+   EOWNERDEAD e continua (row_lock_acquire). Um worker que morra (crash,
+   kill, OOM do seu cgroup) ou que fique PROCS_STALL_MS sem acabar uma volta
+   é morto e relançado por ghost_procs_poll; os seus fantasmas continuam de
+   onde estavam. Ao fim de PROCS_MAX_RESTARTS o grupo fica parado.
+
+   Só com os row locks pthread: o futex do -DSPIN_ROW_LOCKS é privado ao
+   processo. O quicksave (fork do jogo) não existe neste modo. */
+
+#define PROCS_STALL_MS 2000
+#define PROCS_MAX_RESTARTS 5
+
+typedef struct ghost_procs ghost_procs_t;
+
+/* Um grupo de fantasmas [first, last) num só fluxo: a cada period_ms (0 =
+   sem pausa) joga cada um uma vez, até game_running ser 0. *rounds (se não
+   for NULL) conta as voltas completas. É o corpo das threads dos fantasmas
+   (grupos de 1) e dos workers */
+void ghost_group_run(board_t* board, int first, int last, int period_ms, atomic_ulong* rounds);
+
+/* Primeiro fantasma do grupo 'group' de n_groups (o grupo vai até ao primeiro do seguinte) */
+int ghost_group_first(int n_ghosts, int n_groups, int group);
+
+/* Passa o nível para memória partilhada e lança n_workers processos (no
+   máximo um por fantasma). Devolve NULL se falhar; o board fica como estava */
+ghost_procs_t* ghost_procs_start(board_t* board, int n_workers, int period_ms);
+
+/* O board_t partilhado: é o que os pacmans e a UI usam até ao ghost_procs_stop */
+board_t* ghost_procs_board(ghost_procs_t* procs);
+
+/* Relança os workers mortos ou parados (chamar de tempos a tempos, da
+   thread que chamou ghost_procs_start). Devolve quantos foram relançados */
+int ghost_procs_poll(ghost_procs_t* procs);
+
+/* Acaba o nível (game_running = 0), espera pelos workers, copia o estado
+   para o board original e liberta o segmento */
+void ghost_procs_stop(ghost_procs_t* procs);
+
+int ghost_procs_workers(const ghost_procs_t* procs);
+pid_t ghost_procs_pid(const ghost_procs_t* procs, int worker);
+unsigned long ghost_procs_rounds(const ghost_procs_t* procs, int worker);
+
+#endif
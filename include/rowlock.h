@@ -0,0 +1,104 @@
+#ifndef ROWLOCK_H
+#define ROWLOCK_H
+
+#include "board.h"
+#include "histogram.h"
+#include "hud.h"
+#include <errno.h>
+
+/* Quem pediu o lock (usado pelo profiler para separar as estatísticas) */
+typedef enum {
+    LOCK_CALLER_PACMAN = 0,
+    LOCK_CALLER_GHOST,
+    LOCK_CALLER_CHARGED,
+    LOCK_CALLER_RENDER,
+    LOCK_CALLER_SAVE,
+    LOCK_CALLER_QUIT,
+    LOCK_CALLER_AUTOPILOT,
+    N_LOCK_CALLERS
+} lock_caller_t;
+
+/* Só uma linha ocupada é cronometrada (espera para o HUD, ver hud.h): sem contenção custa o mesmo */
+static inline void row_lock_acquire(row_lock_t* lock) {
+#ifdef SPIN_ROW_LOCKS
+    if (!spin_trylock(lock)) {
+        uint64_t start = now_ns();
+        spin_lock_slow(lock);
+        hud_record_lock_wait(now_ns() - start);
+    }
+#else
+    int result = pthread_mutex_trylock(lock);
+    if (result == EBUSY) {
+        uint64_t start = now_ns();
+        result = pthread_mutex_lock(lock);
+        hud_record_lock_wait(now_ns() - start);
+    }
+    // EOWNERDEAD: o dono morreu com a linha trancada (worker de --procs, ver procs.h);
+    // a linha fica como ele a deixou e o mutex volta a servir
+    if (result == EOWNERDEAD) pthread_mutex_consistent(lock);
+#endif
+}
+
+static inline void row_lock_release(row_lock_t* lock) {
+#ifdef SPIN_ROW_LOCKS
+    spin_unlock(lock);
+#else
+    pthread_mutex_unlock(lock);
+#endif
+}
+
+/* Cria/destrói os locks das linhas (e as estatísticas, se LOCK_PROFILE) */
+int row_locks_init(board_t* board);
+void row_locks_destroy(board_t* board);
+
+/* Bloqueia todas as linhas por ordem crescente (render, save, quit, autopiloto) */
+void lock_all_rows(board_t* board, lock_caller_t caller);
+void unlock_all_rows(board_t* board);
+
+#ifdef LOCK_PROFILE
+
+/* Versões instrumentadas: medem espera (antes do lock) e posse (até ao unlock) */
+void row_lock(board_t* board, int row, lock_caller_t caller);
+void row_unlock(board_t* board, int row);
+
+/* Escreve o heatmap de contenção do nível atual (acrescenta ao ficheiro) */
+void lockprof_report(board_t* board, const char* path);
+
+#else
+
+static inline void row_lock(board_t* board, int row, lock_caller_t caller) {
+    (void)caller;
+    row_lock_acquire(&board->row_locks[row]);
+}
+
+static inline void row_unlock(board_t* board, int row) {
+    row_lock_release(&board->row_locks[row]);
+}
+
+static inline void lockprof_report(board_t* board, const char* path) {
+    (void)board;
+    (void)path;
+}
+
+#endif
+
+/* Bloqueia as linhas de uma jogada (old_y e new_y) sem deadlock.
+   No modo por faixas (rows_owned) as duas linhas são da faixa de quem joga: nada a fazer. */
+static inline void lock_move_rows(board_t* board, int y1, int y2, lock_caller_t caller) {
+    if (board->rows_owned) return;
+    int min_y = (y1 < y2) ? y1 : y2;
+    int max_y = (y1 < y2) ? y2 : y1;
+    row_lock(board, min_y, caller);
+    if (min_y != max_y) row_lock(board, max_y, caller);
+}
+
+static inline void unlock_move_rows(board_t* board, int y1, int y2) {
+    if (board->rows_owned) return;
+    int min_y = (y1 < y2) ? y1 : y2;
+    int max_y = (y1 < y2) ? y2 : y1;
+    // LIBERTAR LOCKS PELA ORDEM INVERSA
+    if (min_y != max_y) row_unlock(board, max_y);
+    row_unlock(board, min_y);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Scripts dos agentes (.p/.m) compilados para bytecode no load_level.
+
+   Além dos comandos de sempre (W A S D R C H G Q e "T n"), um script pode ter:
+     LOOP n ... END              repete o bloco n vezes
+     IF <cond> <dir> ... [ELSE ...] END
+                                 cond: WALL, FREE, DOT, GHOST, PAC; dir: W A S D
+                                 (estado da célula vizinha nessa direção)
+   O programa recomeça do início quando chega ao fim. */
+
+#define MAX_LOOP_DEPTH 8
+
+typedef enum {
+    OP_ACT = 0, // Ação de um tick: dir = comando ('W','C','T',...), arg = turns
+    OP_LOOP,    // Início de bloco: counters[slot] = arg
+    OP_ENDLOOP, // if (--counters[slot] > 0) pc = arg
+    OP_IF,      // if (!cond(dir)) pc = arg
+    OP_JUMP,    // pc = arg
+} opcode_t;
+
+typedef enum {
+    COND_WALL = 0,
+    COND_FREE,
+    COND_DOT,
+    COND_GHOST,
+    COND_PAC,
+} script_cond_t;
+
+typedef struct {
+    uint8_t op;
+    char dir;      // OP_ACT: comando; OP_IF: direção testada
+    uint8_t slot;  // OP_LOOP/OP_ENDLOOP: contador; OP_IF: condição
+    uint8_t pad;
+    int32_t arg;   // OP_ACT: turns (T); OP_LOOP: repetições; saltos: destino
+} instr_t;
+
+typedef struct {
+    instr_t* code;
+    int n_ops;
+    int n_actions; // 0 = script sem ações (o agente fica parado / aleatório)
+    atomic_int refs; // Só leitura depois de compilado: partilhado pelos agentes e pela cache do files.c
+} script_t;
+
+/* Estado de execução de um agente */
+typedef struct {
+    int pc;
+    int wait_left; // Ticks que faltam no 'T' atual (0 = ainda não começou)
+    int counters[MAX_LOOP_DEPTH];
+} vm_state_t;
+
+/* Compilação linha a linha (usado pelo parse_agent_file) */
+typedef struct script_builder script_builder_t;
+
+script_builder_t* script_builder_new(void);
+/* Compila uma linha de comandos; devolve -1 se a linha não for reconhecida */
+int script_builder_add_line(script_builder_t* b, const char* line);
+/* Fecha blocos abertos, acrescenta o salto para o início e devolve o script */
+script_t* script_builder_finish(script_builder_t* b);
+
+/* Mais uma referência para o mesmo script */
+script_t* script_retain(script_t* script);
+/* Larga uma referência; o script é libertado com a última */
+void script_free(script_t* script);
+
+static inline int script_runnable(const script_t* script) {
+    return script && script->n_actions > 0;
+}
+
+/* Passa à instrução seguinte (depois de executar a ação atual) */
+static inline void vm_advance(vm_state_t* vm) {
+    vm->pc++;
+    vm->wait_left = 0;
+}
+
+/* Um tick de "T turns": devolve 1 (e avança) quando a espera terminou */
+static inline int vm_wait_tick(vm_state_t* vm, int turns) {
+    if (vm->wait_left <= 0) vm->wait_left = (turns > 0) ? turns : 1;
+    if (--vm->wait_left == 0) {
+        vm->pc++;
+        return 1;
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/* Modo servidor: N sessões independentes (cada uma com o seu board_t e a sua
+   sequência de níveis) num só processo. Cada tick de uma sessão é uma tarefa
+   no pool com work stealing (pool.h), ao ritmo do TEMPO do nível; nunca há
+   duas tarefas da mesma sessão ao mesmo tempo, por isso as sessões não
+   partilham estado nem locks.
+   argv[0] é "--server"; devolve o exit code do programa. */
+int run_server(int argc, char** argv);
+
+#endif
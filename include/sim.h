@@ -0,0 +1,59 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "board.h"
+
+/* exit_status extra dos modos headless: o nível não acabou dentro do limite de ticks */
+#define GAME_TIMEOUT 4
+
+/* Simulação headless, numa só thread e sem TEMPO: cada tick joga uma vez cada
+   pacman (pelo seu script) e depois cada fantasma. 'G' é ignorado, 'Q' termina.
+   Devolve board->game_running depois do tick. */
+int sim_step(board_t* board);
+
+/* Como o sim_step, mas o pacman p joga pacman_cmds[p] em vez do seu script
+   quando pacman_cmds[p] != '\0' (como uma tecla no jogo normal; 'Q' termina).
+   pacman_cmds pode ser NULL. */
+int sim_step_with(board_t* board, const char* pacman_cmds);
+
+/* Os fantasmas do sim_step estão numa timing wheel (wheel.h): cada um só é
+   visitado no tick da sua próxima ação (pelo PASSO e pelos 'T': um 'T n' é
+   uma só visita, na ação que o acaba): os ticks de espera pelo meio não lhe
+   tocam, e o ghost->waiting e o vm.wait_left só são acertados nessa visita.
+   Um tick custa assim o número de fantasmas que jogam, não o número de
+   fantasmas.
+   A agenda é criada no primeiro sim_step e fica em board->sched. */
+
+/* Acerta ghosts[].waiting e .vm.wait_left com os ticks já passados (antes de ler ou copiar o estado) */
+void sim_sched_sync(board_t* board);
+
+/* Esquece a agenda (no unload_level, ou depois de mudar o estado dos fantasmas
+   por fora); o próximo sim_step visita todos os fantasmas */
+void sim_sched_free(board_t* board);
+
+/* Cópia de um nível para simular à parte (playouts do autopiloto, ver
+   autopilot.h): células, agentes e agenda próprios, num board_t que o
+   sim_step avança como outro qualquer. Tudo é alocado no sim_clone_create;
+   o sim_clone_copy só copia (memcpy das células ou dos tiles alocados e dos
+   agentes) e volta a agendar os fantasmas, sem malloc nem locks. O 'R' dos
+   fantasmas usa a seed da cópia (rand_r), por isso cópias diferentes podem
+   correr em threads diferentes; o campo de caça é alocado no primeiro 'H' e
+   fica para as cópias seguintes. A cópia não escreve no debug.log. */
+typedef struct sim_clone sim_clone_t;
+
+/* Cópia de source com a seed 'seed' para o 'R'; NULL se faltar memória */
+sim_clone_t* sim_clone_create(const board_t* source, unsigned int seed);
+
+/* Volta a copiar o estado de source (o mesmo nível do sim_clone_create, ou
+   outra cópia dele). Quem chama garante que ninguém escreve em source
+   entretanto e, se source for avançado pelo sim_step, que fez sim_sched_sync */
+void sim_clone_copy(sim_clone_t* clone, const board_t* source);
+
+board_t* sim_clone_board(sim_clone_t* clone);
+void sim_clone_free(sim_clone_t* clone);
+
+/* Corre sim_step até o nível acabar ou até max_ticks (0 = sem limite).
+   Devolve o número de ticks executados; *status recebe o exit_status. */
+long sim_run(board_t* board, long max_ticks, int* status);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+#include "board.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* Frame buffer para espectadores: o jogo publica cada frame num segmento de
+   memória partilhada POSIX (shm_open) e o bin/viewer lê-o sem tocar nos
+   row_locks nem no ncurses do jogo. Um seqlock protege o frame: o escritor
+   nunca espera pelos leitores, e um leitor que apanhe uma escrita a meio
+   tenta outra vez. */
+
+#define SPECTATE_DEFAULT_NAME "/pacmanist"
+#define SPECTATE_MAGIC 0x50414353u // "PACS"
+
+typedef struct {
+    int x, y;
+    int alive;
+    int points;
+} spectate_pacman_t;
+
+typedef struct {
+    int x, y;
+    int charged;
+} spectate_ghost_t;
+
+/* Início do segmento; cells/pacmans/ghosts vêm a seguir, nos offsets indicados */
+typedef struct {
+    uint32_t magic;
+    uint32_t running;      // 0 = o jogo terminou
+    _Atomic uint64_t seq;  // Ímpar enquanto o frame está a ser escrito
+    uint64_t size;         // Bytes usados pelo frame (o segmento só cresce)
+    uint64_t frame;        // Número do frame publicado
+    int mode;              // DRAW_MENU / DRAW_WIN / DRAW_GAME_OVER
+    int height, width;
+    int n_pacmans, n_ghosts;
+    char level_name[256];
+    uint64_t cells_off;    // height*width chars já no formato do ecrã ('#', 'C', 'M', '.', '@', ' ')
+    uint64_t pacmans_off;  // n_pacmans x spectate_pacman_t
+    uint64_t ghosts_off;   // n_ghosts x spectate_ghost_t
+} spectate_header_t;
+
+/* --- Lado do jogo (um só publicador por processo) --- */
+
+/* Cria o segmento 'name'; devolve -1 (e o jogo segue sem espectadores) se falhar */
+int spectate_open(const char* name);
+
+/* Publica o estado atual; chamar com as linhas trancadas para o frame ser consistente */
+void spectate_publish(board_t* board, int mode);
+
+/* Marca o jogo como terminado e remove o segmento (só o processo que o criou) */
+void spectate_close(void);
+
+/* --- Lado do espectador --- */
+
+/* Copia o último frame completo para buf e devolve o seu tamanho. Se o tamanho
+   for maior que mapped (remapear) ou cap (crescer buf), nada é copiado.
+   Devolve 0 se não conseguir um frame consistente */
+size_t spectate_read(const spectate_header_t* shm, size_t mapped, void* buf, size_t cap);
+
+#endif
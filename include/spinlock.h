@@ -0,0 +1,46 @@
+#ifndef SPINLOCK_H
+#define SPINLOCK_H
+
+#include <stdalign.h>
+#include <stdatomic.h>
+
+/* Lock adaptativo para secções críticas muito curtas (as jogadas trancam uma
+   linha durante meia dúzia de loads/stores): quem o encontra ocupado primeiro
+   tenta de novo com backoff exponencial (pausas de 1, 2, 4, ... até
+   SPIN_MAX_BACKOFF iterações) e só depois dorme num futex, sem passar pelo
+   kernel quando o dono o larga depressa. Cada lock ocupa um bloco de cache
+   inteiro, para que linhas vizinhas não partilhem blocos (false sharing).
+
+   Com -DSPIN_ROW_LOCKS (make spinlocks) os row locks do tabuleiro passam a ser
+   spin_lock_t em vez de pthread_mutex_t. */
+
+#define SPIN_CACHE_LINE 64
+#define SPIN_MAX_BACKOFF 1024
+
+typedef struct {
+    alignas(SPIN_CACHE_LINE) atomic_int state; // 0 livre, 1 trancado, 2 trancado com threads a dormir
+} spin_lock_t;
+
+void spin_lock_init(spin_lock_t* lock);
+
+/* Caminho lento: backoff e depois futex */
+void spin_lock_slow(spin_lock_t* lock);
+void spin_unlock_wake(spin_lock_t* lock);
+
+/* 1 se ficou com o lock; 0 se estava ocupado (sem esperar) */
+static inline int spin_trylock(spin_lock_t* lock) {
+    int expected = 0;
+    return atomic_compare_exchange_strong_explicit(&lock->state, &expected, 1,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+static inline void spin_lock(spin_lock_t* lock) {
+    if (!spin_trylock(lock)) spin_lock_slow(lock);
+}
+
+static inline void spin_unlock(spin_lock_t* lock) {
+    // Só há syscall se alguém chegou a dormir
+    if (atomic_exchange_explicit(&lock->state, 0, memory_order_release) == 2) spin_unlock_wake(lock);
+}
+
+#endif
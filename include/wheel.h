@@ -0,0 +1,41 @@
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include <stdint.h>
+
+/* Timing wheel hierárquica (4 níveis de 64 slots) para agendar itens
+   0..n_items-1 num tick futuro. Cada item está agendado no máximo uma vez;
+   agendar, e avançar um tick sem nada a cascatear, são O(1). Um nível acima
+   cobre 64 vezes mais ticks e, quando o nível de baixo dá a volta, o seu slot
+   desce (cascata). Itens para lá de 2^24 ticks ficam numa lista à parte e
+   os do próximo tick num array simples (o caso de quem joga todos os ticks).
+   Sem alocações depois do wheel_create. */
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+
+typedef struct timing_wheel timing_wheel_t;
+
+/* Wheel vazia no tick 'now' */
+timing_wheel_t* wheel_create(int n_items, uint64_t now);
+void wheel_destroy(timing_wheel_t* wheel);
+
+/* Desagenda tudo e volta ao tick 'now' (sem alocar: para reaproveitar a wheel) */
+void wheel_reset(timing_wheel_t* wheel, uint64_t now);
+
+/* Agenda o item para o tick 'when' (se já passou, fica para o próximo tick).
+   O item não pode estar agendado */
+void wheel_schedule(timing_wheel_t* wheel, int item, uint64_t when);
+
+/* Avança um tick; *due fica a apontar para os itens desse tick, por ordem
+   crescente (válido até ao próximo wheel_advance). Os itens devolvidos deixam
+   de estar agendados. Devolve quantos são */
+int wheel_advance(timing_wheel_t* wheel, const int** due);
+
+uint64_t wheel_now(const timing_wheel_t* wheel);
+
+/* Tick para que o item foi agendado da última vez */
+uint64_t wheel_when(const timing_wheel_t* wheel, int item);
+
+#endif
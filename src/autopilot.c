@@ -0,0 +1,325 @@
+#include "autopilot.h"
+#include "sim.h"
+#include "rowlock.h"
+#include "histogram.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Jogadas do pacman (índice = filho na árvore); 'T' = ficar onde está
+#define N_ACTIONS 5
+static const char actions[N_ACTIONS] = { 'W', 'S', 'A', 'D', 'T' };
+static const int action_dx[N_ACTIONS] = { 0, 0, -1, 1, 0 };
+static const int action_dy[N_ACTIONS] = { -1, 1, 0, 0, 0 };
+#define ACTION_STAY 4
+
+// Exploração do UCB1 (recompensas em [0, 1])
+#define UCT_C 0.7
+
+// Recompensa de um playout que acaba com o pacman vivo (o portal vale 1)
+#define REWARD_ALIVE 0.4
+#define REWARD_DOTS 0.3
+#define REWARD_PORTAL 0.2
+#define REWARD_DEATH 0.2 // Máximo, para quem morre no último tick
+
+// Nó da árvore (open loop: o nó é a sequência de jogadas, não o estado,
+// porque os fantasmas 'R' fazem cada playout chegar a um estado diferente)
+typedef struct {
+    int child[N_ACTIONS]; // Índice do filho; 0 = por expandir (0 é a raiz, nunca é filho)
+    unsigned int visits;
+    double total;         // Soma das recompensas dos playouts que passaram aqui
+} node_t;
+
+typedef struct {
+    struct autopilot* autopilot;
+    sim_clone_t* clone;
+    node_t* nodes;        // Capacidade: quota + 1 (cada playout expande no máximo um nó)
+    int n_nodes;
+    int* path;            // Nós visitados no playout atual (depth + 1)
+    char* cmds;           // Comandos do sim_step_with: só o deste pacman
+    unsigned int seed;    // Política dos playouts e desempates
+    int quota;
+    unsigned long playouts, ticks;
+    pthread_t thread;
+} worker_t;
+
+struct autopilot {
+    autopilot_opts_t opts;
+    int pacman;
+    int* portal_dist;     // Distância (BFS, paredes fixas) ao portal mais próximo; -1 = sem caminho
+    int max_portal_dist;
+    sim_clone_t* root;    // Estado no início da decisão
+    int n_workers;
+    worker_t* workers;
+    uint64_t deadline;    // now_ns() a partir do qual as threads param (0 = sem limite)
+    autopilot_stats_t stats;
+};
+
+void autopilot_default_opts(autopilot_opts_t* opts) {
+    opts->threads = 0;
+    opts->playouts = AUTOPILOT_DEFAULT_PLAYOUTS;
+    opts->depth = AUTOPILOT_DEFAULT_DEPTH;
+    opts->budget_ms = 0;
+    opts->seed = (unsigned int)time(NULL);
+}
+
+// BFS a partir de todos os portais (como o chase_build, mas das paredes fixas).
+// Indexado por board_slot: nos chunks só ocupa os tiles alocados
+static int* portal_distances(const board_t* board, int* max_dist) {
+    long cells = board_slots(board);
+    int* dist = malloc(sizeof(int) * (cells > 0 ? cells : 1));
+    long* queue = malloc(sizeof(long) * (cells > 0 ? cells : 1));
+    if (!dist || !queue) {
+        free(dist);
+        free(queue);
+        return NULL;
+    }
+
+    long head = 0, tail = 0;
+    for (long i = 0; i < cells; i++) {
+        int x, y;
+        board_slot_xy(board, i, &x, &y);
+        dist[i] = -1;
+        if (x < board->width && y < board->height && board_cell(board, x, y)->has_portal) {
+            dist[i] = 0;
+            queue[tail++] = i;
+        }
+    }
+    *max_dist = 0;
+    while (head < tail) {
+        long idx = queue[head++];
+        int x, y;
+        board_slot_xy(board, idx, &x, &y);
+        for (int a = 0; a < ACTION_STAY; a++) {
+            int nx = x + action_dx[a], ny = y + action_dy[a];
+            if (nx < 0 || nx >= board->width || ny < 0 || ny >= board->height) continue;
+            long n = board_slot(board, nx, ny);
+            if (n < 0 || dist[n] >= 0 || board_cell(board, nx, ny)->content == 'W') continue;
+            dist[n] = dist[idx] + 1;
+            if (dist[n] > *max_dist) *max_dist = dist[n];
+            queue[tail++] = n;
+        }
+    }
+    free(queue);
+    return dist;
+}
+
+autopilot_t* autopilot_create(const board_t* board, int pacman, const autopilot_opts_t* opts) {
+    if (pacman < 0 || pacman >= board->n_pacmans) return NULL;
+
+    autopilot_t* ap = calloc(1, sizeof(autopilot_t));
+    if (!ap) return NULL;
+    ap->opts = *opts;
+    if (ap->opts.playouts < 1) ap->opts.playouts = AUTOPILOT_DEFAULT_PLAYOUTS;
+    if (ap->opts.depth < 1) ap->opts.depth = AUTOPILOT_DEFAULT_DEPTH;
+    ap->pacman = pacman;
+
+    int n_workers = ap->opts.threads;
+    if (n_workers <= 0) n_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_workers < 1) n_workers = 1;
+    if (n_workers > ap->opts.playouts) n_workers = ap->opts.playouts;
+    ap->n_workers = n_workers;
+
+    ap->portal_dist = portal_distances(board, &ap->max_portal_dist);
+    ap->root = sim_clone_create(board, ap->opts.seed);
+    ap->workers = calloc(n_workers, sizeof(worker_t));
+    int ok = ap->portal_dist && ap->root && ap->workers;
+
+    for (int w = 0; ok && w < n_workers; w++) {
+        worker_t* worker = &ap->workers[w];
+        worker->autopilot = ap;
+        worker->quota = ap->opts.playouts / n_workers + (w < ap->opts.playouts % n_workers);
+        worker->seed = ap->opts.seed * 2654435761u + (unsigned int)w + 1;
+        worker->clone = sim_clone_create(board, worker->seed ^ 0x9e3779b9u);
+        worker->nodes = malloc(sizeof(node_t) * (worker->quota + 1));
+        worker->path = malloc(sizeof(int) * (ap->opts.depth + 1));
+        worker->cmds = calloc(board->n_pacmans, sizeof(char));
+        ok = worker->clone && worker->nodes && worker->path && worker->cmds;
+    }
+    if (!ok) {
+        autopilot_destroy(ap);
+        return NULL;
+    }
+    return ap;
+}
+
+void autopilot_destroy(autopilot_t* ap) {
+    if (!ap) return;
+    for (int w = 0; ap->workers && w < ap->n_workers; w++) {
+        sim_clone_free(ap->workers[w].clone);
+        free(ap->workers[w].nodes);
+        free(ap->workers[w].path);
+        free(ap->workers[w].cmds);
+    }
+    free(ap->workers);
+    sim_clone_free(ap->root);
+    free(ap->portal_dist);
+    free(ap);
+}
+
+// Jogadas que não vão contra uma parede ou para fora do mapa (ficar é sempre possível)
+static int legal_actions(const board_t* board, const pacman_t* pac, int* legal) {
+    int n = 0;
+    for (int a = 0; a < ACTION_STAY; a++) {
+        int x = pac->pos_x + action_dx[a], y = pac->pos_y + action_dy[a];
+        if (x < 0 || x >= board->width || y < 0 || y >= board->height) continue;
+        if (board_cell(board, x, y)->content == 'W') continue;
+        legal[n++] = a;
+    }
+    legal[n++] = ACTION_STAY;
+    return n;
+}
+
+// Política dos playouts: ao acaso entre as direções possíveis, sem entrar
+// numa célula com fantasma se houver alternativa; fica se não houver nenhuma
+static int rollout_action(const board_t* board, const pacman_t* pac, const int* legal, int n_legal, unsigned int* seed) {
+    int safe[N_ACTIONS], n_safe = 0;
+    for (int i = 0; i < n_legal; i++) {
+        int a = legal[i];
+        if (a == ACTION_STAY) continue;
+        if (board_cell(board, pac->pos_x + action_dx[a], pac->pos_y + action_dy[a])->content == 'M') continue;
+        safe[n_safe++] = a;
+    }
+    if (n_safe == 0) return ACTION_STAY;
+    return safe[rand_r(seed) % n_safe];
+}
+
+// Na árvore: uma jogada por expandir (ao acaso) ou, se já não houver, a de melhor UCB1
+static int select_action(worker_t* worker, const node_t* node, const int* legal, int n_legal) {
+    int unexpanded[N_ACTIONS], n_unexpanded = 0;
+    for (int i = 0; i < n_legal; i++) {
+        if (node->child[legal[i]] == 0) unexpanded[n_unexpanded++] = legal[i];
+    }
+    if (n_unexpanded > 0) return unexpanded[rand_r(&worker->seed) % n_unexpanded];
+
+    double log_parent = log((double)node->visits);
+    int best = legal[0];
+    double best_score = -1.0;
+    for (int i = 0; i < n_legal; i++) {
+        const node_t* child = &worker->nodes[node->child[legal[i]]];
+        double score = child->total / child->visits + UCT_C * sqrt(log_parent / child->visits);
+        if (score > best_score) {
+            best_score = score;
+            best = legal[i];
+        }
+    }
+    return best;
+}
+
+static double playout_reward(const autopilot_t* ap, const board_t* board, int start_points, int ticks) {
+    const pacman_t* pac = &board->pacmans[ap->pacman];
+    if (board->exit_status == GAME_WON) return 1.0;
+    if (!pac->alive) return REWARD_DEATH * ticks / ap->opts.depth;
+
+    double dots = (double)(pac->points - start_points) / ap->opts.depth;
+    double portal = 0.0;
+    long slot = board_slot(board, pac->pos_x, pac->pos_y);
+    int dist = (slot >= 0) ? ap->portal_dist[slot] : -1;
+    if (dist >= 0 && ap->max_portal_dist > 0) portal = 1.0 - (double)dist / ap->max_portal_dist;
+    return REWARD_ALIVE + REWARD_DOTS * dots + REWARD_PORTAL * portal;
+}
+
+static void playout(worker_t* worker) {
+    autopilot_t* ap = worker->autopilot;
+    sim_clone_copy(worker->clone, sim_clone_board(ap->root));
+    board_t* board = sim_clone_board(worker->clone);
+    const pacman_t* pac = &board->pacmans[ap->pacman];
+    int start_points = pac->points;
+
+    int node = 0, n_path = 0, in_tree = 1, ticks = 0;
+    worker->path[n_path++] = 0;
+    while (ticks < ap->opts.depth && board->game_running && pac->alive) {
+        int legal[N_ACTIONS];
+        int n_legal = legal_actions(board, pac, legal);
+        int action;
+        if (in_tree) {
+            action = select_action(worker, &worker->nodes[node], legal, n_legal);
+            int child = worker->nodes[node].child[action];
+            if (child == 0) {
+                // Expansão: um nó novo por playout, depois segue ao acaso
+                child = worker->n_nodes++;
+                memset(&worker->nodes[child], 0, sizeof(node_t));
+                worker->nodes[node].child[action] = child;
+                in_tree = 0;
+            }
+            node = child;
+            worker->path[n_path++] = node;
+        }
+        else {
+            action = rollout_action(board, pac, legal, n_legal, &worker->seed);
+        }
+        worker->cmds[ap->pacman] = actions[action];
+        sim_step_with(board, worker->cmds);
+        ticks++;
+    }
+    worker->ticks += ticks;
+
+    double reward = playout_reward(ap, board, start_points, ticks);
+    for (int i = 0; i < n_path; i++) {
+        worker->nodes[worker->path[i]].visits++;
+        worker->nodes[worker->path[i]].total += reward;
+    }
+}
+
+static void* worker_thread(void* arg) {
+    worker_t* worker = arg;
+    uint64_t deadline = worker->autopilot->deadline;
+    memset(&worker->nodes[0], 0, sizeof(node_t));
+    worker->n_nodes = 1;
+    worker->playouts = 0;
+    worker->ticks = 0;
+    while (worker->playouts < (unsigned long)worker->quota) {
+        playout(worker);
+        worker->playouts++;
+        if (deadline && now_ns() >= deadline) break;
+    }
+    return NULL;
+}
+
+char autopilot_decide(autopilot_t* ap, board_t* board) {
+    uint64_t start = now_ns();
+
+    // Os fantasmas de um board avançado pelo sim_step têm o waiting por acertar
+    sim_sched_sync(board);
+    if (!board->rows_owned) lock_all_rows(board, LOCK_CALLER_AUTOPILOT);
+    sim_clone_copy(ap->root, board);
+    if (!board->rows_owned) unlock_all_rows(board);
+
+    const board_t* root = sim_clone_board(ap->root);
+    const pacman_t* pac = &root->pacmans[ap->pacman];
+    if (!root->game_running || !pac->alive) return 'T';
+
+    ap->deadline = (ap->opts.budget_ms > 0) ? start + (uint64_t)ap->opts.budget_ms * 1000000ull : 0;
+    for (int w = 1; w < ap->n_workers; w++) {
+        pthread_create(&ap->workers[w].thread, NULL, worker_thread, &ap->workers[w]);
+    }
+    worker_thread(&ap->workers[0]); // A thread que decide também procura
+    for (int w = 1; w < ap->n_workers; w++) pthread_join(ap->workers[w].thread, NULL);
+
+    // Jogada mais visitada somando as árvores de todas as threads
+    unsigned long visits[N_ACTIONS] = {0};
+    for (int w = 0; w < ap->n_workers; w++) {
+        const worker_t* worker = &ap->workers[w];
+        for (int a = 0; a < N_ACTIONS; a++) {
+            int child = worker->nodes[0].child[a];
+            if (child) visits[a] += worker->nodes[child].visits;
+        }
+        ap->stats.playouts += worker->playouts;
+        ap->stats.ticks += worker->ticks;
+    }
+    int best = ACTION_STAY;
+    for (int a = 0; a < N_ACTIONS; a++) {
+        if (visits[a] > visits[best]) best = a;
+    }
+
+    ap->stats.decisions++;
+    ap->stats.search_ns += now_ns() - start;
+    return actions[best];
+}
+
+void autopilot_get_stats(const autopilot_t* ap, autopilot_stats_t* stats) {
+    *stats = ap->stats;
+}
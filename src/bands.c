@@ -0,0 +1,449 @@
+#define _GNU_SOURCE // pthread_setaffinity_np
+#include "bands.h"
+#include "sim.h"
+#include "chase.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdalign.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+typedef struct {
+    char kind;          // 'P' ou 'M'
+    int agent;
+    int from_x, from_y;
+    int to_x, to_y;
+    int result;         // Escrito por quem recebe (fase 2)
+    int got_dot;
+} handoff_t;
+
+typedef struct {
+    handoff_t* items;
+    int n, cap;
+} outbox_t;
+
+typedef struct {
+    int* items;
+    int n, cap;
+} agent_list_t;
+
+typedef struct {
+    int ghost;
+    command_t cmd;
+} deferred_t;
+
+// Cada faixa no seu bloco de cache: os workers só escrevem na sua
+typedef struct {
+    alignas(64) int y0, y1;  // Linhas [y0, y1)
+    pthread_t thread;
+    struct bands* owner;
+    int index;
+    unsigned int seed;       // Movimentos 'R' da faixa
+    agent_list_t pacmans, ghosts;
+    outbox_t up, down;       // Handoffs para a faixa de cima / de baixo
+    deferred_t* deferred;    // Jogadas carregadas para o fim do tick
+    int n_deferred, deferred_cap;
+    int won, quit;
+} band_t;
+
+struct bands {
+    board_t* board;
+    int n_bands;
+    band_t* bands;
+    int* band_of_row;
+    unsigned char* pac_in_flight; // Pacman com handoff pendente (ainda ocupa a origem)
+    pthread_barrier_t tick_barrier;  // Workers + quem chama bands_step
+    pthread_barrier_t phase_barrier; // Só os workers
+    int stopping;
+};
+
+// --- Listas ---
+
+static void list_add(agent_list_t* l, int agent) {
+    if (l->n == l->cap) {
+        l->cap = l->cap ? l->cap * 2 : 16;
+        l->items = realloc(l->items, sizeof(int) * l->cap);
+    }
+    l->items[l->n++] = agent;
+}
+
+// Mantém a ordem (os agentes jogam por índice dentro da faixa)
+static void list_remove(agent_list_t* l, int agent) {
+    for (int i = 0; i < l->n; i++) {
+        if (l->items[i] == agent) {
+            memmove(&l->items[i], &l->items[i + 1], sizeof(int) * (l->n - i - 1));
+            l->n--;
+            return;
+        }
+    }
+}
+
+static void list_insert_sorted(agent_list_t* l, int agent) {
+    list_add(l, agent);
+    int i = l->n - 1;
+    while (i > 0 && l->items[i - 1] > agent) {
+        l->items[i] = l->items[i - 1];
+        i--;
+    }
+    l->items[i] = agent;
+}
+
+static void outbox_push(outbox_t* o, handoff_t h) {
+    if (o->n == o->cap) {
+        o->cap = o->cap ? o->cap * 2 : 16;
+        o->items = realloc(o->items, sizeof(handoff_t) * o->cap);
+    }
+    o->items[o->n++] = h;
+}
+
+static int row_band(const struct bands* bs, int y) {
+    if (y < 0) return 0;
+    if (y >= bs->board->height) return bs->n_bands - 1;
+    return bs->band_of_row[y];
+}
+
+// --- Fase 1: jogadas dentro da faixa ---
+// (as condições IF dos scripts e o 'H' ainda leem células vizinhas de outras
+// faixas sem lock, como no modo com uma thread por agente)
+
+static int direction_dy(char direction) {
+    return (direction == 'W') ? -1 : (direction == 'S') ? 1 : 0;
+}
+
+static char resolve_random(band_t* band, char direction) {
+    static const char directions[] = { 'W', 'S', 'A', 'D' };
+    return (direction == 'R') ? directions[rand_r(&band->seed) % 4] : direction;
+}
+
+// Uma jogada para uma linha dentro do tabuleiro mas fora da faixa
+static int leaves_band(const band_t* band, const board_t* board, int new_y) {
+    return new_y >= 0 && new_y < board->height && (new_y < band->y0 || new_y >= band->y1);
+}
+
+static void send_handoff(band_t* band, char kind, int agent, int x, int y, int new_y) {
+    handoff_t h = { kind, agent, x, y, x, new_y, INVALID_MOVE, 0 };
+    outbox_push((new_y < band->y0) ? &band->up : &band->down, h);
+}
+
+static void band_pacman(struct bands* bs, band_t* band, int p) {
+    board_t* board = bs->board;
+    pacman_t* pac = &board->pacmans[p];
+    if (!pac->alive) return;
+
+    const instr_t* ins = script_fetch(board, pac->script, &pac->vm, pac->pos_x, pac->pos_y);
+    if (!ins) return;
+    if (ins->dir == 'G') {
+        vm_advance(&pac->vm);
+        return;
+    }
+    if (ins->dir == 'Q') {
+        band->quit = 1;
+        return;
+    }
+
+    command_t cmd = { ins->dir, ins->arg, 1 };
+    if (pac->waiting == 0) {
+        cmd.command = resolve_random(band, cmd.command);
+        int new_y = pac->pos_y + direction_dy(cmd.command);
+        if (leaves_band(band, board, new_y)) {
+            // A jogada gasta o turno já; o resultado vem na fase 2
+            pac->waiting = pac->passo;
+            vm_advance(&pac->vm);
+            bs->pac_in_flight[p] = 1;
+            send_handoff(band, 'P', p, pac->pos_x, pac->pos_y, new_y);
+            return;
+        }
+    }
+    if (move_pacman(board, p, &cmd) == REACHED_PORTAL) band->won = 1;
+}
+
+static void band_ghost(struct bands* bs, band_t* band, int g) {
+    board_t* board = bs->board;
+    ghost_t* ghost = &board->ghosts[g];
+    command_t cmd = { 'R', 1, 0 };
+
+    if (script_runnable(ghost->script)) {
+        const instr_t* ins = script_fetch(board, ghost->script, &ghost->vm, ghost->pos_x, ghost->pos_y);
+        if (!ins) return;
+        cmd.command = ins->dir;
+        cmd.turns = ins->arg;
+        cmd.scripted = 1;
+    }
+
+    if (ghost->waiting == 0) {
+        if (cmd.command == 'H') cmd.command = chase_direction(board, g);
+        cmd.command = resolve_random(band, cmd.command);
+
+        int dy = direction_dy(cmd.command);
+        int dx = (cmd.command == 'A') ? -1 : (cmd.command == 'D') ? 1 : 0;
+        if (ghost->charged && (dx || dy)) {
+            // O varrimento pode atravessar outras faixas: fica para o fim do tick
+            if (band->n_deferred == band->deferred_cap) {
+                band->deferred_cap = band->deferred_cap ? band->deferred_cap * 2 : 8;
+                band->deferred = realloc(band->deferred, sizeof(deferred_t) * band->deferred_cap);
+            }
+            band->deferred[band->n_deferred++] = (deferred_t){ g, cmd };
+            return;
+        }
+
+        int new_y = ghost->pos_y + dy;
+        if (dy != 0 && leaves_band(band, board, new_y)) {
+            ghost->waiting = ghost->passo;
+            if (cmd.scripted) vm_advance(&ghost->vm);
+            send_handoff(band, 'M', g, ghost->pos_x, ghost->pos_y, new_y);
+            return;
+        }
+
+        // Um pacman com handoff pendente não pode ser apanhado na origem
+        int new_x = ghost->pos_x + dx;
+        if ((dx || dy) && new_x >= 0 && new_x < board->width && new_y >= 0 && new_y < board->height) {
+            board_pos_t* target = board_cell(board, new_x, new_y);
+            if (target->content == 'P' && target->pacman > 0 && bs->pac_in_flight[target->pacman - 1]) {
+                ghost->waiting = ghost->passo;
+                if (cmd.scripted) vm_advance(&ghost->vm);
+                return;
+            }
+        }
+    }
+    move_ghost(board, g, &cmd);
+}
+
+// --- Fase 2: receber handoffs (só escreve nas células desta faixa) ---
+
+static void receive(struct bands* bs, band_t* band, outbox_t* in) {
+    board_t* board = bs->board;
+    for (int i = 0; i < in->n; i++) {
+        handoff_t* h = &in->items[i];
+        board_pos_t* cell = board_cell(board, h->to_x, h->to_y);
+
+        if (h->kind == 'P') {
+            if (cell->content == 'W' || cell->content == 'P') {
+                h->result = INVALID_MOVE;
+                continue;
+            }
+            if (cell->has_portal) {
+                h->result = REACHED_PORTAL;
+            } else if (cell->content == 'M') {
+                h->result = DEAD_PACMAN; // Morre na origem (fase 3)
+                continue;
+            } else {
+                h->got_dot = cell->has_dot;
+                cell->has_dot = 0;
+                h->result = VALID_MOVE;
+            }
+            cell->content = 'P';
+            cell->pacman = h->agent + 1;
+            list_insert_sorted(&band->pacmans, h->agent);
+        } else {
+            if (cell->content == 'W' || cell->content == 'M') {
+                h->result = INVALID_MOVE;
+                continue;
+            }
+            h->result = VALID_MOVE;
+            if (cell->content == 'P') {
+                int p = cell->pacman - 1;
+                if (p >= 0 && bs->pac_in_flight[p]) {
+                    h->result = INVALID_MOVE;
+                    continue;
+                }
+                if (p >= 0 && board->pacmans[p].alive) {
+                    kill_pacman(board, p);
+                    h->result = DEAD_PACMAN;
+                }
+            }
+            cell->content = 'M';
+            list_insert_sorted(&band->ghosts, h->agent);
+        }
+    }
+}
+
+// --- Fase 3: fechar os handoffs enviados ---
+
+static void complete(struct bands* bs, band_t* band, outbox_t* out) {
+    board_t* board = bs->board;
+    for (int i = 0; i < out->n; i++) {
+        handoff_t* h = &out->items[i];
+        board_pos_t* from = board_cell(board, h->from_x, h->from_y);
+
+        if (h->kind == 'P') {
+            pacman_t* pac = &board->pacmans[h->agent];
+            bs->pac_in_flight[h->agent] = 0;
+            if (h->result == DEAD_PACMAN) {
+                kill_pacman(board, h->agent);
+            } else if (h->result != INVALID_MOVE) {
+                from->content = ' ';
+                from->pacman = 0;
+                pac->pos_x = h->to_x;
+                pac->pos_y = h->to_y;
+                pac->points += h->got_dot;
+                list_remove(&band->pacmans, h->agent);
+                chase_invalidate(board);
+                if (h->result == REACHED_PORTAL) band->won = 1;
+            }
+        } else if (h->result != INVALID_MOVE) {
+            ghost_t* ghost = &board->ghosts[h->agent];
+            from->content = ' ';
+            ghost->pos_x = h->to_x;
+            ghost->pos_y = h->to_y;
+            list_remove(&band->ghosts, h->agent);
+        }
+    }
+    out->n = 0;
+}
+
+static void band_tick(struct bands* bs, band_t* band) {
+    // Os agentes recebidos na fase 2 só jogam no tick seguinte
+    for (int i = 0; i < band->pacmans.n; i++) band_pacman(bs, band, band->pacmans.items[i]);
+    for (int i = 0; i < band->ghosts.n; i++) band_ghost(bs, band, band->ghosts.items[i]);
+    pthread_barrier_wait(&bs->phase_barrier);
+
+    if (band->index > 0) receive(bs, band, &bs->bands[band->index - 1].down);
+    if (band->index + 1 < bs->n_bands) receive(bs, band, &bs->bands[band->index + 1].up);
+    pthread_barrier_wait(&bs->phase_barrier);
+
+    complete(bs, band, &band->up);
+    complete(bs, band, &band->down);
+}
+
+static void* band_main(void* arg) {
+    band_t* band = arg;
+    struct bands* bs = band->owner;
+
+    for (;;) {
+        pthread_barrier_wait(&bs->tick_barrier);
+        if (bs->stopping) break;
+        band_tick(bs, band);
+        pthread_barrier_wait(&bs->tick_barrier);
+    }
+    return NULL;
+}
+
+// --- API ---
+
+bands_t* bands_create(board_t* board, int n_bands) {
+    long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n_bands <= 0) n_bands = (nproc > 0) ? (int)nproc : 1;
+    if (n_bands > board->height) n_bands = board->height;
+    if (n_bands < 1) n_bands = 1;
+
+    bands_t* bs = calloc(1, sizeof(bands_t));
+    bs->board = board;
+    bs->n_bands = n_bands;
+    bs->bands = aligned_alloc(64, ((sizeof(band_t) * n_bands + 63) / 64) * 64);
+    memset(bs->bands, 0, sizeof(band_t) * n_bands);
+    bs->band_of_row = malloc(sizeof(int) * (board->height > 0 ? board->height : 1));
+    bs->pac_in_flight = calloc(board->n_pacmans > 0 ? board->n_pacmans : 1, 1);
+
+    for (int b = 0; b < n_bands; b++) {
+        band_t* band = &bs->bands[b];
+        band->owner = bs;
+        band->index = b;
+        band->y0 = (int)((long)board->height * b / n_bands);
+        band->y1 = (int)((long)board->height * (b + 1) / n_bands);
+        band->seed = (unsigned int)rand();
+        for (int y = band->y0; y < band->y1; y++) bs->band_of_row[y] = b;
+    }
+    for (int p = 0; p < board->n_pacmans; p++) {
+        list_add(&bs->bands[row_band(bs, board->pacmans[p].pos_y)].pacmans, p);
+    }
+    for (int g = 0; g < board->n_ghosts; g++) {
+        list_add(&bs->bands[row_band(bs, board->ghosts[g].pos_y)].ghosts, g);
+    }
+
+    pthread_barrier_init(&bs->tick_barrier, NULL, n_bands + 1);
+    pthread_barrier_init(&bs->phase_barrier, NULL, n_bands);
+    for (int b = 0; b < n_bands; b++) {
+        pthread_create(&bs->bands[b].thread, NULL, band_main, &bs->bands[b]);
+        // Faixas vizinhas em cores seguidos; sem afinidade não é erro
+        if (nproc > 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(b % nproc, &set);
+            pthread_setaffinity_np(bs->bands[b].thread, sizeof(set), &set);
+        }
+    }
+    return bs;
+}
+
+int bands_count(const bands_t* bands) {
+    return bands->n_bands;
+}
+
+int bands_step(bands_t* bs) {
+    board_t* board = bs->board;
+    if (!board->game_running) return 0;
+
+    board->rows_owned = 1;
+    pthread_barrier_wait(&bs->tick_barrier); // Arranque das faixas
+    pthread_barrier_wait(&bs->tick_barrier); // Todas terminaram as três fases
+    board->rows_owned = 0;
+
+    // Jogadas carregadas, por ordem de faixa, já com os row locks normais
+    int won = 0, quit = 0;
+    for (int b = 0; b < bs->n_bands; b++) {
+        band_t* band = &bs->bands[b];
+        for (int i = 0; i < band->n_deferred; i++) {
+            deferred_t* d = &band->deferred[i];
+            ghost_t* ghost = &board->ghosts[d->ghost];
+            int from = row_band(bs, ghost->pos_y);
+            move_ghost(board, d->ghost, &d->cmd);
+            int to = row_band(bs, ghost->pos_y);
+            if (to != from) {
+                list_remove(&bs->bands[from].ghosts, d->ghost);
+                list_insert_sorted(&bs->bands[to].ghosts, d->ghost);
+            }
+        }
+        band->n_deferred = 0;
+        won |= band->won;
+        quit |= band->quit;
+        band->won = band->quit = 0;
+    }
+
+    if (won) {
+        board->exit_status = GAME_WON;
+        board->game_running = 0;
+    } else if (quit) {
+        board->exit_status = GAME_QUIT;
+        board->game_running = 0;
+    } else if (pacmans_alive(board) == 0) {
+        board->exit_status = GAME_LOST;
+        board->game_running = 0;
+    }
+    board_changed(board); // Uma geração por tick em vez de uma por jogada
+    return board->game_running;
+}
+
+void bands_destroy(bands_t* bs) {
+    bs->stopping = 1;
+    pthread_barrier_wait(&bs->tick_barrier);
+    for (int b = 0; b < bs->n_bands; b++) {
+        band_t* band = &bs->bands[b];
+        pthread_join(band->thread, NULL);
+        free(band->pacmans.items);
+        free(band->ghosts.items);
+        free(band->up.items);
+        free(band->down.items);
+        free(band->deferred);
+    }
+    pthread_barrier_destroy(&bs->tick_barrier);
+    pthread_barrier_destroy(&bs->phase_barrier);
+    free(bs->bands);
+    free(bs->band_of_row);
+    free(bs->pac_in_flight);
+    free(bs);
+}
+
+long bands_run(board_t* board, int n_bands, long max_ticks, int* status) {
+    bands_t* bs = bands_create(board, n_bands);
+    long ticks = 0;
+    while (board->game_running && (max_ticks <= 0 || ticks < max_ticks)) {
+        bands_step(bs);
+        ticks++;
+    }
+    bands_destroy(bs);
+
+    if (board->game_running) board->exit_status = GAME_TIMEOUT;
+    if (status) *status = board->exit_status;
+    return ticks;
+}
@@ -0,0 +1,235 @@
+#include "batch.h"
+#include "board.h"
+#include "files.h"
+#include "sim.h"
+#include "bands.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+
+#define DEFAULT_MAX_TICKS 100000
+
+typedef struct {
+    int status;
+    int points;
+    long ticks;
+    double wall_ms;
+} batch_result_t;
+
+typedef struct {
+    const char* dir;
+    char level[MAX_FILENAME];
+    batch_result_t result;
+} batch_job_t;
+
+typedef struct {
+    pid_t pid;
+    int fd;  // Lado de leitura do pipe do filho
+    int job;
+} batch_worker_t;
+
+const char* batch_status_name(int status) {
+    switch (status) {
+        case GAME_WON: return "win";
+        case GAME_LOST: return "dead";
+        case GAME_QUIT: return "quit";
+        case GAME_TIMEOUT: return "timeout";
+        case BATCH_LOAD_ERROR: return "load_error";
+        case BATCH_CRASH: return "crash";
+        default: return "unknown";
+    }
+}
+
+// Corre um nível do princípio ao fim (processo filho); bands > 0: modo por faixas
+static batch_result_t run_level(const batch_job_t* job, long max_ticks, int bands) {
+    batch_result_t r = { BATCH_LOAD_ERROR, 0, 0, 0.0 };
+    uint64_t start = now_ns();
+
+    board_t board;
+    if (load_level(&board, job->dir, job->level, NULL, 0) != 0) return r;
+
+    if (bands > 0) r.ticks = bands_run(&board, bands, max_ticks, &r.status);
+    else r.ticks = sim_run(&board, max_ticks, &r.status);
+    for (int p = 0; p < board.n_pacmans; p++) r.points += board.pacmans[p].points;
+    unload_level(&board);
+
+    r.wall_ms = (now_ns() - start) / 1e6;
+    return r;
+}
+
+static int collect_jobs(char** dirs, int n_dirs, batch_job_t** jobs) {
+    int n_jobs = 0, cap = 0;
+    *jobs = NULL;
+
+    for (int d = 0; d < n_dirs; d++) {
+        struct dirent **namelist;
+        int n = scandir(dirs[d], &namelist, filter_levels, alphasort);
+        if (n < 0) { perror(dirs[d]); continue; }
+
+        for (int i = 0; i < n; i++) {
+            if (n_jobs == cap) {
+                cap = cap ? cap * 2 : 64;
+                *jobs = realloc(*jobs, sizeof(batch_job_t) * cap);
+            }
+            batch_job_t* job = &(*jobs)[n_jobs++];
+            job->dir = dirs[d];
+            snprintf(job->level, sizeof(job->level), "%s", namelist[i]->d_name);
+            job->result.status = BATCH_CRASH;
+            free(namelist[i]);
+        }
+        free(namelist);
+    }
+    return n_jobs;
+}
+
+static int start_worker(batch_worker_t* w, batch_job_t* jobs, int job, long max_ticks, int bands, unsigned int seed) {
+    int fds[2];
+    if (pipe(fds) == -1) { perror("pipe"); return -1; }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // === FILHO: corre um nível e devolve o resultado pelo pipe ===
+        close(fds[0]);
+        srand(seed + job);
+        batch_result_t r = run_level(&jobs[job], max_ticks, bands);
+        ssize_t written = write(fds[1], &r, sizeof(r)); // < PIPE_BUF: escrita atómica
+        close(fds[1]);
+        _exit(written == sizeof(r) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    w->pid = pid;
+    w->fd = fds[0];
+    w->job = job;
+    return 0;
+}
+
+static void finish_worker(batch_worker_t* w, batch_job_t* jobs, int wait_status) {
+    batch_result_t r;
+    ssize_t got = read(w->fd, &r, sizeof(r));
+    close(w->fd);
+
+    // Sem resultado completo = o filho morreu a meio (sinal, abort, ...)
+    if (got == sizeof(r) && WIFEXITED(wait_status)) {
+        jobs[w->job].result = r;
+    } else {
+        memset(&jobs[w->job].result, 0, sizeof(r));
+        jobs[w->job].result.status = BATCH_CRASH;
+    }
+    w->pid = 0;
+}
+
+static void write_csv(FILE* out, const batch_job_t* jobs, int n_jobs) {
+    fprintf(out, "dir,level,status,exit_status,points,ticks,wall_ms\n");
+    for (int i = 0; i < n_jobs; i++) {
+        const batch_result_t* r = &jobs[i].result;
+        fprintf(out, "%s,%s,%s,%d,%d,%ld,%.3f\n", jobs[i].dir, jobs[i].level,
+                batch_status_name(r->status), r->status, r->points, r->ticks, r->wall_ms);
+    }
+}
+
+static void write_json(FILE* out, const batch_job_t* jobs, int n_jobs, double total_ms, int workers) {
+    int counts[BATCH_CRASH + 1] = {0};
+
+    fprintf(out, "{\n  \"levels\": [\n");
+    for (int i = 0; i < n_jobs; i++) {
+        const batch_result_t* r = &jobs[i].result;
+        if (r->status >= 0 && r->status <= BATCH_CRASH) counts[r->status]++;
+        fprintf(out, "    {\"dir\": \"%s\", \"level\": \"%s\", \"status\": \"%s\", \"exit_status\": %d, "
+                     "\"points\": %d, \"ticks\": %ld, \"wall_ms\": %.3f}%s\n",
+                jobs[i].dir, jobs[i].level, batch_status_name(r->status), r->status,
+                r->points, r->ticks, r->wall_ms, (i + 1 < n_jobs) ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"summary\": {\"levels\": %d, \"workers\": %d, \"wall_ms\": %.3f", n_jobs, workers, total_ms);
+    for (int s = GAME_WON; s <= BATCH_CRASH; s++) {
+        fprintf(out, ", \"%s\": %d", batch_status_name(s), counts[s]);
+    }
+    fprintf(out, "}\n}\n");
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: Pacmanist --batch [-j workers] [-t max_ticks] [-b bands] [-F csv|json] [-o file] [-s seed] <dir>...\n"
+        "  -b  simular cada nível com N faixas de linhas, uma thread por faixa (ver bands.h)\n");
+}
+
+int run_batch(int argc, char** argv) {
+    long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = (nproc > 0) ? (int)nproc : 1;
+    long max_ticks = DEFAULT_MAX_TICKS;
+    int json = 0;
+    const char* out_path = NULL;
+    unsigned int seed = 1;
+    int bands = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:t:b:F:o:s:h")) != -1) {
+        switch (opt) {
+            case 'j': workers = atoi(optarg); break;
+            case 't': max_ticks = atol(optarg); break;
+            case 'b': bands = atoi(optarg); break;
+            case 'F': json = (strcmp(optarg, "json") == 0); break;
+            case 'o': out_path = optarg; break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default: usage(); return 1;
+        }
+    }
+    if (optind >= argc) { usage(); return 1; }
+    if (workers < 1) workers = 1;
+
+    batch_job_t* jobs;
+    int n_jobs = collect_jobs(&argv[optind], argc - optind, &jobs);
+
+    batch_worker_t* pool = calloc(workers, sizeof(batch_worker_t));
+    uint64_t start = now_ns();
+    int next = 0, running = 0;
+
+    // Pool limitado: no máximo 'workers' filhos vivos; cada um corre um nível
+    while (next < n_jobs || running > 0) {
+        for (int w = 0; w < workers && next < n_jobs; w++) {
+            if (pool[w].pid != 0) continue;
+            if (start_worker(&pool[w], jobs, next, max_ticks, bands, seed) != 0) break;
+            next++;
+            running++;
+        }
+
+        int wait_status;
+        pid_t pid = waitpid(-1, &wait_status, 0);
+        if (pid < 0) break;
+        for (int w = 0; w < workers; w++) {
+            if (pool[w].pid == pid) {
+                finish_worker(&pool[w], jobs, wait_status);
+                running--;
+                break;
+            }
+        }
+    }
+    double total_ms = (now_ns() - start) / 1e6;
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) { perror(out_path); out = stdout; }
+    if (json) write_json(out, jobs, n_jobs, total_ms, workers);
+    else write_csv(out, jobs, n_jobs);
+    if (out != stdout) fclose(out);
+
+    int failed = 0;
+    for (int i = 0; i < n_jobs; i++) {
+        if (jobs[i].result.status == BATCH_LOAD_ERROR || jobs[i].result.status == BATCH_CRASH) failed++;
+    }
+    fprintf(stderr, "batch: %d levels, %d workers, %.1f ms, %d failed\n", n_jobs, workers, total_ms, failed);
+
+    free(pool);
+    free(jobs);
+    return failed ? 1 : 0;
+}
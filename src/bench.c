@@ -0,0 +1,324 @@
+#include "board.h"
+#include "display.h"
+#include "files.h"
+#include "histogram.h"
+#include "sim.h"
+#include <ncurses.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Microbenchmarks dos caminhos quentes do motor.
+// Cada caso corre em lotes (batch) para diluir o custo do clock_gettime;
+// os percentis são calculados sobre o tempo por operação de cada lote.
+// Saída: uma linha JSON por caso (stdout).
+
+#define DEFAULT_SAMPLES 200
+#define TARGET_BATCH_NS 20000ull
+
+typedef struct {
+    const char* name;
+    int height, width;
+} board_size_t;
+
+static const board_size_t sizes[] = {
+    { "small",  10,   10 },
+    { "medium", 100,  100 },
+    { "huge",   1000, 1000 },
+};
+
+typedef struct {
+    board_t board;
+    const char* dir;
+    char level_file[64];
+    char agent_path[MAX_FILENAME + 64];
+    int tick;
+    sim_clone_t* clone; // Cópia do tabuleiro (casos sim_clone_*), criada no 1º uso
+} bench_ctx_t;
+
+typedef void (*bench_op_t)(bench_ctx_t* ctx);
+
+static char bench_dir[] = "/tmp/pacmanist-bench-XXXXXX";
+
+// --- Geração dos tabuleiros sintéticos ---
+
+static int write_file(const char* dir, const char* name, const char* content) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    fputs(content, f);
+    fclose(f);
+    return 0;
+}
+
+// Tabuleiro aberto com moldura de paredes, pontos em todo o lado e portal no canto.
+// Pacman na linha 1, fantasma normal e fantasma "charged" mais abaixo.
+static int write_level(const char* dir, const board_size_t* sz) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s.lvl", sz->name);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    fprintf(f, "DIM %d %d\nTEMPO 0\nPAC bench.p\nMON bench.m charged.m\n", sz->height, sz->width);
+    for (int y = 0; y < sz->height; y++) {
+        for (int x = 0; x < sz->width; x++) {
+            char c = 'o';
+            if (y == 0 || x == 0 || y == sz->height - 1 || x == sz->width - 1) c = 'X';
+            else if (y == sz->height - 2 && x == sz->width - 2) c = '@';
+            fputc(c, f);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+
+    // Os agentes são partilhados por todos os tamanhos: posições dentro do mais pequeno
+    char agent[128];
+    snprintf(agent, sizeof(agent), "PASSO 0\nPOS %d 1\nD\nA\n", sizes[0].height - 2);
+    write_file(dir, "bench.m", agent);
+    snprintf(agent, sizeof(agent), "PASSO 0\nPOS %d 1\nC\nD\nC\nA\n", sizes[0].height / 2);
+    write_file(dir, "charged.m", agent);
+    return write_file(dir, "bench.p", "PASSO 0\nPOS 1 1\nD\nA\n");
+}
+
+// --- Operações medidas ---
+
+static void op_move_pacman(bench_ctx_t* ctx) {
+    command_t cmd = { (ctx->tick++ & 1) ? 'A' : 'D', 1, 0 };
+    move_pacman(&ctx->board, 0, &cmd);
+}
+
+static void op_move_ghost(bench_ctx_t* ctx) {
+    command_t cmd = { (ctx->tick++ & 1) ? 'A' : 'D', 1, 0 };
+    move_ghost(&ctx->board, 0, &cmd);
+}
+
+// Um tick do fantasma 0 a correr o seu script (fetch do bytecode + dispatch)
+static void op_ghost_script_tick(bench_ctx_t* ctx) {
+    ghost_t* ghost = &ctx->board.ghosts[0];
+    const instr_t* ins = script_fetch(&ctx->board, ghost->script, &ghost->vm, ghost->pos_x, ghost->pos_y);
+    command_t cmd = { ins->dir, ins->arg, 1 };
+    move_ghost(&ctx->board, 0, &cmd);
+}
+
+// Um "C" seguido da direção: o fantasma atravessa a linha toda
+static void op_move_ghost_charged(bench_ctx_t* ctx) {
+    command_t charge = { 'C', 1, 0 };
+    command_t cmd = { (ctx->tick++ & 1) ? 'A' : 'D', 1, 0 };
+    move_ghost(&ctx->board, 1, &charge);
+    move_ghost(&ctx->board, 1, &cmd);
+}
+
+// O que cada playout do autopiloto faz no início: copiar o nível todo
+static void op_sim_clone_copy(bench_ctx_t* ctx) {
+    if (!ctx->clone) ctx->clone = sim_clone_create(&ctx->board, 1);
+    sim_clone_copy(ctx->clone, &ctx->board);
+}
+
+// Um tick do sim_step numa cópia (recopiada quando o nível acaba)
+static void op_sim_clone_step(bench_ctx_t* ctx) {
+    if (!ctx->clone) ctx->clone = sim_clone_create(&ctx->board, 1);
+    if (!sim_step(sim_clone_board(ctx->clone))) sim_clone_copy(ctx->clone, &ctx->board);
+}
+
+static void op_load_level(bench_ctx_t* ctx) {
+    board_t board;
+    load_level(&board, ctx->dir, ctx->level_file, NULL, 0);
+    unload_level(&board);
+}
+
+static void op_parse_agent_file(bench_ctx_t* ctx) {
+    int x, y, passo;
+    script_t* script = NULL;
+    parse_agent_file(ctx->agent_path, &x, &y, &passo, &script);
+    script_free(script);
+}
+
+static void op_draw_board(bench_ctx_t* ctx) {
+    draw_board(&ctx->board, DRAW_MENU);
+}
+
+static void op_draw_refresh(bench_ctx_t* ctx) {
+    draw_board(&ctx->board, DRAW_MENU);
+    refresh_screen();
+}
+
+static void op_print_board(bench_ctx_t* ctx) {
+    print_board(&ctx->board);
+}
+
+typedef struct {
+    const char* name;
+    bench_op_t op;
+    const char* backend; // Backend de desenho (NULL = não desenha)
+    int needs_terminal;  // Precisa do terminal nulo do ncurses
+} bench_case_t;
+
+static const bench_case_t cases[] = {
+    { "move_pacman",             op_move_pacman,        NULL,      0 },
+    { "move_ghost",              op_move_ghost,         NULL,      0 },
+    { "move_ghost_charged",      op_move_ghost_charged, NULL,      0 },
+    { "ghost_script_tick",       op_ghost_script_tick,  NULL,      0 },
+    { "sim_clone_copy",          op_sim_clone_copy,     NULL,      0 },
+    { "sim_clone_step",          op_sim_clone_step,     NULL,      0 },
+    { "load_level",              op_load_level,         NULL,      0 },
+    { "parse_agent_file",        op_parse_agent_file,   NULL,      0 },
+    { "draw_board",              op_draw_board,         "ncurses", 1 },
+    { "draw_board_refresh",      op_draw_refresh,       "ncurses", 1 },
+    { "draw_board_ansi",         op_draw_board,         "ansi",    0 },
+    { "draw_board_refresh_ansi", op_draw_refresh,       "ansi",    0 },
+    { "draw_board_refresh_null", op_draw_refresh,       "null",    0 },
+    { "print_board",             op_print_board,        NULL,      0 },
+};
+
+static int cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Tamanho do terminal dos casos de desenho: o do terminal nulo do ncurses, que
+// também é dado ao backend ANSI para os dois desenharem o mesmo viewport
+static int term_rows = 24, term_cols = 80;
+
+static void run_case(const bench_case_t* bc, const board_size_t* sz, int samples) {
+    bench_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.dir = bench_dir;
+    snprintf(ctx.level_file, sizeof(ctx.level_file), "%s.lvl", sz->name);
+    snprintf(ctx.agent_path, sizeof(ctx.agent_path), "%s/charged.m", bench_dir);
+
+    if (load_level(&ctx.board, ctx.dir, ctx.level_file, NULL, 0) != 0) {
+        fprintf(stderr, "bench: failed to load %s\n", ctx.level_file);
+        return;
+    }
+    if (bc->backend) display_select(bc->backend);
+
+    // Calibração: quantas operações cabem em ~TARGET_BATCH_NS
+    uint64_t start = now_ns();
+    int calib = 0;
+    do {
+        bc->op(&ctx);
+        calib++;
+    } while (now_ns() - start < TARGET_BATCH_NS && calib < 1000000);
+    uint64_t per_op = (now_ns() - start) / calib;
+    int batch = (per_op > 0) ? (int)(TARGET_BATCH_NS / per_op) : 1000;
+    if (batch < 1) batch = 1;
+
+    uint64_t* per_op_ns = malloc(sizeof(uint64_t) * samples);
+    uint64_t total = 0;
+    for (int s = 0; s < samples; s++) {
+        uint64_t t0 = now_ns();
+        for (int i = 0; i < batch; i++) bc->op(&ctx);
+        uint64_t elapsed = now_ns() - t0;
+        total += elapsed;
+        per_op_ns[s] = elapsed / batch;
+    }
+    qsort(per_op_ns, samples, sizeof(uint64_t), cmp_u64);
+
+    uint64_t ops = (uint64_t)samples * batch;
+    double ns_per_op = (double)total / ops;
+    printf("{\"bench\":\"%s\",\"board\":\"%s\",\"height\":%d,\"width\":%d,",
+           bc->name, sz->name, sz->height, sz->width);
+    if (bc->backend) {
+        // Células dentro do viewport: o trabalho de cada desenho, igual em todos os backends
+        viewport_t vp;
+        memset(&vp, 0, sizeof(vp));
+        viewport_follow(&vp, &ctx.board, term_rows - VIEWPORT_TOP_ROWS - VIEWPORT_BOTTOM_ROWS, term_cols);
+        long cells = (long)vp.width * vp.height;
+        printf("\"cells\":%ld,\"ns_per_cell\":%.2f,", cells, ns_per_op / cells);
+    }
+    printf("\"ops\":%llu,\"ns_per_op\":%.1f,\"p50_ns\":%llu,\"p90_ns\":%llu,"
+           "\"p99_ns\":%llu,\"max_ns\":%llu,\"ops_per_sec\":%.0f}\n",
+           (unsigned long long)ops, ns_per_op,
+           (unsigned long long)per_op_ns[samples / 2],
+           (unsigned long long)per_op_ns[(samples * 90) / 100],
+           (unsigned long long)per_op_ns[(samples * 99) / 100],
+           (unsigned long long)per_op_ns[samples - 1],
+           (ns_per_op > 0) ? 1e9 / ns_per_op : 0.0);
+    fflush(stdout);
+
+    free(per_op_ns);
+    sim_clone_free(ctx.clone);
+    unload_level(&ctx.board);
+}
+
+// Terminal nulo: o ncurses escreve para /dev/null, mas faz todo o trabalho normal
+static SCREEN* null_terminal_init(void) {
+    FILE* out = fopen("/dev/null", "w");
+    FILE* in = fopen("/dev/null", "r");
+    if (!out || !in) return NULL;
+
+    const char* term = getenv("TERM");
+    SCREEN* screen = newterm((term && *term) ? (char*)term : "xterm", out, in);
+    if (!screen) return NULL;
+    set_term(screen);
+    return screen;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-f filter] [-s samples]\n", prog);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    int samples = DEFAULT_SAMPLES;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:h")) != -1) {
+        switch (opt) {
+            case 'f': filter = optarg; break;
+            case 's': samples = atoi(optarg); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (samples < 1) samples = 1;
+
+    if (!mkdtemp(bench_dir)) { perror("mkdtemp"); return 1; }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (write_level(bench_dir, &sizes[i]) != 0) { perror("write_level"); return 1; }
+    }
+
+    open_debug_file("/dev/null");
+    srand(42);
+    SCREEN* screen = null_terminal_init();
+    if (!screen) fprintf(stderr, "bench: no null terminal, skipping ncurses draw benchmarks\n");
+    else {
+        term_rows = LINES;
+        term_cols = COLS;
+    }
+
+    // O backend ANSI escreve os frames para /dev/null (conta o write(), não o terminal),
+    // com o tamanho do terminal nulo do ncurses em vez do tabuleiro todo
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (null_fd >= 0) display_set_output(null_fd);
+    display_set_size(term_rows, term_cols);
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (filter && !strstr(cases[c].name, filter)) continue;
+        if (cases[c].needs_terminal && !screen) continue;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            run_case(&cases[c], &sizes[s], samples);
+        }
+    }
+
+    if (screen) {
+        endwin();
+        delscreen(screen);
+    }
+    if (null_fd >= 0) close(null_fd);
+    close_debug_file();
+
+    // Limpar ficheiros temporários
+    const char* files[] = { "small.lvl", "medium.lvl", "huge.lvl", "bench.p", "bench.m", "charged.m" };
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", bench_dir, files[i]);
+        unlink(path);
+    }
+    rmdir(bench_dir);
+    return 0;
+}
@@ -1,6 +1,13 @@
 #include "board.h"
+#include "rowlock.h"
+#include "chase.h"
+#include "events.h"
+#include "hud.h"
+#include "latency.h"
+#include "histogram.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <stdarg.h>
@@ -8,21 +15,116 @@
 FILE * debugfile;
 
 // Helper private function to find and kill pacman at specific position
+// (the cell keeps the pacman index, so this is O(1) whatever the pacman count)
 static int find_and_kill_pacman(board_t* board, int new_x, int new_y) {
-    for (int p = 0; p < board->n_pacmans; p++) {
-        pacman_t* pac = &board->pacmans[p];
-        if (pac->pos_x == new_x && pac->pos_y == new_y && pac->alive) {
-            pac->alive = 0;
-            kill_pacman(board, p);
-            return DEAD_PACMAN;
-        }
+    int p = board_cell(board, new_x, new_y)->pacman - 1;
+    if (p >= 0 && board->pacmans[p].alive) {
+        kill_pacman(board, p);
+        return DEAD_PACMAN;
     }
     return VALID_MOVE;
 }
 
+board_pos_t board_wall_cell = { 'W', 0, 0, 0 };
+
 // Helper private function for getting board position index
-int get_board_index(board_t* board, int x, int y) {
-    return y * board->width + x;
+long get_board_index(const board_t* board, int x, int y) {
+    return (long)y * board->width + x;
+}
+
+int board_storage_init(board_t* board, int chunked) {
+    board->board = NULL;
+    board->chunks = NULL;
+    if (!chunked) {
+        board->board = calloc((size_t)board->width * board->height, sizeof(board_pos_t));
+        return board->board ? 0 : -1;
+    }
+
+    board_chunks_t* chunks = calloc(1, sizeof(board_chunks_t));
+    if (!chunks) return -1;
+    chunks->tiles_w = (board->width + BOARD_TILE - 1) >> BOARD_TILE_SHIFT;
+    chunks->tiles_h = (board->height + BOARD_TILE - 1) >> BOARD_TILE_SHIFT;
+    size_t n_tiles = (size_t)chunks->tiles_w * chunks->tiles_h;
+    chunks->tiles = calloc(n_tiles, sizeof(board_pos_t*));
+    chunks->tile_order = malloc(n_tiles * sizeof(int));
+    if (!chunks->tiles || !chunks->tile_order) {
+        free(chunks->tiles);
+        free(chunks->tile_order);
+        free(chunks);
+        return -1;
+    }
+    memset(chunks->tile_order, 0xff, n_tiles * sizeof(int)); // -1: nenhum tile alocado
+    board->chunks = chunks;
+    return 0;
+}
+
+void board_storage_free(board_t* board) {
+    free(board->board);
+    board->board = NULL;
+    if (board->chunks) {
+        long n = (long)board->chunks->tiles_w * board->chunks->tiles_h;
+        for (long t = 0; t < n; t++) free(board->chunks->tiles[t]);
+        free(board->chunks->tiles);
+        free(board->chunks->tile_order);
+        free(board->chunks->allocated);
+        free(board->chunks);
+        board->chunks = NULL;
+    }
+}
+
+board_pos_t* board_cell_alloc(board_t* board, int x, int y) {
+    if (board->board) return board_cell(board, x, y);
+
+    board_chunks_t* chunks = board->chunks;
+    long t = (long)(y >> BOARD_TILE_SHIFT) * chunks->tiles_w + (x >> BOARD_TILE_SHIFT);
+    board_pos_t** tile = &chunks->tiles[t];
+    if (!*tile) {
+        if (chunks->n_allocated == chunks->allocated_cap) {
+            long cap = chunks->allocated_cap ? chunks->allocated_cap * 2 : 64;
+            long* allocated = realloc(chunks->allocated, sizeof(long) * cap);
+            if (!allocated) return &board_wall_cell;
+            chunks->allocated = allocated;
+            chunks->allocated_cap = cap;
+        }
+        *tile = malloc(sizeof(board_pos_t) * BOARD_TILE * BOARD_TILE);
+        if (!*tile) return &board_wall_cell;
+        for (int i = 0; i < BOARD_TILE * BOARD_TILE; i++) (*tile)[i] = board_wall_cell;
+        chunks->tile_order[t] = (int)chunks->n_allocated;
+        chunks->allocated[chunks->n_allocated++] = t;
+    }
+    return board_cell(board, x, y);
+}
+
+long board_slots(const board_t* board) {
+    if (board->board) return (long)board->width * board->height;
+    return board->chunks->n_allocated * BOARD_TILE * BOARD_TILE;
+}
+
+void board_slot_xy(const board_t* board, long slot, int* x, int* y) {
+    if (board->board) {
+        *x = (int)(slot % board->width);
+        *y = (int)(slot / board->width);
+        return;
+    }
+    long t = board->chunks->allocated[slot >> (2 * BOARD_TILE_SHIFT)];
+    int in_tile = (int)(slot & (BOARD_TILE * BOARD_TILE - 1));
+    *x = (int)(t % board->chunks->tiles_w) * BOARD_TILE + (in_tile & (BOARD_TILE - 1));
+    *y = (int)(t / board->chunks->tiles_w) * BOARD_TILE + (in_tile >> BOARD_TILE_SHIFT);
+}
+
+size_t board_storage_bytes(const board_t* board) {
+    if (board->board) return (size_t)board->width * board->height * sizeof(board_pos_t);
+    if (!board->chunks) return 0;
+    return (size_t)board->chunks->tiles_w * board->chunks->tiles_h * (sizeof(board_pos_t*) + sizeof(int))
+         + (size_t)board->chunks->n_allocated * (BOARD_TILE * BOARD_TILE * sizeof(board_pos_t) + sizeof(long));
+}
+
+// Helper private function for the 'R' command: rand(), or rand_r on the board's
+// own seed (sim clones, so that parallel playouts do not share the libc state)
+static char random_direction(board_t* board) {
+    static const char directions[] = {'W', 'S', 'A', 'D'};
+    int r = board->rand_seed ? rand_r(board->rand_seed) : rand();
+    return directions[r % 4];
 }
 
 // Helper private function for checking valid position
@@ -34,7 +136,15 @@ void sleep_ms(int milliseconds) {
     struct timespec ts;
     ts.tv_sec = milliseconds / 1000;
     ts.tv_nsec = (milliseconds % 1000) * 1000000;
+    if (!latency_enabled()) {
+        nanosleep(&ts, NULL);
+        return;
+    }
+
+    uint64_t start = now_ns();
     nanosleep(&ts, NULL);
+    uint64_t slept = now_ns() - start, wanted = (uint64_t)milliseconds * 1000000ull;
+    latency_record(LAT_SLEEP_OVERSHOOT, (slept > wanted) ? slept - wanted : 0);
 }
 
 int move_pacman(board_t* board, int pacman_index, command_t* command) {
@@ -58,8 +168,7 @@ int move_pacman(board_t* board, int pacman_index, command_t* command) {
     char direction = command->command;
 
     if (direction == 'R') {
-        char directions[] = {'W', 'S', 'A', 'D'};
-        direction = directions[rand() % 4];
+        direction = random_direction(board);
     }
 
     // Calculate new position based on direction
@@ -76,19 +185,16 @@ int move_pacman(board_t* board, int pacman_index, command_t* command) {
         case 'D': // Right
             new_x++;
             break;
-        case 'T': // Wait
-            if (command->turns_left == 1) {
-                pac->current_move += 1; // move on
-                command->turns_left = command->turns;
-            }
-            else command->turns_left -= 1;
+        case 'T': // Wait (a contagem fica no estado da VM, não no comando)
+            if (command->scripted) vm_wait_tick(&pac->vm, command->turns);
             return VALID_MOVE;
         default:
+            if (command->scripted) vm_advance(&pac->vm); // Comando sem efeito no pacman
             return INVALID_MOVE; // Invalid direction
     }
 
     // Logic for the WASD movement
-    pac->current_move+=1;
+    if (command->scripted) vm_advance(&pac->vm);
 
     // Check boundaries
     if (!is_valid_position(board, new_x, new_y)) {
@@ -96,28 +202,30 @@ int move_pacman(board_t* board, int pacman_index, command_t* command) {
     }
 
     // --- CORREÇÃO: ADICIONAR LOCKS NO PACMAN ---
-    int min_y = (old_y < new_y) ? old_y : new_y;
-    int max_y = (old_y < new_y) ? new_y : old_y;
-    
-    pthread_mutex_lock(&board->row_locks[min_y]);
-    if (min_y != max_y) pthread_mutex_lock(&board->row_locks[max_y]);
+    lock_move_rows(board, old_y, new_y, LOCK_CALLER_PACMAN);
     // ------------------------------------------
 
     int result = VALID_MOVE;
-    int new_index = get_board_index(board, new_x, new_y);
-    int old_index = get_board_index(board, pac->pos_x, pac->pos_y);
-    char target_content = board->board[new_index].content;
+    board_pos_t* new_cell = board_cell(board, new_x, new_y);
+    board_pos_t* old_cell = board_cell(board, pac->pos_x, pac->pos_y);
+    char target_content = new_cell->content;
 
-    if (board->board[new_index].has_portal) {
-        board->board[old_index].content = ' ';
-        board->board[new_index].content = 'P';
-        result = REACHED_PORTAL;
+    // Check for walls and other pacmans
+    if (target_content == 'W' || target_content == 'P') {
+        result = INVALID_MOVE;
         goto unlock_pacman;
     }
 
-    // Check for walls
-    if (target_content == 'W') {
-        result = INVALID_MOVE;
+    if (new_cell->has_portal) {
+        old_cell->content = ' ';
+        old_cell->pacman = 0;
+        new_cell->content = 'P';
+        new_cell->pacman = pacman_index + 1;
+        chase_invalidate(board);
+        event_emit(board, EVENT_MOVE, 0, pacman_index, new_x, new_y);
+        event_emit(board, EVENT_PORTAL_REACHED, 0, pacman_index, new_x, new_y);
+        board_changed(board);
+        result = REACHED_PORTAL;
         goto unlock_pacman;
     }
 
@@ -129,20 +237,25 @@ int move_pacman(board_t* board, int pacman_index, command_t* command) {
     }
 
     // Collect points
-    if (board->board[new_index].has_dot) {
+    if (new_cell->has_dot) {
         pac->points++;
-        board->board[new_index].has_dot = 0;
+        new_cell->has_dot = 0;
+        event_emit(board, EVENT_DOT_EATEN, 0, pacman_index, new_x, new_y);
+        if (!board->quiet) hud_count(HUD_DOTS, 1);
     }
 
-    board->board[old_index].content = ' ';
+    old_cell->content = ' ';
+    old_cell->pacman = 0;
     pac->pos_x = new_x;
     pac->pos_y = new_y;
-    board->board[new_index].content = 'P';
+    new_cell->content = 'P';
+    new_cell->pacman = pacman_index + 1;
+    chase_invalidate(board);
+    event_emit(board, EVENT_MOVE, 0, pacman_index, new_x, new_y);
+    board_changed(board);
 
 unlock_pacman:
-    // LIBERTAR LOCKS PELA ORDEM INVERSA
-    if (min_y != max_y) pthread_mutex_unlock(&board->row_locks[max_y]);
-    pthread_mutex_unlock(&board->row_locks[min_y]);
+    unlock_move_rows(board, old_y, new_y);
 
     return result;
 }
@@ -159,7 +272,7 @@ static int move_ghost_charged_direction(board_t* board, ghost_t* ghost, char dir
             if (y == 0) return INVALID_MOVE;
             *new_y = 0; // In case there is no colision
             for (int i = y - 1; i >= 0; i--) {
-                char target_content = board->board[get_board_index(board, x, i)].content;
+                char target_content = board_cell(board, x, i)->content;
                 if (target_content == 'W' || target_content == 'M') {
                     *new_y = i + 1; // stop before colision
                     return VALID_MOVE;
@@ -175,7 +288,7 @@ static int move_ghost_charged_direction(board_t* board, ghost_t* ghost, char dir
             if (y == board->height - 1) return INVALID_MOVE;
             *new_y = board->height - 1; // In case there is no colision
             for (int i = y + 1; i < board->height; i++) {
-                char target_content = board->board[get_board_index(board, x, i)].content;
+                char target_content = board_cell(board, x, i)->content;
                 if (target_content == 'W' || target_content == 'M') {
                     *new_y = i - 1; // stop before colision
                     return VALID_MOVE;
@@ -191,7 +304,7 @@ static int move_ghost_charged_direction(board_t* board, ghost_t* ghost, char dir
             if (x == 0) return INVALID_MOVE;
             *new_x = 0; // In case there is no colision
             for (int j = x - 1; j >= 0; j--) {
-                char target_content = board->board[get_board_index(board, j, y)].content;
+                char target_content = board_cell(board, j, y)->content;
                 if (target_content == 'W' || target_content == 'M') {
                     *new_x = j + 1; // stop before colision
                     return VALID_MOVE;
@@ -207,7 +320,7 @@ static int move_ghost_charged_direction(board_t* board, ghost_t* ghost, char dir
             if (x == board->width - 1) return INVALID_MOVE;
             *new_x = board->width - 1; // In case there is no colision
             for (int j = x + 1; j < board->width; j++) {
-                char target_content = board->board[get_board_index(board, j, y)].content;
+                char target_content = board_cell(board, j, y)->content;
                 if (target_content == 'W' || target_content == 'M') {
                     *new_x = j - 1; // stop before colision
                     return VALID_MOVE;
@@ -219,7 +332,7 @@ static int move_ghost_charged_direction(board_t* board, ghost_t* ghost, char dir
             }
             break;
         default:
-            debug("DEFAULT CHARGED MOVE - direction = %c\n", direction);
+            if (!board->quiet) debug("DEFAULT CHARGED MOVE - direction = %c\n", direction);
             return INVALID_MOVE;
     }
     return VALID_MOVE;
@@ -244,30 +357,28 @@ int move_ghost_charged(board_t* board, int ghost_index, char direction) {
     
     int result = move_ghost_charged_direction(board, ghost, direction, &new_x, &new_y);
     if (result == INVALID_MOVE) {
-        debug("DEFAULT CHARGED MOVE - direction = %c\n", direction);
+        if (!board->quiet) debug("DEFAULT CHARGED MOVE - direction = %c\n", direction);
         return INVALID_MOVE;
     }
 
     // Locks para escrita
-    int min_y = (old_y < new_y) ? old_y : new_y;
-    int max_y = (old_y < new_y) ? new_y : old_y;
-    pthread_mutex_lock(&board->row_locks[min_y]);
-    if (min_y != max_y) pthread_mutex_lock(&board->row_locks[max_y]);
+    lock_move_rows(board, old_y, new_y, LOCK_CALLER_CHARGED);
 
-    // Get board indices
-    int old_index = get_board_index(board, ghost->pos_x, ghost->pos_y);
-    int new_index = get_board_index(board, new_x, new_y);
+    // Get board cells
+    board_pos_t* old_cell = board_cell(board, ghost->pos_x, ghost->pos_y);
+    board_pos_t* new_cell = board_cell(board, new_x, new_y);
 
     // Update board - clear old position (restore what was there)
-    board->board[old_index].content = ' '; 
+    old_cell->content = ' '; 
     // Update ghost position
     ghost->pos_x = new_x;
     ghost->pos_y = new_y;
     // Update board - set new position
-    board->board[new_index].content = 'M';
+    new_cell->content = 'M';
+    event_emit(board, EVENT_MOVE, 1, ghost_index, new_x, new_y);
+    board_changed(board);
     
-    if (min_y != max_y) pthread_mutex_unlock(&board->row_locks[max_y]);
-    pthread_mutex_unlock(&board->row_locks[min_y]);
+    unlock_move_rows(board, old_y, new_y);
     
     return result;
 }
@@ -287,10 +398,13 @@ int move_ghost(board_t* board, int ghost_index, command_t* command) {
     ghost->waiting = ghost->passo;
 
     char direction = command->command;
+
+    if (direction == 'H') { // Hunt: follow the shared distance field
+        direction = chase_direction(board, ghost_index);
+    }
     
     if (direction == 'R') {
-        char directions[] = {'W', 'S', 'A', 'D'};
-        direction = directions[rand() % 4];
+        direction = random_direction(board);
     }
 
     // Calculate new position based on direction
@@ -308,22 +422,21 @@ int move_ghost(board_t* board, int ghost_index, command_t* command) {
             new_x++;
             break;
         case 'C': // Charge
-            ghost->current_move += 1;
+            if (command->scripted) vm_advance(&ghost->vm);
             ghost->charged = 1;
+            event_emit(board, EVENT_GHOST_CHARGED, 1, ghost_index, ghost->pos_x, ghost->pos_y);
+            board_changed(board); // O fantasma carregado é desenhado de outra forma
             return VALID_MOVE;
         case 'T': // Wait
-            if (command->turns_left == 1) {
-                ghost->current_move += 1; // move on
-                command->turns_left = command->turns;
-            }
-            else command->turns_left -= 1;
+            if (command->scripted) vm_wait_tick(&ghost->vm, command->turns);
             return VALID_MOVE;
         default:
+            if (command->scripted) vm_advance(&ghost->vm);
             return INVALID_MOVE; // Invalid direction
     }
 
     // Logic for the WASD movement
-    ghost->current_move++;
+    if (command->scripted) vm_advance(&ghost->vm);
     if (ghost->charged)
         return move_ghost_charged(board, ghost_index, direction);
 
@@ -331,17 +444,13 @@ int move_ghost(board_t* board, int ghost_index, command_t* command) {
     if (!is_valid_position(board, new_x, new_y)) {
         return INVALID_MOVE;
     }
-    int min_y = (old_y < new_y) ? old_y : new_y;
-    int max_y = (old_y < new_y) ? new_y : old_y;
-
-    pthread_mutex_lock(&board->row_locks[min_y]);
-    if (min_y != max_y) pthread_mutex_lock(&board->row_locks[max_y]);
+    lock_move_rows(board, old_y, new_y, LOCK_CALLER_GHOST);
 
     // Check board position
     int result = VALID_MOVE;
-    int new_index = get_board_index(board, new_x, new_y);
-    int old_index = get_board_index(board, ghost->pos_x, ghost->pos_y);
-    char target_content = board->board[new_index].content;
+    board_pos_t* new_cell = board_cell(board, new_x, new_y);
+    board_pos_t* old_cell = board_cell(board, ghost->pos_x, ghost->pos_y);
+    char target_content = new_cell->content;
 
     // Check for walls and ghosts
     if (target_content == 'W' || target_content == 'M') {
@@ -355,32 +464,87 @@ int move_ghost(board_t* board, int ghost_index, command_t* command) {
     }
 
     // Update board - clear old position (restore what was there)
-    board->board[old_index].content = ' '; 
+    old_cell->content = ' '; 
 
     // Update ghost position
     ghost->pos_x = new_x;
     ghost->pos_y = new_y;
 
     // Update board - set new position
-    board->board[new_index].content = 'M';
+    new_cell->content = 'M';
+    event_emit(board, EVENT_MOVE, 1, ghost_index, new_x, new_y);
+    board_changed(board);
 
 unlock_ghost:
-    if (min_y != max_y) pthread_mutex_unlock(&board->row_locks[max_y]);
-    pthread_mutex_unlock(&board->row_locks[min_y]);
+    unlock_move_rows(board, old_y, new_y);
 
     return result;
 }
 
 void kill_pacman(board_t* board, int pacman_index) {
-    debug("Killing %d pacman\n\n", pacman_index);
+    if (!board->quiet) debug("Killing %d pacman\n\n", pacman_index);
     pacman_t* pac = &board->pacmans[pacman_index];
-    int index = pac->pos_y * board->width + pac->pos_x;
+    board_pos_t* cell = board_cell(board, pac->pos_x, pac->pos_y);
 
     // Remove pacman from the board
-    board->board[index].content = ' ';
+    cell->content = ' ';
+    cell->pacman = 0;
 
     // Mark pacman as dead
     pac->alive = 0;
+    chase_invalidate(board);
+    event_emit(board, EVENT_PACMAN_KILLED, 0, pacman_index, pac->pos_x, pac->pos_y);
+    if (!board->quiet) hud_count(HUD_DEATHS, 1);
+    board_changed(board);
+}
+
+int pacmans_alive(board_t* board) {
+    int alive = 0;
+    for (int p = 0; p < board->n_pacmans; p++) {
+        if (board->pacmans[p].alive) alive++;
+    }
+    return alive;
+}
+
+void update_game_status(board_t* board, int result) {
+    if (result == REACHED_PORTAL) {
+        board->exit_status = GAME_WON;
+        board->game_running = 0;
+        board_changed(board);
+    } else if (result == DEAD_PACMAN && pacmans_alive(board) == 0) {
+        board->exit_status = GAME_LOST;
+        board->game_running = 0;
+        board_changed(board);
+    }
+}
+
+void board_changed(board_t* board) {
+    if (board->rows_owned) return; // Faixas: uma geração por tick (bands_step), sem partilhar a linha de cache
+    atomic_fetch_add(&board->generation, 1);
+    // Só escreve no pipe se a UI estiver parada à espera (no máximo um write por espera)
+    if (atomic_exchange(&board->render_armed, 0)) {
+        ssize_t ignored = write(board->wake_fd[1], "", 1);
+        (void)ignored;
+    }
+}
+
+int board_wake_open(board_t* board) {
+    if (pipe(board->wake_fd) == -1) {
+        board->wake_fd[0] = board->wake_fd[1] = -1;
+        return -1;
+    }
+    // Nunca bloquear: nem quem avisa (pipe cheio) nem a UI a esvaziar o pipe
+    fcntl(board->wake_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(board->wake_fd[1], F_SETFL, O_NONBLOCK);
+    return 0;
+}
+
+void board_wake_close(board_t* board) {
+    atomic_store(&board->render_armed, 0);
+    for (int i = 0; i < 2; i++) {
+        if (board->wake_fd[i] != -1) close(board->wake_fd[i]);
+        board->wake_fd[i] = -1;
+    }
 }
 
 
@@ -391,10 +555,13 @@ void open_debug_file(char *filename) {
 }
 
 void close_debug_file() {
-    fclose(debugfile);
+    if (debugfile) fclose(debugfile);
+    debugfile = NULL;
 }
 
 void debug(const char * format, ...) {
+    if (!debugfile) return; // Modos headless (batch) não abrem o debug.log
+
     va_list args;
     va_start(args, format);
     vfprintf(debugfile, format, args);
@@ -404,47 +571,53 @@ void debug(const char * format, ...) {
 }
 
 void print_board(board_t *board) {
-    if (!board || !board->board) {
+    if (!board || (!board->board && !board->chunks)) {
         debug("[%d] Board is empty or not initialized.\n", getpid());
         return;
     }
 
-    // Large buffer to accumulate the whole output
-    char buffer[8192];
+    // Buffer dimensionado para o tabuleiro inteiro (um buffer fixo transbordava em mapas grandes)
+    size_t size = 1024 + (size_t)(board->n_ghosts + board->n_pacmans) * (MAX_FILENAME + 8)
+                + (size_t)(board->width + 1) * board->height;
+    char* buffer = malloc(size);
+    if (!buffer) return;
     size_t offset = 0;
 
-    offset += snprintf(buffer + offset, sizeof(buffer) - offset,
+    offset += snprintf(buffer + offset, size - offset,
                        "=== [%d] LEVEL INFO ===\n"
                        "Dimensions: %d x %d\n"
-                       "Tempo: %d\n"
-                       "Pacman file: %s\n",
-                       getpid(), board->height, board->width, board->tempo, board->pacman_file);
+                       "Tempo: %d\n",
+                       getpid(), board->height, board->width, board->tempo);
+
+    offset += snprintf(buffer + offset, size - offset,
+                       "Pacman files (%d):\n", board->n_pacmans);
+
+    for (int i = 0; i < board->n_pacmans && board->pacman_files; i++) {
+        offset += snprintf(buffer + offset, size - offset,
+                           "  - %s\n", board->pacman_files[i]);
+    }
 
-    offset += snprintf(buffer + offset, sizeof(buffer) - offset,
+    offset += snprintf(buffer + offset, size - offset,
                        "Monster files (%d):\n", board->n_ghosts);
 
     for (int i = 0; i < board->n_ghosts; i++) {
-        offset += snprintf(buffer + offset, sizeof(buffer) - offset,
+        offset += snprintf(buffer + offset, size - offset,
                            "  - %s\n", board->ghosts_files[i]);
     }
 
-    offset += snprintf(buffer + offset, sizeof(buffer) - offset, "\n=== BOARD ===\n");
+    offset += snprintf(buffer + offset, size - offset, "\n=== BOARD ===\n");
 
     for (int y = 0; y < board->height; y++) {
         for (int x = 0; x < board->width; x++) {
-            int idx = y * board->width + x;
-            if (offset < sizeof(buffer) - 2) {
-                buffer[offset++] = board->board[idx].content;
-            }
-        }
-        if (offset < sizeof(buffer) - 2) {
-            buffer[offset++] = '\n';
+            buffer[offset++] = board_cell(board, x, y)->content;
         }
+        buffer[offset++] = '\n';
     }
 
-    offset += snprintf(buffer + offset, sizeof(buffer) - offset, "==================\n");
+    offset += snprintf(buffer + offset, size - offset, "==================\n");
 
     buffer[offset] = '\0';
 
     debug("%s", buffer);
-}
\ No newline at end of file
+    free(buffer);
+}
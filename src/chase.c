@@ -0,0 +1,208 @@
+#include "chase.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+
+// Um buffer de distâncias (-1 = inalcançável) com o seu seqlock: seq é ímpar
+// enquanto o BFS escreve nele. Quem lê copia os vizinhos e confirma que seq
+// não mudou, porque duas reconstruções seguidas podem voltar a escrever no
+// buffer que um fantasma ainda está a ler.
+struct chase_buffer {
+    atomic_ulong seq;
+    atomic_int* dist;
+};
+
+struct chase_field {
+    pthread_mutex_t build_lock;         // Serializa as reconstruções
+    struct chase_buffer buffers[2];     // Double buffer: lê-se um enquanto se escreve o outro
+    long* queue;
+    atomic_int published;               // Índice do buffer publicado
+    atomic_ulong built_version;         // pacman_version usado no último BFS
+};
+
+static struct chase_field* chase_get(board_t* board) {
+    struct chase_field* field = atomic_load_explicit(&board->chase, memory_order_acquire);
+    if (field) return field;
+
+    // Primeira utilização neste nível: alocar sob o global_stats_lock
+    pthread_mutex_lock(&board->global_stats_lock);
+    field = atomic_load_explicit(&board->chase, memory_order_relaxed);
+    if (!field) {
+        size_t cells = (size_t)board_slots(board); // Nos chunks, só os tiles alocados
+        field = calloc(1, sizeof(*field));
+        pthread_mutex_init(&field->build_lock, NULL);
+        field->buffers[0].dist = malloc(sizeof(atomic_int) * cells);
+        field->buffers[1].dist = malloc(sizeof(atomic_int) * cells);
+        field->queue = malloc(sizeof(long) * cells);
+        atomic_init(&field->built_version, ~0ul);
+        atomic_store_explicit(&board->chase, field, memory_order_release);
+    }
+    pthread_mutex_unlock(&board->global_stats_lock);
+    return field;
+}
+
+// Loads/stores relaxed: o seqlock do buffer é que ordena (ver chase_read)
+#define DIST_GET(dist, i) atomic_load_explicit(&(dist)[i], memory_order_relaxed)
+#define DIST_SET(dist, i, v) atomic_store_explicit(&(dist)[i], (v), memory_order_relaxed)
+
+// BFS a partir de todos os pacmans vivos; paredes bloqueiam, fantasmas não
+// (mexem-se), por isso o campo só muda quando um pacman se mexe.
+// dist e queue são indexados por board_slot (nos chunks não há entradas para os tiles só de paredes)
+static void chase_build(board_t* board, atomic_int* dist, long* queue) {
+    static const int dx[4] = { 0, 0, -1, 1 };
+    static const int dy[4] = { -1, 1, 0, 0 };
+    long head = 0, tail = 0;
+
+    for (long i = 0, n = board_slots(board); i < n; i++) DIST_SET(dist, i, -1);
+    for (int p = 0; p < board->n_pacmans; p++) {
+        pacman_t* pac = &board->pacmans[p];
+        if (!pac->alive) continue;
+        long slot = board_slot(board, pac->pos_x, pac->pos_y);
+        if (slot < 0 || DIST_GET(dist, slot) == 0) continue;
+        DIST_SET(dist, slot, 0);
+        queue[tail++] = slot;
+    }
+
+    while (head < tail) {
+        long slot = queue[head++];
+        int x, y;
+        board_slot_xy(board, slot, &x, &y);
+        int d = DIST_GET(dist, slot) + 1;
+        for (int k = 0; k < 4; k++) {
+            int nx = x + dx[k], ny = y + dy[k];
+            if (nx < 0 || nx >= board->width || ny < 0 || ny >= board->height) continue;
+            long n = board_slot(board, nx, ny);
+            if (n < 0 || DIST_GET(dist, n) >= 0 || board_cell(board, nx, ny)->content == 'W') continue;
+            DIST_SET(dist, n, d);
+            queue[tail++] = n;
+        }
+    }
+}
+
+// Reconstrói o campo se um pacman se mexeu desde o último BFS
+static void chase_refresh(board_t* board, struct chase_field* field) {
+    unsigned long version = atomic_load_explicit(&board->pacman_version, memory_order_acquire);
+    if (atomic_load_explicit(&field->built_version, memory_order_acquire) == version) return;
+
+    // EOWNERDEAD: um worker de --procs morreu a meio de um BFS; built_version
+    // ainda é o antigo e o buffer publicado não foi tocado, por isso basta refazer
+    if (pthread_mutex_lock(&field->build_lock) == EOWNERDEAD) pthread_mutex_consistent(&field->build_lock);
+    if (atomic_load_explicit(&field->built_version, memory_order_relaxed) != version) {
+        // Escreve no buffer que não está publicado e depois troca
+        int back = !atomic_load_explicit(&field->published, memory_order_relaxed);
+        struct chase_buffer* buf = &field->buffers[back];
+
+        // Ímpar durante o BFS (| 1: um BFS interrompido pode ter deixado seq ímpar)
+        unsigned long seq = atomic_load_explicit(&buf->seq, memory_order_relaxed) | 1;
+        atomic_store_explicit(&buf->seq, seq, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        chase_build(board, buf->dist, field->queue);
+        atomic_store_explicit(&buf->seq, seq + 1, memory_order_release);
+
+        atomic_store_explicit(&field->published, back, memory_order_release);
+        atomic_store_explicit(&field->built_version, version, memory_order_release);
+    }
+    pthread_mutex_unlock(&field->build_lock);
+}
+
+// Copia as distâncias de n células (idx < 0 dá -1) do buffer publicado,
+// repetindo se uma reconstrução lhe tocou entretanto
+static void chase_read(struct chase_field* field, const long* idx, int* out, int n) {
+    for (;;) {
+        struct chase_buffer* buf = &field->buffers[atomic_load_explicit(&field->published, memory_order_acquire)];
+        unsigned long seq = atomic_load_explicit(&buf->seq, memory_order_acquire);
+        if (seq & 1) continue; // A ser reescrito: entretanto já foi publicado o outro
+
+        for (int k = 0; k < n; k++) out[k] = (idx[k] < 0) ? -1 : DIST_GET(buf->dist, idx[k]);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&buf->seq, memory_order_relaxed) == seq) return;
+    }
+}
+
+char chase_direction(board_t* board, int ghost_index) {
+    ghost_t* ghost = &board->ghosts[ghost_index];
+    struct chase_field* field = chase_get(board);
+    chase_refresh(board, field);
+
+    static const char dirs[4] = { 'W', 'S', 'A', 'D' };
+    static const int dx[4] = { 0, 0, -1, 1 };
+    static const int dy[4] = { -1, 1, 0, 0 };
+
+    long slot[4];
+    for (int k = 0; k < 4; k++) {
+        int x = ghost->pos_x + dx[k], y = ghost->pos_y + dy[k];
+        int inside = x >= 0 && x < board->width && y >= 0 && y < board->height;
+        slot[k] = inside ? board_slot(board, x, y) : -1;
+    }
+    int dist[4];
+    chase_read(field, slot, dist, 4);
+
+    char best = 'R';
+    int best_dist = -1;
+    for (int k = 0; k < 4; k++) {
+        if (dist[k] < 0 || board_cell(board, ghost->pos_x + dx[k], ghost->pos_y + dy[k])->content == 'M') continue;
+        if (best_dist < 0 || dist[k] < best_dist) {
+            best_dist = dist[k];
+            best = dirs[k];
+        }
+    }
+    return best;
+}
+
+void chase_invalidate(board_t* board) {
+    atomic_fetch_add_explicit(&board->pacman_version, 1, memory_order_release);
+}
+
+void chase_after_fork(board_t* board) {
+    struct chase_field* field = atomic_load(&board->chase);
+    if (!field) return;
+
+    pthread_mutex_init(&field->build_lock, NULL);
+    atomic_store(&field->built_version, ~0ul);
+}
+
+size_t chase_shared_bytes(const board_t* board) {
+    size_t cells = (size_t)board_slots(board);
+    return sizeof(struct chase_field) + sizeof(long) * cells + sizeof(atomic_int) * cells * 2;
+}
+
+void chase_place_shared(board_t* board, void* mem) {
+    size_t cells = (size_t)board_slots(board);
+    struct chase_field* field = mem;
+    memset(field, 0, sizeof(*field));
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&field->build_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    // A fila (long) logo a seguir à struct, para ficar alinhada
+    field->queue = (long*)(field + 1);
+    field->buffers[0].dist = (atomic_int*)(field->queue + cells);
+    field->buffers[1].dist = field->buffers[0].dist + cells;
+    atomic_init(&field->published, 0);
+    atomic_init(&field->built_version, ~0ul);
+    atomic_store(&board->chase, field);
+}
+
+void chase_release_shared(board_t* board) {
+    struct chase_field* field = atomic_load(&board->chase);
+    if (!field) return;
+    pthread_mutex_destroy(&field->build_lock);
+    atomic_store(&board->chase, NULL);
+}
+
+void chase_free(board_t* board) {
+    struct chase_field* field = atomic_load(&board->chase);
+    if (!field) return;
+
+    pthread_mutex_destroy(&field->build_lock);
+    free(field->buffers[0].dist);
+    free(field->buffers[1].dist);
+    free(field->queue);
+    free(field);
+    atomic_store(&board->chase, NULL);
+}
@@ -0,0 +1,427 @@
+#include "control.h"
+#include "batch.h"
+#include "board.h"
+#include "files.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+#define READ_CHUNK 4096
+#define MAX_STEP 1000000
+
+// Jogada marcada para um tick
+typedef struct {
+    long tick;
+    char cmd;
+} queued_cmd_t;
+
+// Fila de um pacman, ordenada por tick
+typedef struct {
+    queued_cmd_t* items;
+    int head, n, cap;
+} cmd_queue_t;
+
+// Último estado enviado de um agente (para só mandar o que mudou)
+typedef struct {
+    int x, y;
+    int points; // Fantasmas: charged
+    int alive;
+} sent_state_t;
+
+typedef struct {
+    int fd;
+    const char* dir;
+    struct dirent** levels;
+    int n_levels;
+    int level;
+
+    board_t board;
+    int loaded;
+    long tick;
+    int* points; // Pontos acumulados (passam para o nível seguinte)
+    int n_points;
+
+    cmd_queue_t* queues; // Uma por pacman
+    char* tick_cmds;     // Jogadas do tick atual (sim_step_with)
+    sent_state_t* sent_pacmans;
+    sent_state_t* sent_ghosts;
+
+    char* out;
+    size_t out_len, out_cap;
+    int done;
+} control_t;
+
+__attribute__((format(printf, 2, 3)))
+static void out_printf(control_t* c, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (n <= 0) return;
+
+    if (c->out_len + n + 1 > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : READ_CHUNK;
+        while (cap < c->out_len + n + 1) cap *= 2;
+        c->out = realloc(c->out, cap);
+        c->out_cap = cap;
+    }
+    va_start(args, format);
+    vsnprintf(c->out + c->out_len, n + 1, format, args);
+    va_end(args);
+    c->out_len += n;
+}
+
+// Uma resposta por lote de comandos: um só send()
+static int out_flush(control_t* c) {
+    size_t sent = 0;
+    while (sent < c->out_len) {
+        ssize_t n = send(c->fd, c->out + sent, c->out_len - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        sent += n;
+    }
+    c->out_len = 0;
+    return 0;
+}
+
+// --- Filas de jogadas ---
+
+static long queue_last_tick(const cmd_queue_t* q) {
+    return q->n ? q->items[q->head + q->n - 1].tick : 0;
+}
+
+static void queue_push(cmd_queue_t* q, long tick, char cmd) {
+    if (q->head > 0 && q->head + q->n == q->cap) { // Compactar antes de crescer
+        memmove(q->items, q->items + q->head, sizeof(queued_cmd_t) * q->n);
+        q->head = 0;
+    }
+    if (q->head + q->n == q->cap) {
+        q->cap = q->cap ? q->cap * 2 : 16;
+        q->items = realloc(q->items, sizeof(queued_cmd_t) * q->cap);
+    }
+
+    // Quase sempre no fim; um @tick antigo é inserido no sítio (e substitui o do mesmo tick)
+    int i = q->head + q->n;
+    while (i > q->head && q->items[i - 1].tick > tick) i--;
+    if (i > q->head && q->items[i - 1].tick == tick) {
+        q->items[i - 1].cmd = cmd;
+        return;
+    }
+    memmove(&q->items[i + 1], &q->items[i], sizeof(queued_cmd_t) * (q->head + q->n - i));
+    q->items[i] = (queued_cmd_t){ tick, cmd };
+    q->n++;
+}
+
+// Jogada para 'tick' ('\0' se não houver); descarta as de ticks anteriores
+static char queue_pop(cmd_queue_t* q, long tick) {
+    while (q->n && q->items[q->head].tick < tick) { q->head++; q->n--; }
+    if (q->n && q->items[q->head].tick == tick) {
+        q->n--;
+        return q->items[q->head++].cmd;
+    }
+    return '\0';
+}
+
+// --- Estado ---
+
+static void send_pacman(control_t* c, int p) {
+    pacman_t* pac = &c->board.pacmans[p];
+    sent_state_t now = { pac->pos_x, pac->pos_y, pac->points, pac->alive };
+    sent_state_t* sent = &c->sent_pacmans[p];
+    if (memcmp(&now, sent, sizeof(now)) == 0) return;
+    *sent = now;
+    out_printf(c, "P %d %d %d %d %d\n", p, now.x, now.y, now.points, now.alive);
+}
+
+static void send_ghost(control_t* c, int g) {
+    ghost_t* ghost = &c->board.ghosts[g];
+    sent_state_t now = { ghost->pos_x, ghost->pos_y, ghost->charged, 1 };
+    sent_state_t* sent = &c->sent_ghosts[g];
+    if (memcmp(&now, sent, sizeof(now)) == 0) return;
+    *sent = now;
+    out_printf(c, "M %d %d %d %d\n", g, now.x, now.y, now.points);
+}
+
+static void send_agents(control_t* c) {
+    for (int p = 0; p < c->board.n_pacmans; p++) send_pacman(c, p);
+    for (int g = 0; g < c->board.n_ghosts; g++) send_ghost(c, g);
+}
+
+// Mapa no formato dos .lvl (sem os agentes) e todos os agentes
+static void send_full_state(control_t* c) {
+    board_t* board = &c->board;
+    out_printf(c, "LEVEL %s %d %d %d %d\n", board->level_name, board->height, board->width,
+               board->n_pacmans, board->n_ghosts);
+
+    char* row = malloc(board->width + 1);
+    for (int y = 0; y < board->height; y++) {
+        for (int x = 0; x < board->width; x++) {
+            const board_pos_t* cell = board_cell(board, x, y);
+            row[x] = (cell->content == 'W') ? 'X' : cell->has_portal ? '@' : cell->has_dot ? 'o' : ' ';
+        }
+        row[board->width] = '\0';
+        out_printf(c, "R %s\n", row);
+    }
+    free(row);
+
+    // Forçar o envio de todos os agentes
+    memset(c->sent_pacmans, 0xff, sizeof(sent_state_t) * board->n_pacmans);
+    memset(c->sent_ghosts, 0xff, sizeof(sent_state_t) * board->n_ghosts);
+    send_agents(c);
+}
+
+// --- Níveis ---
+
+static void free_level_state(control_t* c) {
+    for (int p = 0; c->queues && p < c->board.n_pacmans; p++) free(c->queues[p].items);
+    free(c->queues);
+    free(c->tick_cmds);
+    free(c->sent_pacmans);
+    free(c->sent_ghosts);
+    c->queues = NULL;
+    c->tick_cmds = NULL;
+    c->sent_pacmans = c->sent_ghosts = NULL;
+}
+
+static void finish(control_t* c, int status) {
+    out_printf(c, "DONE %s\n", batch_status_name(status));
+    c->done = 1;
+}
+
+static void start_level(control_t* c) {
+    const char* name = c->levels[c->level]->d_name;
+    if (load_level(&c->board, c->dir, name, c->points, c->n_points) != 0) {
+        out_printf(c, "ERR cannot load %s\n", name);
+        finish(c, BATCH_LOAD_ERROR);
+        return;
+    }
+    c->loaded = 1;
+    c->tick = 0;
+    c->queues = calloc(c->board.n_pacmans, sizeof(cmd_queue_t));
+    c->tick_cmds = calloc(c->board.n_pacmans, 1);
+    c->sent_pacmans = calloc(c->board.n_pacmans, sizeof(sent_state_t));
+    c->sent_ghosts = calloc(c->board.n_ghosts > 0 ? c->board.n_ghosts : 1, sizeof(sent_state_t));
+    send_full_state(c);
+}
+
+static void end_level(control_t* c) {
+    int status = c->board.exit_status;
+    out_printf(c, "E %s %ld\n", batch_status_name(status), c->tick);
+
+    free(c->points);
+    c->n_points = c->board.n_pacmans;
+    c->points = malloc(sizeof(int) * c->n_points);
+    for (int p = 0; p < c->n_points; p++) c->points[p] = c->board.pacmans[p].points;
+    free_level_state(c);
+    unload_level(&c->board);
+    c->loaded = 0;
+
+    if (status == GAME_WON && c->level + 1 < c->n_levels) {
+        c->level++;
+        start_level(c);
+    }
+    else {
+        finish(c, status);
+    }
+}
+
+static void step(control_t* c, long n) {
+    for (long i = 0; i < n && !c->done; i++) {
+        c->tick++;
+        for (int p = 0; p < c->board.n_pacmans; p++) c->tick_cmds[p] = queue_pop(&c->queues[p], c->tick);
+        sim_step_with(&c->board, c->tick_cmds);
+
+        out_printf(c, "T %ld\n", c->tick);
+        send_agents(c);
+        if (!c->board.game_running) {
+            end_level(c);
+            break; // O cliente vê o fim do nível antes de jogar o seguinte
+        }
+    }
+}
+
+// --- Comandos ---
+
+// CMD [@tick] <p> <dirs>
+static void command_cmd(control_t* c, char* args) {
+    long start = -1;
+    char* token = strtok(args, " \t");
+    if (token && token[0] == '@') {
+        start = strtol(token + 1, NULL, 10);
+        token = strtok(NULL, " \t");
+    }
+    char* dirs = strtok(NULL, " \t");
+    if (!token || !dirs) { out_printf(c, "ERR usage: CMD [@tick] <pacman> <dirs>\n"); return; }
+
+    int p = atoi(token);
+    if (p < 0 || p >= c->board.n_pacmans) { out_printf(c, "ERR no pacman %d\n", p); return; }
+
+    cmd_queue_t* q = &c->queues[p];
+    if (start < 0) {
+        long last = queue_last_tick(q);
+        start = (last > c->tick) ? last + 1 : c->tick + 1;
+    }
+    if (start <= c->tick) { out_printf(c, "ERR late: tick %ld already played\n", start); return; }
+
+    for (int i = 0; dirs[i]; i++) {
+        char cmd = toupper((unsigned char)dirs[i]);
+        if (!strchr("WASDRTQ", cmd)) { out_printf(c, "ERR bad command %c\n", dirs[i]); return; }
+        queue_push(q, start + i, cmd);
+    }
+}
+
+static void handle_line(control_t* c, char* line) {
+    char* args = line;
+    while (*args && !isspace((unsigned char)*args)) args++;
+    if (*args) *args++ = '\0';
+
+    if (strcmp(line, "CMD") == 0) {
+        command_cmd(c, args);
+    }
+    else if (strcmp(line, "STEP") == 0) {
+        long n = *args ? strtol(args, NULL, 10) : 1;
+        if (n < 1 || n > MAX_STEP) { out_printf(c, "ERR bad step count\n"); return; }
+        step(c, n);
+        if (!c->done) out_printf(c, "OK %ld\n", c->tick);
+    }
+    else if (strcmp(line, "STATE") == 0) {
+        send_full_state(c);
+        out_printf(c, "OK %ld\n", c->tick);
+    }
+    else if (*line) {
+        out_printf(c, "ERR unknown command %s\n", line);
+    }
+}
+
+// Lê lotes de comandos até ao fim do jogo ou até o cliente fechar a ligação
+static void serve(control_t* c) {
+    char* in = malloc(READ_CHUNK);
+    size_t in_len = 0, in_cap = READ_CHUNK;
+
+    start_level(c);
+    if (!c->done) out_printf(c, "OK %ld\n", c->tick);
+    if (out_flush(c) != 0) c->done = 1;
+
+    while (!c->done) {
+        if (in_len == in_cap) {
+            in_cap *= 2;
+            in = realloc(in, in_cap);
+        }
+        ssize_t n = read(c->fd, in + in_len, in_cap - in_len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        in_len += n;
+
+        // Todas as linhas completas deste read(); o resto fica para o próximo
+        size_t start = 0;
+        for (size_t i = 0; i < in_len && !c->done; i++) {
+            if (in[i] != '\n') continue;
+            in[i] = '\0';
+            if (i > start && in[i - 1] == '\r') in[i - 1] = '\0';
+            handle_line(c, in + start);
+            start = i + 1;
+        }
+        memmove(in, in + start, in_len - start);
+        in_len -= start;
+
+        if (out_flush(c) != 0) break;
+    }
+    free(in);
+}
+
+static int listen_on(const char* path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "control: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Só se apaga um socket (de uma corrida anterior): um engano no caminho não pode apagar um ficheiro
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "control: %s exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { perror("control: socket"); return -1; }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: Pacmanist --control [-s seed] <socket> <dir>\n"
+        "  Espera por um cliente no socket UNIX e joga os níveis da pasta ao ritmo dos seus STEP\n"
+        "  (protocolo em control.h)\n");
+}
+
+int run_control(int argc, char** argv) {
+    unsigned int seed = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:h")) != -1) {
+        switch (opt) {
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default: usage(); return 1;
+        }
+    }
+    if (argc - optind != 2) { usage(); return 1; }
+    const char* socket_path = argv[optind];
+
+    control_t c = { .dir = argv[optind + 1] };
+    c.n_levels = scandir(c.dir, &c.levels, filter_levels, alphasort);
+    if (c.n_levels < 0) { perror(c.dir); return 1; }
+    if (c.n_levels == 0) {
+        fprintf(stderr, "control: no levels found\n");
+        free(c.levels);
+        return 1;
+    }
+
+    int listen_fd = listen_on(socket_path);
+    if (listen_fd < 0) return 1;
+    fprintf(stderr, "control: waiting for a client on %s\n", socket_path);
+
+    c.fd = accept(listen_fd, NULL, NULL);
+    close(listen_fd);
+    if (c.fd < 0) {
+        perror("control: accept");
+        unlink(socket_path);
+        return 1;
+    }
+
+    srand(seed);
+    serve(&c);
+
+    if (c.loaded) {
+        free_level_state(&c);
+        unload_level(&c.board);
+    }
+    close(c.fd);
+    unlink(socket_path);
+
+    for (int i = 0; i < c.n_levels; i++) free(c.levels[i]);
+    free(c.levels);
+    free(c.points);
+    free(c.out);
+    agent_cache_clear();
+    return 0;
+}
@@ -1,10 +1,33 @@
 #include "display.h"
 #include "board.h"
+#include <ncurses.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 
+// Texto do HUD por baixo dos pontos (comum aos backends)
+static char overlay_text[2048];
+static int overlay_lines = 0;
 
-int terminal_init() {
+void display_set_overlay(const char* text) {
+    snprintf(overlay_text, sizeof(overlay_text), "%s", text ? text : "");
+    overlay_lines = 0;
+    if (overlay_text[0] == '\0') return;
+    overlay_lines = 1;
+    for (const char* c = overlay_text; *c; c++) overlay_lines += (*c == '\n');
+}
+
+const char* display_overlay() {
+    return overlay_text;
+}
+
+int display_overlay_lines() {
+    return overlay_lines;
+}
+
+
+static int ncurses_init(void) {
     // Initialize ncurses mode
     initscr();
 
@@ -44,9 +67,55 @@ int terminal_init() {
 }
 
 
-void draw_board(board_t* board, int mode) {
-    // Clear the screen before redrawing
-    clear();
+// Camada estática (paredes e portais) do viewport atual, desenhada uma vez num
+// pad e copiada para o ecrã em cada frame; por cima só se desenham pontos e agentes
+static WINDOW* static_layer = NULL;
+static viewport_t view;
+static viewport_t layer_view;
+static const void* layer_cells = NULL; // Identifica o nível em cache (células densas ou chunks)
+static char layer_level[MAX_FILENAME];
+
+static void build_static_layer(board_t* board) {
+    int pad_rows = 0, pad_cols = 0;
+    if (static_layer) getmaxyx(static_layer, pad_rows, pad_cols);
+    if (!static_layer || pad_rows != view.height || pad_cols != view.width) {
+        if (static_layer) delwin(static_layer);
+        static_layer = newpad(view.height, view.width);
+        if (!static_layer) return;
+    }
+
+    werase(static_layer);
+    for (int y = 0; y < view.height; y++) {
+        for (int x = 0; x < view.width; x++) {
+            board_pos_t* cell = board_cell(board, x + view.x, y + view.y);
+            if (cell->content == 'W') {
+                wattron(static_layer, COLOR_PAIR(3));
+                mvwaddch(static_layer, y, x, '#');
+                wattroff(static_layer, COLOR_PAIR(3));
+            }
+            else if (cell->has_portal) {
+                wattron(static_layer, COLOR_PAIR(6));
+                mvwaddch(static_layer, y, x, '@');
+                wattroff(static_layer, COLOR_PAIR(6));
+            }
+        }
+    }
+
+    layer_view = view;
+    layer_cells = board->board ? (const void*)board->board : (const void*)board->chunks;
+    snprintf(layer_level, sizeof(layer_level), "%s", board->level_name);
+}
+
+static int static_layer_valid(board_t* board) {
+    const void* cells = board->board ? (const void*)board->board : (const void*)board->chunks;
+    return static_layer && layer_cells == cells &&
+           memcmp(&layer_view, &view, sizeof(view)) == 0 &&
+           strcmp(layer_level, board->level_name) == 0;
+}
+
+static void ncurses_draw_board(board_t* board, int mode) {
+    // erase() e não clear(): o clear() obrigava o refresh a reenviar o ecrã todo
+    erase();
 
     // Draw the border/title
     attron(COLOR_PAIR(5));
@@ -61,96 +130,121 @@ void draw_board(board_t* board, int mode) {
         break;
 
     case DRAW_MENU:
-        mvprintw(1, 0, "Level: %s | Use W/A/S/D to move | Q to quit | G to quicksave ", board->level_name);
+        mvprintw(1, 0, "Level: %s | Use W/A/S/D to move | Q to quit | G to quicksave | H for HUD ", board->level_name);
         break;
     }
-
+    attroff(COLOR_PAIR(5));
 
     // Starting row for the game board (leave space for UI)
-    int start_row = 3;
-
-    // Draw the board
-    for (int y = 0; y < board->height; y++) {
-        for (int x = 0; x < board->width; x++) {
-            int index = y * board->width + x;
-            char ch = board->board[index].content;
-            int ghost_charged = 0;
-
-            for (int g = 0; g < board->n_ghosts; g++) {
-                ghost_t* ghost = &board->ghosts[g];
-                if (ghost->pos_x == x && ghost->pos_y == y) {
-                    if (ghost->charged)
-                        ghost_charged = 1;
-                    break;
-                }
-            }
+    int start_row = VIEWPORT_TOP_ROWS;
 
-            // Move cursor to position
-            move(start_row + y, x);
+    viewport_follow(&view, board, LINES - VIEWPORT_TOP_ROWS - VIEWPORT_BOTTOM_ROWS - overlay_lines, COLS);
+    if (!static_layer_valid(board)) build_static_layer(board);
+    if (static_layer) {
+        copywin(static_layer, stdscr, 0, 0, start_row, 0,
+                start_row + view.height - 1, view.width - 1, FALSE);
+    }
+
+    // Camada dinâmica: só as células visíveis
+    for (int y = 0; y < view.height; y++) {
+        for (int x = 0; x < view.width; x++) {
+            const board_pos_t* cell = board_cell(board, x + view.x, y + view.y);
+            char ch = cell->content;
 
-            // Draw with appropriate color
             switch (ch) {
-                case 'W': // Wall
-                    attron(COLOR_PAIR(3));
-                    addch('#');
-                    attroff(COLOR_PAIR(3));
+                case 'W': // Wall (camada estática)
+                    if (!static_layer) {
+                        attron(COLOR_PAIR(3));
+                        mvaddch(start_row + y, x, '#');
+                        attroff(COLOR_PAIR(3));
+                    }
                     break;
 
                 case 'P': // Pacman
                     attron(COLOR_PAIR(1) | A_BOLD);
-                    addch('C');
+                    mvaddch(start_row + y, x, 'C');
                     attroff(COLOR_PAIR(1) | A_BOLD);
                     break;
 
-                case 'M': // Monster/Ghost
-                    attron((COLOR_PAIR(2) | A_BOLD) | ((ghost_charged) ? (A_DIM) : (0)));
-                    addch('M');
-                    attroff((COLOR_PAIR(2) | A_BOLD) | ((ghost_charged) ? (A_DIM) : (0)));
+                case 'M': // Monster/Ghost (os carregados são redesenhados abaixo)
+                    attron(COLOR_PAIR(2) | A_BOLD);
+                    mvaddch(start_row + y, x, 'M');
+                    attroff(COLOR_PAIR(2) | A_BOLD);
                     break;
 
                 case ' ': // Empty space
-                    if (board->board[index].has_portal) {
-                        attron(COLOR_PAIR(6));
-                        addch('@');
-                        attroff(COLOR_PAIR(6));
+                    if (cell->has_portal) {
+                        if (!static_layer) {
+                            attron(COLOR_PAIR(6));
+                            mvaddch(start_row + y, x, '@');
+                            attroff(COLOR_PAIR(6));
+                        }
                     }
-                    else if (board->board[index].has_dot) {
+                    else if (cell->has_dot) {
                         attron(COLOR_PAIR(4));
-                        addch('.');
+                        mvaddch(start_row + y, x, '.');
                         attroff(COLOR_PAIR(4));
                     }
-                    else
-                        addch(' ');
                     break;
 
                 default:
-                    addch(ch);
+                    mvaddch(start_row + y, x, ch);
                     break;
             }
         }
     }
 
-    // Draw score/status at the bottom
+    // Fantasmas carregados (A_DIM): percorrer os fantasmas em vez de procurar por célula
+    for (int g = 0; g < board->n_ghosts; g++) {
+        ghost_t* ghost = &board->ghosts[g];
+        int x = ghost->pos_x - view.x, y = ghost->pos_y - view.y;
+        if (!ghost->charged || x < 0 || y < 0 || x >= view.width || y >= view.height) continue;
+        if (board_cell(board, ghost->pos_x, ghost->pos_y)->content != 'M') continue;
+        attron(COLOR_PAIR(2) | A_BOLD | A_DIM);
+        mvaddch(start_row + y, x, 'M');
+        attroff(COLOR_PAIR(2) | A_BOLD | A_DIM);
+    }
+
+    // Draw score/status at the bottom (one score per pacman)
     attron(COLOR_PAIR(5));
-    mvprintw(start_row + board->height + 1, 0, "Points: %d",
-             board->pacmans[0].points); // Assuming first pacman for now
+    if (board->n_pacmans == 1) {
+        mvprintw(start_row + view.height + 1, 0, "Points: %d", board->pacmans[0].points);
+    } else {
+        move(start_row + view.height + 1, 0);
+        printw("Points:");
+        for (int p = 0; p < board->n_pacmans; p++) {
+            printw(" P%d %d%s |", p + 1, board->pacmans[p].points,
+                   board->pacmans[p].alive ? "" : " (dead)");
+        }
+    }
     attroff(COLOR_PAIR(5));
+
+    // HUD de desempenho, uma linha de cada vez (o mvprintw não volta à coluna 0 num '\n')
+    attron(COLOR_PAIR(7));
+    const char* line = overlay_text;
+    for (int l = 0; l < overlay_lines; l++) {
+        const char* end = strchr(line, '\n');
+        int len = end ? (int)(end - line) : (int)strlen(line);
+        mvprintw(start_row + view.height + 2 + l, 0, "%.*s", len, line);
+        line = end ? end + 1 : line + len;
+    }
+    attroff(COLOR_PAIR(7));
 }
 
-void draw(char c, int colour_i, int pos_x, int pos_y) {
+static void ncurses_draw(char c, int colour_i, int pos_x, int pos_y) {
     move(pos_y, pos_x);
     attron(COLOR_PAIR(colour_i) | A_BOLD);
     addch(c);
     attroff(COLOR_PAIR(colour_i) | A_BOLD);
 }
 
-void refresh_screen() {
+static void ncurses_refresh(void) {
     // Update the physical screen with the virtual screen
     refresh();
 }
 
 
-char get_input() {
+static char ncurses_get_input(void) {
     // Get a character from the keyboard
     int ch = getch();
 
@@ -168,6 +262,7 @@ char get_input() {
         case 'D':
         case 'Q':
         case 'G':
+        case 'H':
             return (char)ch;
         
         default:
@@ -175,7 +270,121 @@ char get_input() {
     }
 }
 
-void terminal_cleanup() {
+static void ncurses_cleanup(void) {
+    if (static_layer) delwin(static_layer);
+    static_layer = NULL;
+    layer_cells = NULL;
+
     // Restore terminal settings and clean up ncurses
     endwin();
 }
+
+static void ncurses_clear(void) {
+    layer_cells = NULL; // Reconstruir a camada estática no próximo frame
+    clear();
+    refresh();
+}
+
+// O filho do fork (quicksave) herda o ecrã, mas é preciso repor o modo de input
+static void ncurses_after_fork(void) {
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
+}
+
+const render_backend_t ncurses_backend = {
+    .name = "ncurses",
+    .init = ncurses_init,
+    .draw_board = ncurses_draw_board,
+    .draw = ncurses_draw,
+    .present = ncurses_refresh,
+    .clear_screen = ncurses_clear,
+    .get_input = ncurses_get_input,
+    .after_fork = ncurses_after_fork,
+    .cleanup = ncurses_cleanup,
+};
+
+// ==================================================================
+// Viewport (partilhado pelos backends)
+// ==================================================================
+
+static int clamp(int v, int lo, int hi) {
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+// Recentra um eixo só quando o alvo entra na margem (1/4 da vista) junto a um bordo
+static int follow_axis(int origin, int size, int board_size, int target) {
+    int margin = size / 4;
+    if (target >= 0 && (target < origin + margin || target >= origin + size - margin)) {
+        origin = target - size / 2;
+    }
+    return clamp(origin, 0, board_size - size);
+}
+
+int viewport_follow(viewport_t* vp, const board_t* board, int term_rows, int term_cols) {
+    viewport_t old = *vp;
+    vp->width = clamp(term_cols, 1, board->width);
+    vp->height = clamp(term_rows, 1, board->height);
+
+    int target_x = -1, target_y = -1;
+    if (board->n_pacmans > 0 && board->pacmans[0].alive) {
+        target_x = board->pacmans[0].pos_x;
+        target_y = board->pacmans[0].pos_y;
+    }
+    vp->x = follow_axis(vp->x, vp->width, board->width, target_x);
+    vp->y = follow_axis(vp->y, vp->height, board->height, target_y);
+    return memcmp(&old, vp, sizeof(old)) != 0;
+}
+
+// ==================================================================
+// Seleção do backend e funções públicas (despacham para o backend)
+// ==================================================================
+
+static const render_backend_t* backend = &ncurses_backend;
+
+static const render_backend_t* const backends[] = { &ncurses_backend, &ansi_backend, &null_backend };
+
+int display_select(const char* name) {
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (strcmp(backends[i]->name, name) == 0) {
+            backend = backends[i];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* display_backend_name() {
+    return backend->name;
+}
+
+int terminal_init() {
+    return backend->init();
+}
+
+void draw_board(board_t* board, int mode) {
+    backend->draw_board(board, mode);
+}
+
+void draw(char c, int colour_i, int pos_x, int pos_y) {
+    backend->draw(c, colour_i, pos_x, pos_y);
+}
+
+void refresh_screen() {
+    backend->present();
+}
+
+void display_clear() {
+    backend->clear_screen();
+}
+
+char get_input() {
+    return backend->get_input();
+}
+
+void display_after_fork() {
+    if (backend->after_fork) backend->after_fork();
+}
+
+void terminal_cleanup() {
+    backend->cleanup();
+}
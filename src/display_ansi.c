@@ -0,0 +1,325 @@
+#include "display.h"
+#include "board.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+// Backend ANSI: cada frame é montado num só buffer com sequências de escape
+// e enviado com um único write() no refresh_screen. Não há ecrã virtual nem
+// diff como no ncurses: o custo por frame é montar o buffer e uma syscall.
+// O backend null (no fim) não desenha nada e partilha a leitura de teclas.
+
+typedef enum {
+    ATTR_RESET = 0,
+    ATTR_WALL,
+    ATTR_PACMAN,
+    ATTR_GHOST,
+    ATTR_GHOST_CHARGED,
+    ATTR_DOT,
+    ATTR_PORTAL,
+    ATTR_UI,
+} ansi_attr_t;
+
+// Mesmas cores que os color pairs do ncurses (display.c)
+static const char* const attr_sgr[] = {
+    [ATTR_RESET] = "\x1b[0m",
+    [ATTR_WALL] = "\x1b[0;34m",
+    [ATTR_PACMAN] = "\x1b[0;1;33m",
+    [ATTR_GHOST] = "\x1b[0;1;31m",
+    [ATTR_GHOST_CHARGED] = "\x1b[0;1;2;31m",
+    [ATTR_DOT] = "\x1b[0;37m",
+    [ATTR_PORTAL] = "\x1b[0;35m",
+    [ATTR_UI] = "\x1b[0;32m",
+};
+
+// Cores 1..7 do draw() (ver display.h)
+static const char* const colour_sgr[] = {
+    "\x1b[0m", "\x1b[0;1;33m", "\x1b[0;1;31m", "\x1b[0;1;34m",
+    "\x1b[0;1;37m", "\x1b[0;1;32m", "\x1b[0;1;35m", "\x1b[0;1;36m",
+};
+
+static int out_fd = STDOUT_FILENO;
+static int fixed_rows, fixed_cols; // Tamanho sem terminal (0 = tabuleiro todo)
+static char* frame;
+static size_t frame_len, frame_cap;
+static ansi_attr_t frame_attr;
+static unsigned char* charged_map; // Células com fantasma carregado (só durante o draw)
+static size_t charged_cap;
+static viewport_t view;
+
+static struct termios saved_termios;
+static int termios_saved = 0;
+
+void display_set_output(int fd) {
+    out_fd = fd;
+}
+
+void display_set_size(int rows, int cols) {
+    fixed_rows = rows;
+    fixed_cols = cols;
+}
+
+static void frame_reserve(size_t extra) {
+    if (frame_len + extra <= frame_cap) return;
+    size_t cap = frame_cap ? frame_cap : 4096;
+    while (cap < frame_len + extra) cap *= 2;
+    frame = realloc(frame, cap);
+    frame_cap = cap;
+}
+
+static void frame_append(const char* s, size_t n) {
+    frame_reserve(n);
+    memcpy(frame + frame_len, s, n);
+    frame_len += n;
+}
+
+static void frame_puts(const char* s) {
+    frame_append(s, strlen(s));
+}
+
+__attribute__((format(printf, 1, 2)))
+static void frame_printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (n <= 0) return;
+
+    frame_reserve((size_t)n + 1);
+    va_start(args, format);
+    vsnprintf(frame + frame_len, (size_t)n + 1, format, args);
+    va_end(args);
+    frame_len += n;
+}
+
+// Só emite SGR quando o atributo muda (linhas de paredes/pontos saem quase sem escapes)
+static inline void frame_attr_set(ansi_attr_t attr) {
+    if (attr == frame_attr) return;
+    frame_puts(attr_sgr[attr]);
+    frame_attr = attr;
+}
+
+static void frame_end_line(void) {
+    frame_attr_set(ATTR_RESET);
+    frame_append("\x1b[K\r\n", 5); // Apagar o resto da linha do frame anterior
+}
+
+static void write_all(const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(out_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += n;
+        len -= n;
+    }
+}
+
+static int ansi_init(void) {
+    if (tcgetattr(STDIN_FILENO, &saved_termios) == 0) {
+        struct termios raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        termios_saved = 1;
+    }
+    // Ecrã alternativo, cursor escondido, ecrã limpo
+    const char* enter = "\x1b[?1049h\x1b[?25l\x1b[2J\x1b[H";
+    write_all(enter, strlen(enter));
+    return 0;
+}
+
+static void ansi_draw_board(board_t* board, int mode) {
+    frame_len = 0;
+    frame_attr = ATTR_RESET;
+    frame_puts("\x1b[0m\x1b[H");
+
+    frame_attr_set(ATTR_UI);
+    frame_puts("=== PACMAN GAME ===");
+    frame_end_line();
+    frame_attr_set(ATTR_UI);
+    switch (mode) {
+        case DRAW_GAME_OVER: frame_puts(" GAME OVER "); break;
+        case DRAW_WIN: frame_puts(" VICTORY "); break;
+        case DRAW_MENU:
+            frame_printf("Level: %s | Use W/A/S/D to move | Q to quit | G to quicksave | H for HUD ", board->level_name);
+            break;
+    }
+    frame_end_line();
+    frame_end_line();
+
+    // Só as células dentro do terminal (sem terminal, p.e. /dev/null: o tamanho
+    // de display_set_size ou, sem ele, o tabuleiro todo)
+    struct winsize ws;
+    int rows = board->height, cols = board->width;
+    if (ioctl(out_fd, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row - VIEWPORT_TOP_ROWS - VIEWPORT_BOTTOM_ROWS - display_overlay_lines();
+        cols = ws.ws_col;
+    } else if (fixed_rows > 0 && fixed_cols > 0) {
+        rows = fixed_rows - VIEWPORT_TOP_ROWS - VIEWPORT_BOTTOM_ROWS - display_overlay_lines();
+        cols = fixed_cols;
+    }
+    viewport_follow(&view, board, rows, cols);
+
+    // Fantasmas carregados: marcados uma vez por frame em vez de procurar por célula
+    size_t n_cells = (size_t)view.width * view.height;
+    if (charged_cap < n_cells) {
+        free(charged_map);
+        charged_map = calloc(n_cells, 1);
+        charged_cap = charged_map ? n_cells : 0;
+    }
+    for (int g = 0; charged_map && g < board->n_ghosts; g++) {
+        ghost_t* ghost = &board->ghosts[g];
+        int x = ghost->pos_x - view.x, y = ghost->pos_y - view.y;
+        if (ghost->charged && x >= 0 && y >= 0 && x < view.width && y < view.height) {
+            charged_map[y * view.width + x] = 1;
+        }
+    }
+
+    // Cada linha do tabuleiro ocupa no máximo width chars + escapes de cor
+    frame_reserve(n_cells * 2 + (size_t)view.height * 16);
+    for (int y = 0; y < view.height; y++) {
+        for (int x = 0; x < view.width; x++) {
+            int index = y * view.width + x;
+            const board_pos_t* cell = board_cell(board, x + view.x, y + view.y);
+            char ch;
+            switch (cell->content) {
+                case 'W': frame_attr_set(ATTR_WALL); ch = '#'; break;
+                case 'P': frame_attr_set(ATTR_PACMAN); ch = 'C'; break;
+                case 'M':
+                    frame_attr_set((charged_map && charged_map[index]) ? ATTR_GHOST_CHARGED : ATTR_GHOST);
+                    ch = 'M';
+                    break;
+                case ' ':
+                    if (cell->has_portal) { frame_attr_set(ATTR_PORTAL); ch = '@'; }
+                    else if (cell->has_dot) { frame_attr_set(ATTR_DOT); ch = '.'; }
+                    else { ch = ' '; } // Espaço: qualquer cor serve
+                    break;
+                default: frame_attr_set(ATTR_RESET); ch = cell->content; break;
+            }
+            frame_reserve(32);
+            frame[frame_len++] = ch;
+        }
+        frame_end_line();
+    }
+
+    if (charged_map) memset(charged_map, 0, n_cells);
+
+    frame_end_line();
+    frame_attr_set(ATTR_UI);
+    if (board->n_pacmans == 1) {
+        frame_printf("Points: %d", board->pacmans[0].points);
+    } else {
+        frame_puts("Points:");
+        for (int p = 0; p < board->n_pacmans; p++) {
+            frame_printf(" P%d %d%s |", p + 1, board->pacmans[p].points,
+                         board->pacmans[p].alive ? "" : " (dead)");
+        }
+    }
+    if (display_overlay_lines() > 0) {
+        // HUD de desempenho por baixo dos pontos
+        frame_end_line();
+        for (const char* c = display_overlay(); *c; c++) {
+            if (*c == '\n') frame_end_line();
+            else frame_append(c, 1);
+        }
+    }
+    frame_attr_set(ATTR_RESET);
+    frame_puts("\x1b[K\x1b[J"); // Apagar restos de um tabuleiro anterior maior
+}
+
+static void ansi_draw(char c, int colour_i, int pos_x, int pos_y) {
+    if (colour_i < 0 || colour_i > 7) colour_i = 0;
+    frame_printf("\x1b[%d;%dH%s%c\x1b[0m", pos_y + 1, pos_x + 1, colour_sgr[colour_i], c);
+    frame_attr = ATTR_RESET;
+}
+
+static void ansi_refresh(void) {
+    write_all(frame, frame_len);
+    frame_len = 0;
+}
+
+static void ansi_clear(void) {
+    frame_len = 0;
+    write_all("\x1b[2J\x1b[H", 7);
+}
+
+// Lê uma tecla sem bloquear (stdin em modo raw no backend ANSI)
+static char read_key(void) {
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0) return '\0';
+
+    unsigned char ch;
+    if (read(STDIN_FILENO, &ch, 1) != 1) return '\0';
+
+    ch = toupper(ch);
+    switch (ch) {
+        case 'W':
+        case 'S':
+        case 'A':
+        case 'D':
+        case 'Q':
+        case 'G':
+        case 'H':
+            return (char)ch;
+        default:
+            return '\0';
+    }
+}
+
+static void ansi_cleanup(void) {
+    const char* leave = "\x1b[0m\x1b[?25h\x1b[?1049l";
+    write_all(leave, strlen(leave));
+    if (termios_saved) tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    termios_saved = 0;
+
+    free(frame);
+    frame = NULL;
+    frame_len = frame_cap = 0;
+    free(charged_map);
+    charged_map = NULL;
+    charged_cap = 0;
+}
+
+const render_backend_t ansi_backend = {
+    .name = "ansi",
+    .init = ansi_init,
+    .draw_board = ansi_draw_board,
+    .draw = ansi_draw,
+    .present = ansi_refresh,
+    .clear_screen = ansi_clear,
+    .get_input = read_key,
+    .after_fork = NULL, // O modo raw do terminal é herdado pelo filho
+    .cleanup = ansi_cleanup,
+};
+
+// ==================================================================
+// Backend null: não desenha (benchmarks); as teclas continuam a funcionar
+// (sem modo raw: chegam depois do Enter)
+// ==================================================================
+
+static int null_init(void) { return 0; }
+static void null_draw_board(board_t* board, int mode) { (void)board; (void)mode; }
+static void null_draw(char c, int colour_i, int pos_x, int pos_y) { (void)c; (void)colour_i; (void)pos_x; (void)pos_y; }
+static void null_noop(void) {}
+
+const render_backend_t null_backend = {
+    .name = "null",
+    .init = null_init,
+    .draw_board = null_draw_board,
+    .draw = null_draw,
+    .present = null_noop,
+    .clear_screen = null_noop,
+    .get_input = read_key,
+    .after_fork = NULL,
+    .cleanup = null_noop,
+};
@@ -0,0 +1,175 @@
+#include "events.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+typedef struct {
+    atomic_ulong seq;   // == posição: livre para o produtor dessa posição; == posição+1: pronto
+    game_event_t event;
+} event_slot_t;
+
+struct event_queue {
+    atomic_ulong tail;    // Próxima posição a reservar (produtores, CAS)
+    char pad[64 - sizeof(atomic_ulong)]; // Cauda e cabeça em linhas de cache diferentes
+    atomic_ulong head;    // Próxima posição a ler (só o consumidor escreve)
+    atomic_ulong dropped;
+    unsigned long mask;
+    event_slot_t slots[];
+};
+
+struct event_bus {
+    event_queue_t* queue;
+    int n_subscribers;
+    event_handler_t handlers[EVENT_MAX_SUBSCRIBERS];
+    void* contexts[EVENT_MAX_SUBSCRIBERS];
+};
+
+static const char* const event_names[N_EVENT_TYPES] = { "dot", "killed", "portal", "charged", "move" };
+
+size_t event_queue_bytes(int capacity) {
+    return sizeof(event_queue_t) + sizeof(event_slot_t) * (size_t)capacity;
+}
+
+event_queue_t* event_queue_init(void* mem, int capacity) {
+    event_queue_t* queue = mem;
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->dropped, 0);
+    queue->mask = (unsigned long)capacity - 1;
+    for (int i = 0; i < capacity; i++) atomic_init(&queue->slots[i].seq, (unsigned long)i);
+    return queue;
+}
+
+int event_queue_capacity(const event_queue_t* queue) {
+    return (int)(queue->mask + 1);
+}
+
+int event_queue_push(event_queue_t* queue, const game_event_t* event) {
+    unsigned long pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    event_slot_t* slot;
+    for (;;) {
+        slot = &queue->slots[pos & queue->mask];
+        unsigned long seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        long diff = (long)(seq - pos);
+        if (diff == 0) {
+            // Slot livre para esta posição: reservá-la (se falhar, pos passa a ser a cauda atual)
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        }
+        else if (diff < 0) {
+            // O consumidor ainda não libertou o slot de há uma volta: fila cheia
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return -1;
+        }
+        else {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+    slot->event = *event;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+int event_queue_pop(event_queue_t* queue, game_event_t* event) {
+    unsigned long pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    event_slot_t* slot = &queue->slots[pos & queue->mask];
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) return 0;
+
+    *event = slot->event;
+    // Libertar o slot para a posição da volta seguinte
+    atomic_store_explicit(&slot->seq, pos + queue->mask + 1, memory_order_release);
+    atomic_store_explicit(&queue->head, pos + 1, memory_order_relaxed);
+    return 1;
+}
+
+unsigned long event_queue_dropped(const event_queue_t* queue) {
+    return atomic_load_explicit(&((event_queue_t*)queue)->dropped, memory_order_relaxed);
+}
+
+event_bus_t* event_bus_create(int capacity) {
+    int rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+
+    event_bus_t* bus = calloc(1, sizeof(event_bus_t));
+    void* mem = malloc(event_queue_bytes(rounded));
+    if (!bus || !mem) {
+        free(bus);
+        free(mem);
+        return NULL;
+    }
+    bus->queue = event_queue_init(mem, rounded);
+    return bus;
+}
+
+void event_bus_destroy(event_bus_t* bus) {
+    if (!bus) return;
+    free(bus->queue);
+    free(bus);
+}
+
+event_queue_t* event_bus_queue(event_bus_t* bus) {
+    return bus->queue;
+}
+
+int event_bus_subscribe(event_bus_t* bus, event_handler_t handler, void* ctx) {
+    if (bus->n_subscribers >= EVENT_MAX_SUBSCRIBERS) return -1;
+    bus->handlers[bus->n_subscribers] = handler;
+    bus->contexts[bus->n_subscribers] = ctx;
+    bus->n_subscribers++;
+    return 0;
+}
+
+int event_bus_dispatch(event_bus_t* bus, event_queue_t* queue) {
+    game_event_t event;
+    int n = 0;
+    while (event_queue_pop(queue, &event)) {
+        for (int s = 0; s < bus->n_subscribers; s++) bus->handlers[s](&event, bus->contexts[s]);
+        n++;
+    }
+    return n;
+}
+
+const char* event_type_name(int type) {
+    return (type >= 0 && type < N_EVENT_TYPES) ? event_names[type] : "?";
+}
+
+void event_log_handler(const game_event_t* event, void* ctx) {
+    (void)ctx;
+    if (event->type == EVENT_MOVE) return; // Uma por jogada: só no trace
+    debug("[EVENT] %s %s %d at (%d, %d)\n", event_type_name(event->type),
+          event->ghost ? "ghost" : "pacman", event->agent, event->x, event->y);
+}
+
+void event_stats_handler(const game_event_t* event, void* ctx) {
+    event_stats_t* stats = ctx;
+    if (event->type >= 0 && event->type < N_EVENT_TYPES) stats->count[event->type]++;
+}
+
+int event_trace_open(event_trace_t* trace, const char* path) {
+    memset(trace, 0, sizeof(*trace));
+    trace->file = fopen(path, "w");
+    if (!trace->file) return -1;
+    fprintf(trace->file, "level,t_ms,event,agent,index,x,y\n");
+    trace->level_start = now_ns();
+    return 0;
+}
+
+void event_trace_level(event_trace_t* trace, const char* level_name) {
+    snprintf(trace->level, sizeof(trace->level), "%s", level_name);
+    trace->level_start = now_ns();
+}
+
+void event_trace_close(event_trace_t* trace) {
+    if (!trace->file) return;
+    fclose(trace->file);
+    trace->file = NULL;
+}
+
+void event_trace_handler(const game_event_t* event, void* ctx) {
+    event_trace_t* trace = ctx;
+    if (!trace->file) return;
+    // Um evento de antes do início do nível conta como t = 0
+    double t_ms = (event->time_ns > trace->level_start) ? (event->time_ns - trace->level_start) / 1e6 : 0.0;
+    fprintf(trace->file, "%s,%.3f,%s,%s,%d,%d,%d\n", trace->level, t_ms, event_type_name(event->type),
+            event->ghost ? "ghost" : "pacman", event->agent, event->x, event->y);
+}
@@ -1,10 +1,17 @@
 #include "files.h"
+#include "rowlock.h"
+#include "chase.h"
+#include "pool.h"
+#include "sim.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/stat.h>
 
 // Função auxiliar para filtro do scandir (movida do game.c)
@@ -54,14 +61,13 @@ static char* next_line(char* current) {
     return eol + 1;
 }
 
-// Parser de Agentes (movido do board.c)
-static int parse_agent_file(const char* filepath, int* start_x, int* start_y, int* passo, command_t* moves, int* n_moves) {
-    char* buffer = read_file_to_buffer(filepath);
-    if (!buffer) return -1;
-
+// Parser de Agentes (movido do board.c): PASSO/POS + script compilado para bytecode.
+// 'name' só serve para as mensagens do debug.log
+static void parse_agent_buffer(const char* name, char* buffer, int* start_x, int* start_y, int* passo,
+                               script_t** script) {
     char* line = buffer;
-    *n_moves = 0;
     *passo = 0; 
+    script_builder_t* builder = script_builder_new();
 
     while (line && *line) {
         if (*line == '#' || *line == '\n' || *line == '\r') {
@@ -77,42 +83,361 @@ static int parse_agent_file(const char* filepath, int* start_x, int* start_y, in
             else if (strcmp(key, "POS") == 0) {
                 sscanf(line, "POS %d %d", start_y, start_x);
             }
-            else {
-                char cmd_char;
-                int turns = 1;
-                char* ptr = line;
-                while (*ptr && isspace(*ptr)) ptr++; 
-                cmd_char = *ptr;
-                ptr++;
-                if (*ptr && isdigit(*ptr)) {
-                    turns = atoi(ptr);
-                }
-
-                if (*n_moves < MAX_MOVES) {
-                    moves[*n_moves].command = cmd_char;
-                    moves[*n_moves].turns = turns;
-                    moves[*n_moves].turns_left = turns;
-                    (*n_moves)++;
-                }
+            else if (script_builder_add_line(builder, line) != 0) {
+                debug("%s: linha ignorada: %.*s\n", name, (int)strcspn(line, "\n"), line);
             }
         }
         line = next_line(line);
     }
-    free(buffer);
-    return 0;
+    *script = script_builder_finish(builder);
 }
 
-// A função Principal de carregamento (movida do board.c)
-int load_level(board_t* board, const char* dir_path, const char* level_file, int accumulated_points) {
-    char filepath[512];
-    snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, level_file);
-    
+int parse_agent_file(const char* filepath, int* start_x, int* start_y, int* passo, script_t** script) {
     char* buffer = read_file_to_buffer(filepath);
     if (!buffer) return -1;
+    parse_agent_buffer(filepath, buffer, start_x, start_y, passo, script);
+    free(buffer);
+    return 0;
+}
+
+// ==================================================================
+// CACHE DE FICHEIROS DE AGENTES
+// ==================================================================
+// Cada .p/.m é lido e compilado uma vez por processo. A chave é o caminho e a
+// identidade do ficheiro (inode, tamanho, mtime), por isso um ficheiro editado
+// entre níveis volta a ser lido. O script compilado é só de leitura e fica
+// partilhado (refcount) entre a cache e todos os agentes que o usam, em
+// qualquer nível e em qualquer sessão do modo servidor.
+
+#define AGENT_CACHE_MIN_BUCKETS 256
+#define LOAD_MAX_WORKERS 4 // Threads do pool que lê os ficheiros novos de um nível
+#define POS_UNSET INT_MIN  // O ficheiro não tem POS (o agente fica com a posição por omissão)
+
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+} file_id_t;
+
+typedef struct agent_entry {
+    struct agent_entry* next;
+    uint64_t hash;
+    char* path;
+    file_id_t id;
+    int pos_x, pos_y, passo;
+    script_t* script; // Uma referência é da cache
+} agent_entry_t;
+
+static struct {
+    pthread_mutex_t lock;
+    agent_entry_t** buckets;
+    size_t n_buckets, n_entries;
+} agent_cache = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Um ficheiro distinto de um nível (vários agentes podem apontar para o mesmo)
+typedef struct {
+    char path[512];
+    uint64_t hash;
+    file_id_t id;
+    int has_id;
+    int ok;
+    int pos_x, pos_y, passo;
+    script_t* script; // Referência própria, largada no fim do load_level
+    const char* text; // load_level_memory: conteúdo do ficheiro (NULL = ler do disco)
+} agent_load_t;
+
+static uint64_t hash_path(const char* s) {
+    uint64_t h = 1469598103934665603ull; // FNV-1a
+    for (; *s; s++) {
+        h ^= (unsigned char)*s;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static int file_id_equal(const file_id_t* a, const file_id_t* b) {
+    return a->dev == b->dev && a->ino == b->ino && a->size == b->size &&
+           a->mtime.tv_sec == b->mtime.tv_sec && a->mtime.tv_nsec == b->mtime.tv_nsec;
+}
+
+// Chamar com agent_cache.lock
+static agent_entry_t* cache_find(const char* path, uint64_t hash) {
+    if (!agent_cache.buckets) return NULL;
+    for (agent_entry_t* e = agent_cache.buckets[hash & (agent_cache.n_buckets - 1)]; e; e = e->next) {
+        if (e->hash == hash && strcmp(e->path, path) == 0) return e;
+    }
+    return NULL;
+}
+
+// Chamar com agent_cache.lock
+static void cache_grow(void) {
+    size_t n = agent_cache.n_buckets ? agent_cache.n_buckets * 2 : AGENT_CACHE_MIN_BUCKETS;
+    agent_entry_t** buckets = calloc(n, sizeof(agent_entry_t*));
+    if (!buckets) return;
+    for (size_t b = 0; b < agent_cache.n_buckets; b++) {
+        agent_entry_t* e = agent_cache.buckets[b];
+        while (e) {
+            agent_entry_t* next = e->next;
+            e->next = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+            e = next;
+        }
+    }
+    free(agent_cache.buckets);
+    agent_cache.buckets = buckets;
+    agent_cache.n_buckets = n;
+}
+
+static void load_take(agent_load_t* load, const agent_entry_t* e) {
+    load->ok = 1;
+    load->pos_x = e->pos_x;
+    load->pos_y = e->pos_y;
+    load->passo = e->passo;
+    load->script = script_retain(e->script);
+}
+
+// Procura o ficheiro na cache; devolve 1 se o encontrou com a mesma identidade
+static int cache_lookup(agent_load_t* load) {
+    struct stat st;
+    load->has_id = (stat(load->path, &st) == 0);
+    if (!load->has_id) return 0;
+    load->id = (file_id_t){ st.st_dev, st.st_ino, st.st_size, st.st_mtim };
+
+    pthread_mutex_lock(&agent_cache.lock);
+    agent_entry_t* e = cache_find(load->path, load->hash);
+    int hit = e && file_id_equal(&e->id, &load->id);
+    if (hit) load_take(load, e);
+    pthread_mutex_unlock(&agent_cache.lock);
+    return hit;
+}
+
+// Guarda um ficheiro acabado de ler. Se outra thread guardou o mesmo ficheiro
+// entretanto, fica o dela e o nosso script é largado.
+static void cache_insert(agent_load_t* load) {
+    if (!load->has_id) return;
+
+    pthread_mutex_lock(&agent_cache.lock);
+    agent_entry_t* e = cache_find(load->path, load->hash);
+    if (e && file_id_equal(&e->id, &load->id)) {
+        script_free(load->script);
+        load_take(load, e);
+    }
+    else {
+        if (!e) {
+            if (agent_cache.n_entries >= agent_cache.n_buckets * 2) cache_grow();
+            e = calloc(1, sizeof(agent_entry_t));
+            e->path = strdup(load->path);
+            e->hash = load->hash;
+            size_t b = e->hash & (agent_cache.n_buckets - 1);
+            e->next = agent_cache.buckets[b];
+            agent_cache.buckets[b] = e;
+            agent_cache.n_entries++;
+        }
+        script_free(e->script); // Versão antiga do ficheiro (os agentes que a usam têm a sua referência)
+        e->id = load->id;
+        e->pos_x = load->pos_x;
+        e->pos_y = load->pos_y;
+        e->passo = load->passo;
+        e->script = script_retain(load->script);
+    }
+    pthread_mutex_unlock(&agent_cache.lock);
+}
+
+void agent_cache_clear(void) {
+    pthread_mutex_lock(&agent_cache.lock);
+    for (size_t b = 0; b < agent_cache.n_buckets; b++) {
+        agent_entry_t* e = agent_cache.buckets[b];
+        while (e) {
+            agent_entry_t* next = e->next;
+            script_free(e->script);
+            free(e->path);
+            free(e);
+            e = next;
+        }
+    }
+    free(agent_cache.buckets);
+    agent_cache.buckets = NULL;
+    agent_cache.n_buckets = agent_cache.n_entries = 0;
+    pthread_mutex_unlock(&agent_cache.lock);
+}
+
+static void parse_task(void* arg) {
+    agent_load_t* load = arg;
+    load->pos_x = load->pos_y = POS_UNSET;
+    if (load->text) {
+        char* buffer = strdup(load->text); // O parser percorre um buffer seu
+        parse_agent_buffer(load->path, buffer, &load->pos_x, &load->pos_y, &load->passo, &load->script);
+        free(buffer);
+        load->ok = 1;
+    }
+    else {
+        load->ok = (parse_agent_file(load->path, &load->pos_x, &load->pos_y, &load->passo, &load->script) == 0);
+    }
+}
+
+static const char* find_agent_text(const agent_text_t* agents, int n_agents, const char* name) {
+    for (int i = 0; i < n_agents; i++) {
+        if (strcmp(agents[i].name, name) == 0) return agents[i].text;
+    }
+    return NULL;
+}
+
+// Resolve os ficheiros de agentes de um nível: cada nome distinto é procurado
+// na cache e os que faltam são lidos em paralelo num pool pequeno.
+// names[i] é o ficheiro do agente i; slot_of[i] fica com o índice em *loads.
+// Com dir_path == NULL os ficheiros vêm de agents[] (load_level_memory) e não
+// passam pela cache; um nome que não esteja lá conta como ficheiro em falta.
+static int load_agent_files(const char* dir_path, const agent_text_t* agents, int n_texts,
+                            char (**names)[MAX_FILENAME], const int* n_names, int n_lists,
+                            int* slot_of, agent_load_t** loads) {
+    int n_agents = 0;
+    for (int l = 0; l < n_lists; l++) n_agents += n_names[l];
+
+    // Nomes distintos (tabela de dispersão local: índices em *loads, -1 = livre)
+    int table_size = 16;
+    while (table_size < n_agents * 2) table_size *= 2;
+    int* table = malloc(sizeof(int) * table_size);
+    for (int i = 0; i < table_size; i++) table[i] = -1;
+    *loads = calloc(n_agents > 0 ? n_agents : 1, sizeof(agent_load_t));
+
+    int n_loads = 0, agent = 0;
+    for (int l = 0; l < n_lists; l++) {
+        for (int i = 0; i < n_names[l]; i++, agent++) {
+            char path[sizeof((*loads)->path)];
+            if (dir_path) snprintf(path, sizeof(path), "%s/%s", dir_path, names[l][i]);
+            else snprintf(path, sizeof(path), "%s", names[l][i]);
+            uint64_t hash = hash_path(path);
+            int t = hash & (table_size - 1);
+            while (table[t] >= 0 && strcmp((*loads)[table[t]].path, path) != 0) t = (t + 1) & (table_size - 1);
+            if (table[t] < 0) {
+                agent_load_t* load = &(*loads)[n_loads];
+                memcpy(load->path, path, sizeof(path));
+                load->hash = hash;
+                if (!dir_path) load->text = find_agent_text(agents, n_texts, names[l][i]);
+                table[t] = n_loads++;
+            }
+            slot_of[agent] = table[t];
+        }
+    }
+    free(table);
 
+    // Ficheiros que não estão na cache (ou mudaram desde que foram lidos)
+    agent_load_t** misses = malloc(sizeof(agent_load_t*) * (n_loads > 0 ? n_loads : 1));
+    int n_misses = 0;
+    for (int i = 0; i < n_loads; i++) {
+        agent_load_t* load = &(*loads)[i];
+        if (!dir_path) {
+            if (load->text) misses[n_misses++] = load;
+        }
+        else if (!cache_lookup(load)) misses[n_misses++] = load;
+    }
+
+    if (n_misses > 1) {
+        pool_t* pool = pool_create(n_misses < LOAD_MAX_WORKERS ? n_misses : LOAD_MAX_WORKERS);
+        for (int i = 0; i < n_misses; i++) pool_submit(pool, parse_task, misses[i]);
+        pool_wait(pool);
+        pool_destroy(pool);
+    }
+    else if (n_misses == 1) {
+        parse_task(misses[0]);
+    }
+
+    for (int i = 0; dir_path && i < n_misses; i++) {
+        if (misses[i]->ok) cache_insert(misses[i]);
+    }
+    free(misses);
+
+    debug("load_level: %d agentes, %d ficheiros distintos, %d lidos do disco\n", n_agents, n_loads, n_misses);
+    return n_loads;
+}
+
+static void apply_agent_file(const agent_load_t* load, int* pos_x, int* pos_y, int* passo, script_t** script) {
+    if (!load->ok) return; // Como o parse_agent_file: ficheiro em falta não muda nada
+    if (load->pos_x != POS_UNSET) *pos_x = load->pos_x;
+    if (load->pos_y != POS_UNSET) *pos_y = load->pos_y;
+    *passo = load->passo;
+    *script = script_retain(load->script);
+}
+
+// Acrescenta a 'files' os nomes de ficheiro de uma linha "PAC a b c" / "MON a b c"
+// (só até ao fim desta linha; o array cresce conforme necessário)
+static void parse_file_list(char* line, char (**files)[MAX_FILENAME], int* n, int* cap) {
+    char* p = line;
+    while (*p && isspace(*p)) p++; // Skip indent
+    while (*p && !isspace(*p)) p++; // Skip PAC/MON word
+
+    while (*p && *p != '\n') {
+        while (*p && *p != '\n' && isspace(*p)) p++;
+        if (!*p || *p == '\n') break;
+
+        char file[MAX_FILENAME];
+        int len = 0;
+        while (*p && !isspace(*p) && len < MAX_FILENAME - 1) {
+            file[len++] = *p++;
+        }
+        file[len] = '\0';
+
+        if (*n == *cap) {
+            *cap = *cap ? *cap * 2 : 16;
+            *files = realloc(*files, sizeof(**files) * *cap);
+        }
+        strcpy((*files)[*n], file);
+        (*n)++;
+    }
+}
+
+static int cell_free(const board_t* board, int x, int y) {
+    if (x < 0 || x >= board->width || y < 0 || y >= board->height) return 0;
+    char c = board_cell(board, x, y)->content;
+    return c != 'W' && c != 'M' && c != 'P';
+}
+
+// Coloca um agente em (x,y); se a célula estiver ocupada procura a livre mais
+// próxima, em anéis à volta de (x,y). Agentes com o mesmo POS (scripts
+// partilhados) ficam juntos à volta dele e cada um custa só os anéis já cheios,
+// em vez de uma volta ao mapa inteiro
+static void place_agent(board_t* board, int* pos_x, int* pos_y) {
+    int x0 = *pos_x, y0 = *pos_y;
+    if (cell_free(board, x0, y0)) return;
+
+    int max_r = (board->width > board->height) ? board->width : board->height;
+    for (int r = 1; r < max_r; r++) {
+        // Linhas de cima e de baixo do anel, depois as colunas dos lados
+        for (int x = x0 - r; x <= x0 + r; x++) {
+            if (cell_free(board, x, y0 - r)) { *pos_x = x; *pos_y = y0 - r; return; }
+            if (cell_free(board, x, y0 + r)) { *pos_x = x; *pos_y = y0 + r; return; }
+        }
+        for (int y = y0 - r + 1; y <= y0 + r - 1; y++) {
+            if (cell_free(board, x0 - r, y)) { *pos_x = x0 - r; *pos_y = y; return; }
+            if (cell_free(board, x0 + r, y)) { *pos_x = x0 + r; *pos_y = y; return; }
+        }
+    }
+}
+
+// Mapas a partir deste tamanho usam chunks (PACMANIST_BOARD=dense|chunked força um dos dois)
+#define CHUNKED_MIN_CELLS (1L << 22)
+
+static int use_chunks(const board_t* board) {
+    const char* storage = getenv("PACMANIST_BOARD");
+    if (storage && strcmp(storage, "chunked") == 0) return 1;
+    if (storage && strcmp(storage, "dense") == 0) return 0;
+    return (long)board->width * board->height >= CHUNKED_MIN_CELLS;
+}
+
+// A função Principal de carregamento (movida do board.c): 'buffer' é o .lvl
+// e os ficheiros dos agentes vêm de dir_path ou, se for NULL, de agents[]
+static int load_level_buffer(board_t* board, char* buffer, const char* dir_path, const char* level_file,
+                             const agent_text_t* agents, int n_agents,
+                             const int* accumulated_points, int n_accumulated) {
+    board->board = NULL;
+    board->chunks = NULL;
     board->n_pacmans = 0;
     board->n_ghosts = 0;
-    board->pacman_file[0] = '\0';
+    board->ghosts_files = NULL;
+    board->pacman_files = NULL;
+    int ghosts_files_cap = 0;
+    int pacman_files_cap = 0;
     snprintf(board->level_name, sizeof(board->level_name), "%s", level_file);
 
     char* line = buffer;
@@ -127,178 +452,179 @@ int load_level(board_t* board, const char* dir_path, const char* level_file, int
         if (!reading_map && sscanf(line, "%15s", key) == 1) {
             if (strcmp(key, "DIM") == 0) {
                 sscanf(line, "DIM %d %d", &board->height, &board->width);
-                board->board = calloc(board->width * board->height, sizeof(board_pos_t));
+                if (board_storage_init(board, use_chunks(board)) != 0) return -1;
             }
             else if (strcmp(key, "TEMPO") == 0) {
                 sscanf(line, "TEMPO %d", &board->tempo);
             }
             else if (strcmp(key, "PAC") == 0) {
-                sscanf(line, "PAC %s", board->pacman_file);
-                board->n_pacmans = 1;
+                // Vários pacmans: "PAC a.p b.p" e/ou várias linhas PAC
+                parse_file_list(line, &board->pacman_files, &board->n_pacmans, &pacman_files_cap);
             }
             else if (strcmp(key, "MON") == 0) {
-                char* p = line;
-                while (*p && isspace(*p)) p++; // Skip indent
-                while (*p && !isspace(*p)) p++; // Skip MON word
-                
-                while (*p && board->n_ghosts < MAX_GHOSTS) {
-                    while (*p && isspace(*p)) p++;
-                    if (!*p) break;
-                    
-                    char mon_file[256];
-                    int len = 0;
-                    while (*p && !isspace(*p) && len < 255) {
-                        mon_file[len++] = *p++;
-                    }
-                    mon_file[len] = '\0';
-                    strcpy(board->ghosts_files[board->n_ghosts], mon_file);
-                    board->n_ghosts++;
-                }
+                // Array dinâmico (níveis gerados podem ter milhares de monstros)
+                parse_file_list(line, &board->ghosts_files, &board->n_ghosts, &ghosts_files_cap);
             }
             else if (strchr("Xo@", *line)) {
                 reading_map = 1;
             }
         }
         
-        if (reading_map) {
+        if (reading_map && map_row < board->height) {
              for (int i = 0; i < board->width && line[i] != '\0' && line[i] != '\n'; i++) {
-                 int idx = map_row * board->width + i;
                  char c = line[i];
-                 if (c == 'X') board->board[idx].content = 'W';
-                 else if (c == '@') {
-                     board->board[idx].content = ' ';
-                     board->board[idx].has_portal = 1;
-                 }
-                 else if (c == 'o' || c == '0') {
-                     board->board[idx].content = ' ';
-                     board->board[idx].has_dot = 1;
-                 }
-                 else {
-                     board->board[idx].content = ' ';
+                 if (c == 'X') {
+                     // Nos chunks uma parede não aloca nada (os tiles começam cheios de paredes)
+                     if (board->board) board_cell(board, i, map_row)->content = 'W';
+                     continue;
                  }
+                 board_pos_t* cell = board_cell_alloc(board, i, map_row);
+                 cell->content = ' ';
+                 if (c == '@') cell->has_portal = 1;
+                 else if (c == 'o' || c == '0') cell->has_dot = 1;
              }
              map_row++;
         }
         line = next_line(line);
     }
-    free(buffer);
 
-    board->pacmans = calloc(1, sizeof(pacman_t));
+    board->pacmans = calloc(board->n_pacmans > 0 ? board->n_pacmans : 1, sizeof(pacman_t));
     board->ghosts = calloc(board->n_ghosts, sizeof(ghost_t));
 
+    // Ficheiros de todos os agentes (fantasmas e depois pacmans), pela cache
+    char (*lists[2])[MAX_FILENAME] = { board->ghosts_files, board->pacman_files };
+    int list_sizes[2] = { board->n_ghosts, board->n_pacmans };
+    int* slot_of = malloc(sizeof(int) * (board->n_ghosts + board->n_pacmans + 1));
+    agent_load_t* loads;
+    int n_loads = load_agent_files(dir_path, agents, n_agents, lists, list_sizes, 2, slot_of, &loads);
+
     // 2. Carregar FANTASMAS (Com lógica de segurança)
     for (int i = 0; i < board->n_ghosts; i++) {
         board->ghosts[i].pos_x = -1;
         board->ghosts[i].pos_y = -1;
 
-        snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, board->ghosts_files[i]);
-        parse_agent_file(filepath, &board->ghosts[i].pos_x, &board->ghosts[i].pos_y, 
-                         &board->ghosts[i].passo, board->ghosts[i].moves, &board->ghosts[i].n_moves);
-        
         ghost_t* g = &board->ghosts[i];
+        apply_agent_file(&loads[slot_of[i]], &g->pos_x, &g->pos_y, &g->passo, &g->script);
+
         if (g->pos_x >= 0 && g->pos_x < board->width && 
             g->pos_y >= 0 && g->pos_y < board->height) {
-            
-            int idx = get_board_index(board, g->pos_x, g->pos_y);
-            char content = board->board[idx].content;
-
-            if (content == 'W' || content == 'M') {
-                int found = 0;
-                for (int y = 0; y < board->height; y++) {
-                    for (int x = 0; x < board->width; x++) {
-                        int try_idx = get_board_index(board, x, y);
-                        if (board->board[try_idx].content != 'W' && board->board[try_idx].content != 'M') {
-                            g->pos_x = x; g->pos_y = y; found = 1; break;
-                        }
-                    }
-                    if (found) break;
-                }
-            }
-            int final_idx = get_board_index(board, g->pos_x, g->pos_y);
-            if (board->board[final_idx].content != 'W') board->board[final_idx].content = 'M';
+            place_agent(board, &g->pos_x, &g->pos_y);
+            // Alocar mesmo numa parede: o fantasma escreve na sua célula quando sair
+            board_pos_t* cell = board_cell_alloc(board, g->pos_x, g->pos_y);
+            if (cell->content != 'W') cell->content = 'M';
         }
     }
 
-    // 3. Carregar PACMAN (Com lógica de segurança)
+    // 3. Carregar PACMANS (Com lógica de segurança)
     if (board->n_pacmans > 0) {
-        snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, board->pacman_file);
-        parse_agent_file(filepath, &board->pacmans[0].pos_x, &board->pacmans[0].pos_y, 
-                         &board->pacmans[0].passo, board->pacmans[0].moves, &board->pacmans[0].n_moves);
-        
-        pacman_t* p = &board->pacmans[0];
-        p->alive = 1;
-        p->points = accumulated_points;
-
-        int idx = get_board_index(board, p->pos_x, p->pos_y);
-        if (board->board[idx].content == 'W' || board->board[idx].content == 'M') {
-            int found = 0;
-            for (int y = 0; y < board->height; y++) {
-                for (int x = 0; x < board->width; x++) {
-                    int try_idx = get_board_index(board, x, y);
-                    char c = board->board[try_idx].content;
-                    if (c != 'W' && c != 'M') {
-                        p->pos_x = x; p->pos_y = y; found = 1; break;
-                    }
-                }
-                if (found) break;
+        for (int i = 0; i < board->n_pacmans; i++) {
+            pacman_t* p = &board->pacmans[i];
+            apply_agent_file(&loads[slot_of[board->n_ghosts + i]], &p->pos_x, &p->pos_y, &p->passo, &p->script);
+
+            p->alive = 1;
+            p->points = (accumulated_points && i < n_accumulated) ? accumulated_points[i] : 0;
+
+            if (p->pos_x < 0 || p->pos_x >= board->width || p->pos_y < 0 || p->pos_y >= board->height) {
+                p->pos_x = 1; p->pos_y = 1;
             }
+            place_agent(board, &p->pos_x, &p->pos_y);
+
+            board_pos_t* cell = board_cell_alloc(board, p->pos_x, p->pos_y);
+            cell->content = 'P';
+            cell->pacman = i + 1;
+            cell->has_dot = 0; 
         }
-        idx = get_board_index(board, p->pos_x, p->pos_y);
-        board->board[idx].content = 'P';
-        board->board[idx].has_dot = 0; 
     } 
     else {
         // Fallback Manual
         board->n_pacmans = 1;
         board->pacmans[0].alive = 1;
-        board->pacmans[0].points = accumulated_points;
+        board->pacmans[0].points = (accumulated_points && n_accumulated > 0) ? accumulated_points[0] : 0;
         int sx = 1, sy = 1;
-        if (board->board[get_board_index(board, sx, sy)].content == 'W') {
+        if (board_cell(board, sx, sy)->content == 'W') {
              // Procura simples se (1,1) for parede
-             for(int i=0; i<board->width*board->height; i++) 
-                if(board->board[i].content != 'W') { sx = i%board->width; sy = i/board->width; break; }
+             for(long i=0; i<(long)board->width*board->height; i++) 
+                if(board_cell_at(board, i)->content != 'W') { sx = i%board->width; sy = i/board->width; break; }
         }
         board->pacmans[0].pos_x = sx; board->pacmans[0].pos_y = sy;
-        board->board[get_board_index(board, sx, sy)].content = 'P';
+        board_pos_t* cell = board_cell_alloc(board, sx, sy);
+        cell->content = 'P';
+        cell->pacman = 1;
     }
 
-    // Inicializar o Mutex
-    board->row_locks = malloc(sizeof(pthread_mutex_t) * board->height);
-    for (int i = 0; i < board->height; i++) {
-        pthread_mutex_init(&board->row_locks[i], NULL);
-    }
-    pthread_mutex_init(&board->global_stats_lock, NULL);
+    for (int i = 0; i < n_loads; i++) script_free(loads[i].script);
+    free(loads);
+    free(slot_of);
+
+    // Inicializar os Mutexes (linhas + estatísticas)
+    row_locks_init(board);
     board->save_request = 0;    
     board->game_running = 1;      // Marcar jogo como ativo
     board->next_pacman_cmd = '\0'; // Limpar comando
     board->exit_status = 0;
+    atomic_store(&board->chase, NULL);
+    atomic_store(&board->pacman_version, 0);
+    atomic_store(&board->generation, 0);
+    atomic_store(&board->render_armed, 0);
+    board->wake_fd[0] = board->wake_fd[1] = -1;
+    board->rows_owned = 0;
+    board->sched = NULL;
+    board->rand_seed = NULL;
+    board->quiet = 0;
+    board->events = NULL;
 
     return 0;
 }
 
+int load_level(board_t* board, const char* dir_path, const char* level_file,
+               const int* accumulated_points, int n_accumulated) {
+    char filepath[512];
+    snprintf(filepath, sizeof(filepath), "%s/%s", dir_path, level_file);
+
+    char* buffer = read_file_to_buffer(filepath);
+    if (!buffer) return -1;
+    int result = load_level_buffer(board, buffer, dir_path, level_file, NULL, 0,
+                                   accumulated_points, n_accumulated);
+    free(buffer);
+    return result;
+}
+
+int load_level_memory(board_t* board, const char* level_name, const char* level_text,
+                      const agent_text_t* agents, int n_agents,
+                      const int* accumulated_points, int n_accumulated) {
+    char* buffer = strdup(level_text);
+    if (!buffer) return -1;
+    int result = load_level_buffer(board, buffer, NULL, level_name, agents, n_agents,
+                                   accumulated_points, n_accumulated);
+    free(buffer);
+    return result;
+}
+
 void unload_level(board_t * board) {
     if (!board) return;
 
-    // 1. Destruir e libertar mutexes das linhas
-    if (board->row_locks) {
-        for (int i = 0; i < board->height; i++) {
-            pthread_mutex_destroy(&board->row_locks[i]);
-        }
-        free(board->row_locks);
-        board->row_locks = NULL;
-    }
+    // 1. Relatório de contenção (só faz algo com -DLOCK_PROFILE)
+    lockprof_report(board, "lockprof.log");
 
-    // 2. Destruir mutex global
-    pthread_mutex_destroy(&board->global_stats_lock);
+    // 2. Destruir e libertar mutexes das linhas e o mutex global
+    chase_free(board);
+    sim_sched_free(board);
+    board_wake_close(board);
+    row_locks_destroy(board);
 
     // 3. Libertar o resto (como já tinhas)
-    if (board->board) free(board->board);
+    for (int i = 0; board->pacmans && i < board->n_pacmans; i++) script_free(board->pacmans[i].script);
+    for (int i = 0; board->ghosts && i < board->n_ghosts; i++) script_free(board->ghosts[i].script);
+    board_storage_free(board);
     if (board->pacmans) free(board->pacmans);
     if (board->ghosts) free(board->ghosts);
+    free(board->ghosts_files);
+    free(board->pacman_files);
     
-    board->board = NULL;
     board->pacmans = NULL;
     board->ghosts = NULL;
+    board->ghosts_files = NULL;
+    board->pacman_files = NULL;
     board->n_ghosts = 0;
     board->n_pacmans = 0;
 }
\ No newline at end of file
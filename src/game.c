@@ -1,10 +1,25 @@
 #include "board.h"
 #include "display.h"
 #include "files.h"
+#include "rowlock.h"
+#include "batch.h"
+#include "server.h"
+#include "control.h"
+#include "chase.h"
+#include "spectate.h"
+#include "histogram.h"
+#include "latency.h"
+#include "procs.h"
+#include "autopilot.h"
+#include "events.h"
+#include "hud.h"
+#include "metrics.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 
@@ -15,32 +30,68 @@
 // Variável Global para controlar Saves
 int has_active_save = 0;
 
+// Autopiloto do pacman 0 no nível atual (--autopilot); NULL = teclado e script
+static autopilot_t* autopilot = NULL;
+
+// Bus de eventos dos agentes: a UI é a única consumidora (ver events.h)
+static event_bus_t* event_bus = NULL;
+static event_stats_t level_events; // Contagens do nível atual, para o debug.log
+static event_trace_t event_trace;  // --trace
+static int event_redraw = 0;       // Houve eventos desde o último frame
+
+// Subscritor do desenho: um evento pede um frame novo
+static void render_event_handler(const game_event_t* event, void* ctx) {
+    (void)event;
+    *(int*)ctx = 1;
+}
+
 // Estrutura auxiliar para passar argumentos às threads dos fantasmas
 typedef struct {
     board_t* board;
     int id; // Índice do fantasma
 } thread_arg_t;
 
-void lock_all_rows(board_t* board) {
-    // Ordem crescente obrigatória
-    for (int i = 0; i < board->height; i++) {
-        pthread_mutex_lock(&board->row_locks[i]);
-    }
-}
+// Limite de frames por segundo da UI (só desenha quando o tabuleiro muda)
+#define MAX_FPS 30
+
+// HUD de desempenho (tecla H): recalculado a cada HUD_PERIOD_MS, até HUD_LINES linhas de HUD_WIDTH colunas
+#define HUD_PERIOD_MS 500
+#define HUD_LINES 6
+#define HUD_WIDTH 80
 
-void unlock_all_rows(board_t* board) {
-    for (int i = 0; i < board->height; i++) {
-        pthread_mutex_unlock(&board->row_locks[i]);
-    }
-}
 void screen_refresh(board_t * game_board, int mode) {
-    if (mode == DRAW_MENU) lock_all_rows(game_board);
+    if (mode == DRAW_MENU) lock_all_rows(game_board, LOCK_CALLER_RENDER);
     debug("REFRESH\n");
+    uint64_t start = now_ns();
     draw_board(game_board, mode);
+    spectate_publish(game_board, mode); // Ainda com as linhas trancadas: frame consistente
     refresh_screen();
+    latency_record(LAT_FRAME, now_ns() - start);
+    hud_record_frame();
     if (mode == DRAW_MENU) unlock_all_rows(game_board);
-    if(game_board->tempo != 0)
-        sleep_ms(game_board->tempo);       
+}
+
+// Bloqueia a UI até haver input ou uma geração nova do tabuleiro.
+// Se já houver um frame por desenhar (geração nova ou redraw_pending), só espera pelo limite de FPS (next_frame).
+static void wait_for_activity(board_t* board, unsigned long drawn_gen, int redraw_pending, uint64_t next_frame) {
+    struct pollfd fds[2] = {
+        { .fd = board->wake_fd[0], .events = POLLIN },
+        { .fd = STDIN_FILENO, .events = POLLIN },
+    };
+
+    if (redraw_pending || atomic_load(&board->generation) != drawn_gen) {
+        uint64_t now = now_ns();
+        if (now < next_frame) poll(fds + 1, 1, (int)((next_frame - now + 999999) / 1000000));
+        return;
+    }
+
+    // Armar antes de voltar a ler a geração: uma jogada entretanto acorda-nos pelo pipe
+    atomic_store(&board->render_armed, 1);
+    if (atomic_load(&board->generation) == drawn_gen) poll(fds, 2, 1000); // 1s por segurança
+    atomic_store(&board->render_armed, 0);
+
+    char drain[64];
+    while (read(board->wake_fd[0], drain, sizeof(drain)) > 0);
 }
 
 // ==================================================================
@@ -53,42 +104,32 @@ void* ghost_thread(void* arg) {
     free(params); // Libertar memória do argumento
 
     debug("[THREAD GHOST %d] Iniciada.\n", ghost_idx);
-    ghost_t* self = &board->ghosts[ghost_idx];
-    
-    while (board->game_running) {
-        // 1. Simular velocidade (Sleep fora do lock!)
-        int sleep_time = (board->tempo > 0) ? board->tempo : 100;
-        sleep_ms(sleep_time);
-
-        // CORREÇÃO: Removido lock_all_rows daqui. O move_ghost trata dos locks.
-
-        // Verificar se jogo acabou enquanto dormia
-        if (!board->game_running) {
-            break;
-        }
-
-        // 3. Mover
-        command_t cmd;
-        if (self->n_moves > 0) {
-            cmd = self->moves[self->current_move % self->n_moves];
-            move_ghost(board, ghost_idx, &cmd);
-        } else {
-            // Movimento aleatório se não houver ficheiro
-            char opts[] = {'W','A','S','D'};
-            cmd.command = opts[rand() % 4];
-            move_ghost(board, ghost_idx, &cmd);
-        }
-    }
+    // Um grupo só com este fantasma (os workers de --procs correm grupos maiores)
+    ghost_group_run(board, ghost_idx, ghost_idx + 1, (board->tempo > 0) ? board->tempo : 100, NULL);
     return NULL;
 }
 
 // ==================================================================
-// THREAD DO PACMAN
+// THREAD DO PACMAN (uma por pacman)
 // ==================================================================
+static int timed_move_pacman(board_t* board, int pacman_idx, command_t* cmd) {
+    uint64_t start = now_ns();
+    int result = move_pacman(board, pacman_idx, cmd);
+    uint64_t ns = now_ns() - start;
+    latency_record(LAT_MOVE_PACMAN, ns);
+    hud_record_move(ns, result == INVALID_MOVE);
+    return result;
+}
+
 void* pacman_thread(void* arg) {
-    board_t* board = (board_t*)arg;
-    pacman_t* self = &board->pacmans[0];
-    debug("[THREAD PACMAN] Iniciada.\n");
+    thread_arg_t* params = (thread_arg_t*)arg;
+    board_t* board = params->board;
+    int pacman_idx = params->id;
+    free(params); // Libertar memória do argumento
+
+    pacman_t* self = &board->pacmans[pacman_idx];
+    debug("[THREAD PACMAN %d] Iniciada.\n", pacman_idx);
+    hud_thread_start(HUD_THREAD_PACMAN, pacman_idx, 1);
 
     while (board->game_running) {
         // Sleep pequeno para não "queimar" CPU
@@ -103,141 +144,318 @@ void* pacman_thread(void* arg) {
         command_t cmd;
         int moved = 0;
 
-        // Prioridade A: Comando Manual (vindo da Main Thread)
-        if (board->next_pacman_cmd != '\0') {
+        // Prioridade A: Comando Manual (vindo da Main Thread, só para o pacman 0)
+        if (pacman_idx == 0 && board->next_pacman_cmd != '\0') {
             cmd.command = board->next_pacman_cmd;
             cmd.turns = 1;
+            cmd.scripted = 0; // Não mexe na posição do script
             board->next_pacman_cmd = '\0'; // Limpar comando
             
-            int result = move_pacman(board, 0, &cmd);
-            moved = 1;
-
-            if (result == REACHED_PORTAL) {
-                board->exit_status = 1; // Vitória
-                board->game_running = 0;
-            } else if (result == DEAD_PACMAN) {
-                board->exit_status = 2; // Morte
-                board->game_running = 0;
-            }
+            update_game_status(board, timed_move_pacman(board, pacman_idx, &cmd));
+            board_changed(board); // Um frame por tecla, mesmo contra uma parede (LAT_KEY_TO_SCREEN)
+
+            // No máximo uma jogada do teclado por TEMPO (uma tecla presa não acelera o pacman)
+            if (board->game_running && self->alive) sleep_ms(board->tempo);
         }
-    // Prioridade B: Modo Automático (Ficheiro)
-        else if (self->n_moves > 0) {
-             cmd = self->moves[self->current_move % self->n_moves];
+        // Prioridade B: Autopiloto (só o pacman 0, no lugar do script)
+        else if (pacman_idx == 0 && autopilot) {
+            uint64_t start = now_ns();
+            cmd.command = autopilot_decide(autopilot, board);
+            cmd.turns = 1;
+            cmd.scripted = 0;
+            if (board->game_running) update_game_status(board, timed_move_pacman(board, pacman_idx, &cmd));
+
+            // O TEMPO conta a partir do início da procura
+            int spent_ms = (int)((now_ns() - start) / 1000000);
+            if (board->tempo > spent_ms) sleep_ms(board->tempo - spent_ms);
+        }
+    // Prioridade C: Modo Automático (Ficheiro)
+        else if (script_runnable(self->script)) {
+             const instr_t* ins = script_fetch(board, self->script, &self->vm, self->pos_x, self->pos_y);
+             if (!ins) continue;
 
              // --- TRATAMENTO DE COMANDOS ESPECIAIS (G e Q) ---
              
              // Caso 1: SAVE (G)
-             if (cmd.command == 'G') {
+             if (ins->dir == 'G') {
                  if (!has_active_save) { // Só pede save se nao houver um ativo
                      board->save_request = 1; 
+                     board_changed(board); // Acordar a UI, que é quem faz o fork
                  }
-                 self->current_move++;    
+                 vm_advance(&self->vm);
                  sleep_ms(50);            
                  continue; 
              }
              
              // Caso 2: QUIT (Q)
-             if (cmd.command == 'Q') {
+             if (ins->dir == 'Q') {
                  board->exit_status = 3;  // Código de saída 3 = QUIT
                  board->game_running = 0; // Para todas as threads
+                 board_changed(board);
                  break; // Sai imediatamente do while da thread
              }
              // -----------------------------------------------
 
-             int result = move_pacman(board, 0, &cmd);
+             cmd.command = ins->dir;
+             cmd.turns = ins->arg;
+             cmd.scripted = 1;
+             update_game_status(board, timed_move_pacman(board, pacman_idx, &cmd));
              moved = 1;
-
-             if (result == REACHED_PORTAL) {
-                 board->exit_status = 1;
-                 board->game_running = 0;
-             } else if (result == DEAD_PACMAN) {
-                 board->exit_status = 2;
-                 board->game_running = 0;
-             }
         }
 
         // Verificação passiva (se um fantasma me matou no turno dele)
-        if (!self->alive && board->game_running) {
-             board->exit_status = 2; 
-             board->game_running = 0;
+        if (!self->alive) {
+             if (board->game_running) update_game_status(board, DEAD_PACMAN);
+             break; // Pacman morto não joga mais
         }
 
         // Se houve movimento automático, esperar o TEMPO do jogo
-        if (moved && self->n_moves > 0) sleep_ms(board->tempo);
+        if (moved && script_runnable(self->script)) sleep_ms(board->tempo);
     }
+    hud_thread_exit();
     return NULL;
 }
 
+// Cria uma thread por pacman e, se ghosts (sem --procs), uma por fantasma
+static void start_agent_threads(board_t* board, pthread_t* p_threads, pthread_t* g_threads, int ghosts) {
+    for(int p=0; p < board->n_pacmans; p++) {
+        thread_arg_t* args = malloc(sizeof(thread_arg_t));
+        args->board = board;
+        args->id = p;
+        pthread_create(&p_threads[p], NULL, pacman_thread, args);
+    }
+    for(int g=0; ghosts && g < board->n_ghosts; g++) {
+        thread_arg_t* args = malloc(sizeof(thread_arg_t));
+        args->board = board;
+        args->id = g;
+        pthread_create(&g_threads[g], NULL, ghost_thread, args);
+    }
+}
+
 // ==================================================================
 // MAIN (UI THREAD)
 // ==================================================================
 int main(int argc, char** argv) {
-    if (argc < 2) { printf("Usage: %s <dir>\n", argv[0]); return 1; }
+    if (argc < 2) {
+        printf("Usage: %s [--spectate[=name]] [--render=ncurses|ansi|null] [--stats[=file]] [--procs[=N]] [--autopilot[=playouts]] [--trace[=file]] [--metrics=socket|port] <dir>\n"
+               "       %s --batch [options] <dir>...\n"
+               "       %s --server [options] <dir>...\n"
+               "       %s --control [options] <socket> <dir>\n", argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
 
-    char* dir_path = argv[1];
+    // Modo batch: valida pastas de níveis sem terminal
+    if (strcmp(argv[1], "--batch") == 0) return run_batch(argc - 1, argv + 1);
+
+    // Modo servidor: muitas sessões headless num pool de threads
+    if (strcmp(argv[1], "--server") == 0) return run_server(argc - 1, argv + 1);
+
+    // Modo controlo: um bot joga por um socket UNIX, tick a tick
+    if (strcmp(argv[1], "--control") == 0) return run_control(argc - 1, argv + 1);
+
+    // Backend de desenho: PACMANIST_RENDER e depois --render (a opção ganha)
+    const char* render = getenv("PACMANIST_RENDER");
+    const char* stats_path = NULL;
+    const char* trace_path = NULL;
+    const char* metrics_where = NULL;
+    int n_procs = 0;
+    int autopilot_playouts = 0;
+    int arg = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++) {
+        if (strncmp(argv[arg], "--spectate", 10) == 0) {
+            // Espectadores: publicar os frames em memória partilhada (ver bin/viewer)
+            const char* name = (argv[arg][10] == '=') ? argv[arg] + 11 : SPECTATE_DEFAULT_NAME;
+            if (spectate_open(name) != 0) fprintf(stderr, "spectate: continuing without spectators\n");
+        }
+        else if (strncmp(argv[arg], "--render=", 9) == 0) {
+            render = argv[arg] + 9;
+        }
+        else if (strncmp(argv[arg], "--procs", 7) == 0) {
+            // Fantasmas em N processos sobre o tabuleiro em memória partilhada (ver procs.h)
+            n_procs = (argv[arg][7] == '=') ? atoi(argv[arg] + 8) : 2;
+            if (n_procs < 1) {
+                fprintf(stderr, "--procs needs at least one worker\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[arg], "--autopilot", 11) == 0) {
+            // Pacman 0 jogado por MCTS quando não há tecla (ver autopilot.h)
+            autopilot_playouts = (argv[arg][11] == '=') ? atoi(argv[arg] + 12) : AUTOPILOT_DEFAULT_PLAYOUTS;
+            if (autopilot_playouts < 1) {
+                fprintf(stderr, "--autopilot needs at least one playout\n");
+                return 1;
+            }
+        }
+        else if (strncmp(argv[arg], "--stats", 7) == 0) {
+            // Histogramas de latência, escritos em JSON no fim (ver latency.h)
+            stats_path = (argv[arg][7] == '=') ? argv[arg] + 8 : "latency.json";
+        }
+        else if (strncmp(argv[arg], "--trace", 7) == 0) {
+            // Todos os eventos do jogo em CSV (ver events.h)
+            trace_path = (argv[arg][7] == '=') ? argv[arg] + 8 : "trace.csv";
+        }
+        else if (strncmp(argv[arg], "--metrics=", 10) == 0) {
+            // Contadores em formato Prometheus num socket UNIX ou porta local (ver metrics.h)
+            metrics_where = argv[arg] + 10;
+        }
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[arg]);
+            return 1;
+        }
+    }
+    if (render && *render && display_select(render) != 0) {
+        fprintf(stderr, "Unknown render backend: %s (ncurses, ansi, null)\n", render);
+        return 1;
+    }
+    if (arg >= argc) {
+        printf("Usage: %s [--spectate[=name]] [--render=ncurses|ansi|null] [--stats[=file]] [--procs[=N]] [--autopilot[=playouts]] [--trace[=file]] [--metrics=socket|port] <dir>\n", argv[0]);
+        return 1;
+    }
+
+    char* dir_path = argv[arg];
     struct dirent **namelist;
     int n = scandir(dir_path, &namelist, filter_levels, alphasort);
     if (n < 0) { perror("scandir"); return 1; }
 
     srand(time(NULL));
+    if (stats_path && latency_init() != 0) stats_path = NULL;
+    // Antes de qualquer fork (workers, quicksave): os slots são partilhados
+    if (hud_init() == 0) hud_thread_start(HUD_THREAD_UI, 0, 1);
+    int hud_visible = 0;
+    uint64_t hud_at = 0;
+    metrics_server_t* metrics = metrics_where ? metrics_start(metrics_where) : NULL;
+    if (metrics_where && !metrics) fprintf(stderr, "metrics: continuing without the endpoint\n");
     open_debug_file("debug.log");
+
+    // Subscritores por ordem: desenho, debug.log, estatísticas do nível e trace
+    event_bus = event_bus_create(EVENT_DEFAULT_CAPACITY);
+    if (event_bus) {
+        event_bus_subscribe(event_bus, render_event_handler, &event_redraw);
+        event_bus_subscribe(event_bus, event_log_handler, NULL);
+        event_bus_subscribe(event_bus, event_stats_handler, &level_events);
+        if (trace_path && event_trace_open(&event_trace, trace_path) == 0) {
+            event_bus_subscribe(event_bus, event_trace_handler, &event_trace);
+        }
+        else if (trace_path) {
+            perror(trace_path);
+        }
+    }
     terminal_init();
     
-    board_t game_board;
-    int accumulated_points = 0;
+    board_t level_board;
+    board_t* game_board = &level_board; // Com --procs, a cópia em memória partilhada enquanto o nível corre
+    int* accumulated_points = NULL;
+    int n_accumulated = 0;
     has_active_save = 0;
 
     for (int i = 0; i < n; i++) {
-        if (load_level(&game_board, dir_path, namelist[i]->d_name, accumulated_points) != 0) {
+        if (load_level(game_board, dir_path, namelist[i]->d_name, accumulated_points, n_accumulated) != 0) {
             free(namelist[i]); continue;
         }
 
         // --- INICIALIZAÇÃO ---
         
-        pthread_t p_thread;
-        pthread_t g_threads[MAX_GHOSTS];
-
-        // 1. Criar Threads
-        pthread_create(&p_thread, NULL, pacman_thread, &game_board);
-        for(int g=0; g < game_board.n_ghosts; g++) {
-            thread_arg_t* args = malloc(sizeof(thread_arg_t));
-            args->board = &game_board;
-            args->id = g;
-            pthread_create(&g_threads[g], NULL, ghost_thread, args);
+        hud_set_level(i, namelist[i]->d_name);
+        unsigned long dropped_before = 0, procs_dropped = 0; // Eventos descartados: na fila do bus e na partilhada de --procs
+        if (event_bus) {
+            game_board->events = event_bus_queue(event_bus);
+            dropped_before = event_queue_dropped(game_board->events);
+            memset(&level_events, 0, sizeof(level_events));
+            event_trace_level(&event_trace, game_board->level_name);
+        }
+        pthread_t* p_threads = malloc(sizeof(pthread_t) * game_board->n_pacmans);
+        pthread_t* g_threads = malloc(sizeof(pthread_t) * (game_board->n_ghosts + 1));
+
+        // 1. Criar Threads (com --procs, os fantasmas vão para processos e o resto usa o tabuleiro partilhado)
+        board_wake_open(game_board);
+        ghost_procs_t* procs = NULL;
+        if (n_procs > 0 && game_board->n_ghosts > 0) {
+            procs = ghost_procs_start(game_board, n_procs, (game_board->tempo > 0) ? game_board->tempo : 100);
+            if (procs) game_board = ghost_procs_board(procs);
+        }
+        if (autopilot_playouts > 0) {
+            autopilot_opts_t opts;
+            autopilot_default_opts(&opts);
+            opts.playouts = autopilot_playouts;
+            opts.budget_ms = (game_board->tempo > 0) ? game_board->tempo : 10; // Uma decisão por TEMPO
+            autopilot = autopilot_create(game_board, 0, &opts);
+            if (!autopilot) debug("[AUTOPILOT] Not available in this level.\n");
         }
+        start_agent_threads(game_board, p_threads, g_threads, procs == NULL);
 
-        screen_refresh(&game_board, DRAW_MENU);
+        unsigned long drawn_gen = atomic_load(&game_board->generation);
+        screen_refresh(game_board, DRAW_MENU);
+        uint64_t last_frame = now_ns();
+        const uint64_t frame_ns = 1000000000ull / MAX_FPS;
+        int redraw = 0;
+        uint64_t key_at = 0; // Quando foi lida a última tecla WASD ainda sem frame (LAT_KEY_TO_SCREEN)
 
         // --- LOOP PRINCIPAL (UI & INPUT) ---
-        while (game_board.game_running) {
-            
-            // 1. Desenhar (Usando helper para bloquear estado)
-            screen_refresh(&game_board, DRAW_MENU);
+        while (game_board->game_running) {
+            if (procs) ghost_procs_poll(procs); // Relançar workers mortos ou presos
+
+            // 0. Entregar os eventos publicados pelos agentes (com --procs, os da fila partilhada)
+            if (event_bus && event_bus_dispatch(event_bus, game_board->events) > 0 && event_redraw) {
+                redraw = 1;
+                event_redraw = 0;
+            }
 
-            // 2. Input
+            // 1. Desenhar só se o tabuleiro mudou desde o último frame (no máximo MAX_FPS)
+            unsigned long gen = atomic_load(&game_board->generation);
+            uint64_t now = now_ns();
+            if (hud_visible && now - hud_at >= HUD_PERIOD_MS * 1000000ull) {
+                char hud_text[1024];
+                hud_format(hud_text, sizeof(hud_text), HUD_WIDTH, HUD_LINES);
+                display_set_overlay(hud_text);
+                hud_at = now;
+                redraw = 1;
+            }
+            if ((gen != drawn_gen || redraw) && now - last_frame >= frame_ns) {
+                int key_done = key_at && game_board->next_pacman_cmd == '\0'; // Jogada feita antes deste frame
+                screen_refresh(game_board, DRAW_MENU);
+                if (key_done) {
+                    latency_record(LAT_KEY_TO_SCREEN, now_ns() - key_at);
+                    key_at = 0;
+                }
+                drawn_gen = gen;
+                last_frame = now;
+                redraw = 0;
+            }
+
+            // 2. Input (Q, G e H nunca esperam pelo pacman)
             char input = get_input();
 
             // =======================================================
             // LÓGICA DE SAVE (G) - TECLADO OU FICHEIRO
             // =======================================================
-            if ((input == 'G' || game_board.save_request) && has_active_save == 0) {
+            if (procs && (input == 'G' || game_board->save_request)) {
+                // O fork do save só copiava este processo, não os workers: sem quicksave com --procs
+                game_board->save_request = 0;
+            }
+            else if ((input == 'G' || game_board->save_request) && has_active_save == 0) {
                 
-                game_board.save_request = 0; // Limpar bandeira
+                game_board->save_request = 0; // Limpar bandeira
 
                 // 1. BLOQUEAR O PAI (STOP THE WORLD)
-                lock_all_rows(&game_board);
+                uint64_t save_start = now_ns();
+                lock_all_rows(game_board, LOCK_CALLER_SAVE);
+
+                // Eventos e trace em dia: o filho herdaria a fila e o buffer do FILE e repeti-los-ia
+                if (event_bus) event_bus_dispatch(event_bus, game_board->events);
+                if (event_trace.file) fflush(event_trace.file);
                 
                 pid_t pid = fork();
 
                 if (pid < 0) {
                     perror("Erro fork");
-                    unlock_all_rows(&game_board);
+                    unlock_all_rows(game_board);
                 }
                 else if (pid > 0) {
                     // === PROCESSO PAI (Wait & Freeze) ===
                     
                     int status;
                     waitpid(pid, &status, 0); 
+                    hud_forget(pid); // As threads do filho saíram com ele
 
                     // O Filho terminou. O Pai acorda.
                     
@@ -247,103 +465,162 @@ int main(int argc, char** argv) {
                         if (exit_code == EXIT_RESTORE) {
                             // Restaurar
                             has_active_save = 0;
-                            clear(); refresh();
+                            display_clear();
+                            redraw = 1;
 
                             // Soltamos as threads do Pai para continuarem do ponto 'G'
-                            unlock_all_rows(&game_board);
+                            unlock_all_rows(game_board);
+                            hud_restore_end();
                             
                             continue; // Volta ao início do loop
                         }
                         else if (exit_code == EXIT_GAME_OVER) {
                             // Quit no filho
-                            game_board.exit_status = 3;
-                            game_board.game_running = 0;
+                            game_board->exit_status = 3;
+                            game_board->game_running = 0;
                         }
                     }
                     // Libertar o lock se não for restore
-                    unlock_all_rows(&game_board);
+                    unlock_all_rows(game_board);
                 }
                 else {
                     // === PROCESSO FILHO (Jogo Ativo) ===
                     
                     // O filho herda o mutex TRANCADO. Destrancar IMEDIATAMENTE.
-                    unlock_all_rows(&game_board);
+                    unlock_all_rows(game_board);
+                    chase_after_fork(game_board);
                     
                     has_active_save = 1;
 
-                    // Reiniciar ncurses para o filho (CRÍTICO)
-                    nodelay(stdscr, TRUE);
-                    keypad(stdscr, TRUE);
+                    // Reiniciar o terminal para o filho (CRÍTICO no ncurses)
+                    display_after_fork();
                     
                     // Recriar as threads no filho (apenas a main sobreviveu ao fork)
-                    pthread_create(&p_thread, NULL, pacman_thread, &game_board);
-                    for(int g=0; g < game_board.n_ghosts; g++) {
-                        thread_arg_t* args = malloc(sizeof(thread_arg_t));
-                        args->board = &game_board;
-                        args->id = g;
-                        pthread_create(&g_threads[g], NULL, ghost_thread, args);
-                    }
+                    start_agent_threads(game_board, p_threads, g_threads, 1);
+                    hud_count(HUD_SAVES, 1);
+                    hud_count(HUD_SAVE_NS, now_ns() - save_start);
                 }
             }
             // =======================================================
             // LÓGICA DE QUIT (Q)
             // =======================================================
             else if (input == 'Q') {
-                lock_all_rows(&game_board);
-                game_board.exit_status = 3; 
-                game_board.game_running = 0;
-                unlock_all_rows(&game_board);
+                lock_all_rows(game_board, LOCK_CALLER_QUIT);
+                game_board->exit_status = 3; 
+                game_board->game_running = 0;
+                unlock_all_rows(game_board);
                 
                 if (has_active_save) exit(EXIT_GAME_OVER);
             } 
             // =======================================================
+            // HUD DE DESEMPENHO (H)
+            // =======================================================
+            else if (input == 'H') {
+                hud_visible = !hud_visible;
+                hud_at = 0; // Recalcular já no próximo frame
+                if (!hud_visible) display_set_overlay(NULL);
+                redraw = 1;
+            }
+            // =======================================================
             // INPUT DE MOVIMENTO (WASD)
             // =======================================================
             else if (input != '\0') {
-                game_board.next_pacman_cmd = input;
+                // Uma tecla de cada vez, e só com o pacman 0 vivo (morto, a thread dele já saiu): senão perde-se
+                if (game_board->pacmans[0].alive && game_board->next_pacman_cmd == '\0') {
+                    game_board->next_pacman_cmd = input;
+                    key_at = now_ns();
+                }
             }
 
-            sleep_ms(33); // ~30 FPS UI Update
+            // 3. Dormir até haver algo para fazer (depois de uma tecla, ver logo se há mais)
+            if (input == '\0' && game_board->game_running && !game_board->save_request) {
+                wait_for_activity(game_board, drawn_gen, redraw, last_frame + frame_ns);
+            }
         }
 
         // --- FIM DO NÍVEL / JOGO ---
         
-        pthread_join(p_thread, NULL);
-        for(int g=0; g < game_board.n_ghosts; g++) {
+        for(int p=0; p < game_board->n_pacmans; p++) {
+            pthread_join(p_threads[p], NULL);
+        }
+        if (event_bus && procs) {
+            event_bus_dispatch(event_bus, game_board->events);
+            procs_dropped = event_queue_dropped(game_board->events);
+        }
+        if (procs) {
+            ghost_procs_stop(procs); // O estado volta para o level_board
+            game_board = &level_board;
+        }
+        for(int g=0; !procs && g < game_board->n_ghosts; g++) {
             pthread_join(g_threads[g], NULL);
         }
+        if (event_bus) {
+            event_bus_dispatch(event_bus, game_board->events); // Últimas jogadas dos fantasmas (threads)
+            debug("[EVENTS] %s: %lu dots, %lu deaths, %lu portals, %lu charges, %lu moves, %lu dropped\n",
+                  game_board->level_name, level_events.count[EVENT_DOT_EATEN], level_events.count[EVENT_PACMAN_KILLED],
+                  level_events.count[EVENT_PORTAL_REACHED], level_events.count[EVENT_GHOST_CHARGED],
+                  level_events.count[EVENT_MOVE],
+                  event_queue_dropped(game_board->events) - dropped_before + procs_dropped);
+        }
+        if (autopilot) {
+            autopilot_stats_t ap_stats;
+            autopilot_get_stats(autopilot, &ap_stats);
+            debug("[AUTOPILOT] %lu decisions, %lu playouts, %lu simulated ticks, %.1f ms/decision\n",
+                  ap_stats.decisions, ap_stats.playouts, ap_stats.ticks,
+                  ap_stats.decisions ? ap_stats.search_ns / 1e6 / ap_stats.decisions : 0.0);
+            autopilot_destroy(autopilot);
+            autopilot = NULL;
+        }
+        free(p_threads);
+        free(g_threads);
         
-        int status = game_board.exit_status;
+        int status = game_board->exit_status;
 
         // SE SOU FILHO E MORRI -> AVISAR PAI
         if (status == 2 && has_active_save) {
+            hud_restore_begin();
             exit(EXIT_RESTORE);
         }
 
         if (status == 1) { // VITÓRIA
-            screen_refresh(&game_board, DRAW_WIN);
+            screen_refresh(game_board, DRAW_WIN);
             sleep_ms(1000);
-            accumulated_points = game_board.pacmans[0].points;
-            unload_level(&game_board);
+            // Pontos de cada pacman passam para o nível seguinte
+            free(accumulated_points);
+            n_accumulated = game_board->n_pacmans;
+            accumulated_points = malloc(sizeof(int) * n_accumulated);
+            for (int p = 0; p < n_accumulated; p++) {
+                accumulated_points[p] = game_board->pacmans[p].points;
+            }
+            unload_level(game_board);
             free(namelist[i]);
-            clear(); refresh();
+            display_clear();
         }
         else { 
             // DERROTA ou QUIT
             if (status == 2) {
-                screen_refresh(&game_board, DRAW_GAME_OVER);
+                screen_refresh(game_board, DRAW_GAME_OVER);
                 sleep_ms(2000);
             }
             
-            unload_level(&game_board);
+            unload_level(game_board);
             free(namelist[i]);
             break; // Sai do loop de níveis
         }
     }
     
     // Limpeza final
+    free(accumulated_points);
     free(namelist);
+    agent_cache_clear();
     terminal_cleanup();
+    spectate_close();
+    if (stats_path) latency_report(stats_path, dir_path, display_backend_name());
+    latency_close();
+    metrics_stop(metrics); // Antes do hud_close: a thread lê os slots
+    hud_close();
+    event_trace_close(&event_trace);
+    event_bus_destroy(event_bus);
     close_debug_file();
     return 0;
 }
\ No newline at end of file
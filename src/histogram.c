@@ -0,0 +1,117 @@
+#include "histogram.h"
+#include <time.h>
+
+static int bucket_of(uint64_t value) {
+    int b = 0;
+    while (value && b < HIST_BUCKETS - 1) {
+        value >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void hist_record(histogram_t* h, uint64_t value) {
+    h->buckets[bucket_of(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) h->max = value;
+}
+
+void hist_merge(histogram_t* dst, const histogram_t* src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->buckets[i] += src->buckets[i];
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+uint64_t hist_percentile(const histogram_t* h, double p) {
+    if (h->count == 0) return 0;
+
+    uint64_t target = (uint64_t)((p / 100.0) * h->count + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= target) {
+            uint64_t upper = (i == 0) ? 0 : ((uint64_t)1 << i) - 1;
+            return (upper < h->max) ? upper : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Índice = (ordem de grandeza, HDR_SUB_BITS bits a seguir ao bit mais alto)
+static int hdr_index_of(uint64_t value) {
+    if (value < HDR_SUB_BUCKETS) return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HDR_SUB_BITS;
+    int sub = (int)((value >> shift) & (HDR_SUB_BUCKETS - 1));
+    return (shift + 1) * HDR_SUB_BUCKETS + sub;
+}
+
+static uint64_t hdr_upper_of(int index) {
+    if (index < HDR_SUB_BUCKETS) return (uint64_t)index;
+    int shift = index / HDR_SUB_BUCKETS - 1;
+    uint64_t sub = (uint64_t)(index % HDR_SUB_BUCKETS);
+    return ((HDR_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void hdr_record(hdr_histogram_t* h, uint64_t value) {
+    atomic_fetch_add_explicit(&h->buckets[hdr_index_of(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > max &&
+           !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+                                                  memory_order_relaxed, memory_order_relaxed));
+}
+
+void hdr_reset(hdr_histogram_t* h) {
+    for (int i = 0; i < HDR_BUCKETS; i++) atomic_store_explicit(&h->buckets[i], 0, memory_order_relaxed);
+    atomic_store_explicit(&h->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->sum, 0, memory_order_relaxed);
+    atomic_store_explicit(&h->max, 0, memory_order_relaxed);
+}
+
+void hdr_merge(hdr_histogram_t* dst, const hdr_histogram_t* src) {
+    for (int i = 0; i < HDR_BUCKETS; i++) {
+        atomic_fetch_add_explicit(&dst->buckets[i], atomic_load_explicit(&src->buckets[i], memory_order_relaxed),
+                                  memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&dst->count, atomic_load_explicit(&src->count, memory_order_relaxed), memory_order_relaxed);
+    atomic_fetch_add_explicit(&dst->sum, atomic_load_explicit(&src->sum, memory_order_relaxed), memory_order_relaxed);
+
+    uint64_t value = atomic_load_explicit(&src->max, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&dst->max, memory_order_relaxed);
+    while (value > max &&
+           !atomic_compare_exchange_weak_explicit(&dst->max, &max, value,
+                                                  memory_order_relaxed, memory_order_relaxed));
+}
+
+// Com registos a decorrer o resultado é aproximado (os contadores não são lidos todos no mesmo instante)
+uint64_t hdr_percentile(const hdr_histogram_t* h, double p) {
+    uint64_t count = atomic_load_explicit(&h->count, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    if (count == 0) return 0;
+
+    uint64_t target = (uint64_t)((p / 100.0) * count + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HDR_BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t upper = hdr_upper_of(i);
+            return (upper < max) ? upper : max;
+        }
+    }
+    return max;
+}
+
+uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
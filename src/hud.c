@@ -0,0 +1,423 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+#include "hud.h"
+#include "histogram.h"
+#include <stdalign.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+typedef struct {
+    alignas(64) atomic_int state; // 0 livre, 2 a ocupar (CAS), 1 ocupado: só os ocupados contam
+    atomic_int pid;
+    atomic_ulong claims;          // Muda a cada ocupação: a UI reconhece um slot reutilizado
+    int kind, index, count;
+    clockid_t cpu_clock;          // Relógio de CPU da thread (pthread_getcpuclockid); has_clock = 0 sem ele
+    int has_clock;
+    // Escritos só pela thread dona
+    atomic_ulong moves, move_ns, move_max_ns, max_epoch, invalid_moves;
+    atomic_ulong lock_waits, lock_wait_ns;
+    atomic_ulong frames;
+    atomic_ulong cpu_ns;          // Última amostra publicada pela thread (ver hud_sample_cpu)
+    atomic_ulong counts[N_HUD_COUNTERS];
+} hud_slot_t;
+
+// Contadores somados com RMW: os das threads que já saíram (só à saída) e
+// os das threads que não arranjaram slot (a cada registo, ver overflow_kind)
+typedef struct {
+    atomic_ulong moves[N_HUD_KINDS], invalid_moves[N_HUD_KINDS], move_ns[N_HUD_KINDS];
+    atomic_ulong lock_waits, lock_wait_ns, frames;
+    atomic_ulong counts[N_HUD_COUNTERS];
+} hud_retired_t;
+
+typedef struct {
+    atomic_ulong epoch; // Janela do move_max_ns: a UI avança-a a cada leitura
+    // Quem reforma um slot incrementa begin antes e end depois: hud_totals só
+    // aceita uma leitura em que não houve reformas a meio
+    atomic_ulong retire_begin, retire_end;
+    hud_retired_t retired;
+    hud_retired_t overflow;
+    atomic_int overflow_threads; // Threads a jogar sem slot
+    atomic_ulong restore_at;  // now_ns() da morte no filho de um quicksave (0 = nenhuma)
+    atomic_ulong level_seq;   // Seqlock do nível: ímpar durante a escrita
+    atomic_int level_index;
+    char level[256];
+    hud_slot_t slots[HUD_MAX_THREADS];
+} hud_page_t;
+
+// Leitura anterior de um slot (só a UI)
+typedef struct {
+    unsigned long claims;
+    unsigned long moves, move_ns, lock_waits, lock_wait_ns, frames, cpu_ns;
+} hud_prev_t;
+
+static hud_page_t* page;
+static _Thread_local hud_slot_t* self = NULL;
+static _Thread_local int overflow_kind = -1; // Sem slot: os registos vão para page->overflow
+static hud_prev_t prev[HUD_MAX_THREADS];
+static hud_prev_t prev_overflow;
+static uint64_t prev_at;
+
+#define LOAD(field) atomic_load_explicit(&(field), memory_order_relaxed)
+#define STORE(field, value) atomic_store_explicit(&(field), (value), memory_order_relaxed)
+// Só o dono escreve: somar sem RMW atómico
+#define ADD(field, value) STORE(field, LOAD(field) + (value))
+
+int hud_init(void) {
+    if (page) return 0;
+    void* mem = mmap(NULL, sizeof(hud_page_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("hud: mmap");
+        return -1;
+    }
+    page = mem; // mmap anónimo já vem a zeros
+    atomic_store(&page->level_index, -1);
+    memset(prev, 0, sizeof(prev));
+    memset(&prev_overflow, 0, sizeof(prev_overflow));
+    prev_at = now_ns();
+    return 0;
+}
+
+void hud_close(void) {
+    if (!page) return;
+    munmap(page, sizeof(hud_page_t));
+    page = NULL;
+    self = NULL;
+    overflow_kind = -1;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void hud_thread_start(hud_kind_t kind, int index, int count) {
+    self = NULL;
+    overflow_kind = -1;
+    if (!page) return;
+    for (int s = 0; s < HUD_MAX_THREADS; s++) {
+        hud_slot_t* slot = &page->slots[s];
+        int expected = 0;
+        if (!atomic_compare_exchange_strong(&slot->state, &expected, 2)) continue;
+
+        slot->kind = kind;
+        slot->index = index;
+        slot->count = count;
+        STORE(slot->moves, 0);
+        STORE(slot->move_ns, 0);
+        STORE(slot->move_max_ns, 0);
+        STORE(slot->invalid_moves, 0);
+        for (int c = 0; c < N_HUD_COUNTERS; c++) STORE(slot->counts[c], 0);
+        STORE(slot->max_epoch, LOAD(page->epoch));
+        STORE(slot->lock_waits, 0);
+        STORE(slot->lock_wait_ns, 0);
+        STORE(slot->frames, 0);
+        slot->has_clock = pthread_getcpuclockid(pthread_self(), &slot->cpu_clock) == 0;
+        STORE(slot->cpu_ns, thread_cpu_ns());
+        STORE(slot->pid, (int)getpid());
+        atomic_fetch_add(&slot->claims, 1);
+        atomic_store(&slot->state, 1); // Só agora, com os contadores a zero, entra nos totais
+        self = slot;
+        return;
+    }
+
+    // Todos os slots ocupados: a thread conta no overflow partilhado (sem CPU nem máximo)
+    overflow_kind = kind;
+    atomic_fetch_add(&page->overflow_threads, 1);
+}
+
+// Passa os contadores do slot para os totais das threads terminadas e liberta-o
+static void retire_slot(hud_slot_t* slot) {
+    hud_retired_t* r = &page->retired;
+    atomic_fetch_add(&page->retire_begin, 1);
+    atomic_fetch_add(&r->moves[slot->kind], LOAD(slot->moves));
+    atomic_fetch_add(&r->invalid_moves[slot->kind], LOAD(slot->invalid_moves));
+    atomic_fetch_add(&r->move_ns[slot->kind], LOAD(slot->move_ns));
+    atomic_fetch_add(&r->lock_waits, LOAD(slot->lock_waits));
+    atomic_fetch_add(&r->lock_wait_ns, LOAD(slot->lock_wait_ns));
+    atomic_fetch_add(&r->frames, LOAD(slot->frames));
+    for (int c = 0; c < N_HUD_COUNTERS; c++) atomic_fetch_add(&r->counts[c], LOAD(slot->counts[c]));
+    atomic_store(&slot->state, 0);
+    atomic_fetch_add(&page->retire_end, 1);
+}
+
+void hud_thread_exit(void) {
+    if (overflow_kind >= 0) {
+        atomic_fetch_sub(&page->overflow_threads, 1);
+        overflow_kind = -1;
+    }
+    if (!self) return;
+    retire_slot(self);
+    self = NULL;
+}
+
+void hud_forget(pid_t pid) {
+    if (!page) return;
+    for (int s = 0; s < HUD_MAX_THREADS; s++) {
+        hud_slot_t* slot = &page->slots[s];
+        if (atomic_load(&slot->state) == 1 && LOAD(slot->pid) == (int)pid) retire_slot(slot);
+    }
+}
+
+void hud_record_move(uint64_t ns, int invalid) {
+    hud_slot_t* slot = self;
+    if (!slot) {
+        if (overflow_kind < 0) return;
+        hud_retired_t* o = &page->overflow;
+        atomic_fetch_add_explicit(&o->moves[overflow_kind], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&o->move_ns[overflow_kind], ns, memory_order_relaxed);
+        if (invalid) atomic_fetch_add_explicit(&o->invalid_moves[overflow_kind], 1, memory_order_relaxed);
+        return;
+    }
+    ADD(slot->moves, 1);
+    ADD(slot->move_ns, ns);
+    if (invalid) ADD(slot->invalid_moves, 1);
+
+    // O máximo é da janela atual: numa janela nova recomeça
+    unsigned long epoch = LOAD(page->epoch);
+    if (LOAD(slot->max_epoch) != epoch) {
+        STORE(slot->max_epoch, epoch);
+        STORE(slot->move_max_ns, ns);
+    }
+    else if (ns > LOAD(slot->move_max_ns)) {
+        STORE(slot->move_max_ns, ns);
+    }
+}
+
+void hud_record_lock_wait(uint64_t ns) {
+    hud_slot_t* slot = self;
+    if (!slot) {
+        if (overflow_kind < 0) return;
+        atomic_fetch_add_explicit(&page->overflow.lock_waits, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&page->overflow.lock_wait_ns, ns, memory_order_relaxed);
+        return;
+    }
+    ADD(slot->lock_waits, 1);
+    ADD(slot->lock_wait_ns, ns);
+}
+
+void hud_record_frame(void) {
+    hud_slot_t* slot = self;
+    if (!slot) {
+        if (overflow_kind >= 0) atomic_fetch_add_explicit(&page->overflow.frames, 1, memory_order_relaxed);
+        return;
+    }
+    ADD(slot->frames, 1);
+}
+
+void hud_sample_cpu(void) {
+    hud_slot_t* slot = self;
+    if (!slot) return;
+    STORE(slot->cpu_ns, thread_cpu_ns());
+}
+
+void hud_count(hud_counter_t counter, uint64_t n) {
+    hud_slot_t* slot = self;
+    if (!slot) {
+        if (overflow_kind >= 0) atomic_fetch_add_explicit(&page->overflow.counts[counter], n, memory_order_relaxed);
+        return;
+    }
+    ADD(slot->counts[counter], n);
+}
+
+void hud_restore_begin(void) {
+    if (page) atomic_store(&page->restore_at, now_ns());
+}
+
+void hud_restore_end(void) {
+    if (!page) return;
+    uint64_t at = atomic_exchange(&page->restore_at, 0);
+    if (!at) return;
+    hud_count(HUD_RESTORES, 1);
+    hud_count(HUD_RESTORE_NS, now_ns() - at);
+}
+
+void hud_set_level(int index, const char* name) {
+    if (!page) return;
+    atomic_fetch_add(&page->level_seq, 1);
+    atomic_store(&page->level_index, index);
+    snprintf(page->level, sizeof(page->level), "%s", name);
+    atomic_fetch_add(&page->level_seq, 1);
+}
+
+static void add_shared(hud_totals_t* totals, hud_retired_t* r) {
+    for (int k = 0; k < N_HUD_KINDS; k++) {
+        totals->moves[k] += atomic_load(&r->moves[k]);
+        totals->invalid_moves[k] += atomic_load(&r->invalid_moves[k]);
+        totals->move_ns[k] += atomic_load(&r->move_ns[k]);
+    }
+    totals->lock_waits += atomic_load(&r->lock_waits);
+    totals->lock_wait_ns += atomic_load(&r->lock_wait_ns);
+    totals->frames += atomic_load(&r->frames);
+    for (int c = 0; c < N_HUD_COUNTERS; c++) totals->counts[c] += atomic_load(&r->counts[c]);
+}
+
+// Tentativas de hud_totals antes de aceitar uma leitura com uma reforma a meio
+// (um worker morto com SIGKILL durante a reforma deixaria begin != end para sempre)
+#define TOTALS_MAX_TRIES 1000
+
+int hud_totals(hud_totals_t* totals) {
+    if (!page) return -1;
+    hud_retired_t* r = &page->retired;
+    for (int tries = 0; ; tries++) {
+        unsigned long begin = atomic_load(&page->retire_begin);
+        int stable = atomic_load(&page->retire_end) == begin;
+        if (!stable && tries < TOTALS_MAX_TRIES) {
+            sched_yield();
+            continue;
+        }
+
+        memset(totals, 0, sizeof(*totals));
+        add_shared(totals, r);
+        add_shared(totals, &page->overflow);
+        totals->threads = atomic_load(&page->overflow_threads);
+
+        for (int s = 0; s < HUD_MAX_THREADS; s++) {
+            hud_slot_t* slot = &page->slots[s];
+            if (atomic_load(&slot->state) != 1) continue;
+            int k = slot->kind;
+            totals->moves[k] += LOAD(slot->moves);
+            totals->invalid_moves[k] += LOAD(slot->invalid_moves);
+            totals->move_ns[k] += LOAD(slot->move_ns);
+            totals->lock_waits += LOAD(slot->lock_waits);
+            totals->lock_wait_ns += LOAD(slot->lock_wait_ns);
+            totals->frames += LOAD(slot->frames);
+            for (int c = 0; c < N_HUD_COUNTERS; c++) totals->counts[c] += LOAD(slot->counts[c]);
+            totals->threads++;
+        }
+        if (atomic_load(&page->retire_begin) == begin || tries >= TOTALS_MAX_TRIES) break;
+    }
+
+    for (int tries = 0; tries < TOTALS_MAX_TRIES; tries++) {
+        unsigned long seq = atomic_load(&page->level_seq);
+        if (seq & 1) continue;
+        totals->level_index = atomic_load(&page->level_index);
+        memcpy(totals->level, page->level, sizeof(totals->level));
+        if (atomic_load(&page->level_seq) == seq) break;
+    }
+    totals->level[sizeof(totals->level) - 1] = '\0';
+    return 0;
+}
+
+// Acrescenta ao texto, a partir de *len, sem passar de size
+static void append(char* buf, size_t size, size_t* len, const char* format, ...) {
+    if (*len >= size) return;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf + *len, size - *len, format, args);
+    va_end(args);
+    if (n > 0) *len += ((size_t)n < size - *len) ? (size_t)n : size - *len - 1;
+}
+
+void hud_format(char* buf, size_t size, int width, int max_lines) {
+    if (size == 0) return;
+    buf[0] = '\0';
+    if (!page || max_lines < 1) return;
+
+    uint64_t now = now_ns();
+    double dt = (now > prev_at) ? (now - prev_at) / 1e9 : 1e-9;
+    prev_at = now;
+    unsigned long epoch = LOAD(page->epoch);
+    int pid = (int)getpid();
+
+    unsigned long moves = 0, move_ns = 0, move_max = 0, lock_waits = 0, lock_wait_ns = 0, frames = 0;
+    int active = 0;
+    double cpu[HUD_MAX_THREADS];
+    for (int s = 0; s < HUD_MAX_THREADS; s++) {
+        hud_slot_t* slot = &page->slots[s];
+        cpu[s] = -1;
+        if (atomic_load(&slot->state) != 1) continue;
+
+        hud_prev_t* p = &prev[s];
+        unsigned long claims = atomic_load(&slot->claims);
+        if (p->claims != claims) {
+            memset(p, 0, sizeof(*p));
+            p->claims = claims;
+        }
+
+        hud_prev_t cur = {
+            claims, LOAD(slot->moves), LOAD(slot->move_ns), LOAD(slot->lock_waits),
+            LOAD(slot->lock_wait_ns), LOAD(slot->frames), LOAD(slot->cpu_ns),
+        };
+        // CPU: a UI lê o relógio das threads do seu processo; as dos workers publicam-na (hud_sample_cpu).
+        // Uma thread que entretanto saiu já não tem relógio: fica a última amostra
+        struct timespec ts;
+        if (slot == self) cur.cpu_ns = thread_cpu_ns();
+        else if (LOAD(slot->pid) == pid && slot->has_clock && clock_gettime(slot->cpu_clock, &ts) == 0)
+            cur.cpu_ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+        // Um slot reocupado entre o teste das claims e a leitura pode andar para trás: conta 0
+        moves += (cur.moves >= p->moves) ? cur.moves - p->moves : 0;
+        move_ns += (cur.move_ns >= p->move_ns) ? cur.move_ns - p->move_ns : 0;
+        lock_waits += (cur.lock_waits >= p->lock_waits) ? cur.lock_waits - p->lock_waits : 0;
+        lock_wait_ns += (cur.lock_wait_ns >= p->lock_wait_ns) ? cur.lock_wait_ns - p->lock_wait_ns : 0;
+        frames += (cur.frames >= p->frames) ? cur.frames - p->frames : 0;
+        // A primeira leitura de um slot não tem base: a CPU só conta a partir da segunda
+        cpu[s] = (p->cpu_ns && cur.cpu_ns >= p->cpu_ns) ? (cur.cpu_ns - p->cpu_ns) / 1e9 / dt * 100 : 0;
+        if (LOAD(slot->max_epoch) == epoch && LOAD(slot->move_max_ns) > move_max) move_max = LOAD(slot->move_max_ns);
+        *p = cur;
+        active++;
+    }
+    atomic_store(&page->epoch, epoch + 1);
+
+    // Threads sem slot: só entram nas taxas (sem CPU nem máximo)
+    hud_retired_t* o = &page->overflow;
+    hud_prev_t cur_overflow = { 0, 0, 0, atomic_load(&o->lock_waits), atomic_load(&o->lock_wait_ns),
+                                atomic_load(&o->frames), 0 };
+    for (int k = 0; k < N_HUD_KINDS; k++) {
+        cur_overflow.moves += atomic_load(&o->moves[k]);
+        cur_overflow.move_ns += atomic_load(&o->move_ns[k]);
+    }
+    moves += cur_overflow.moves - prev_overflow.moves;
+    move_ns += cur_overflow.move_ns - prev_overflow.move_ns;
+    lock_waits += cur_overflow.lock_waits - prev_overflow.lock_waits;
+    lock_wait_ns += cur_overflow.lock_wait_ns - prev_overflow.lock_wait_ns;
+    frames += cur_overflow.frames - prev_overflow.frames;
+    prev_overflow = cur_overflow;
+    active += atomic_load(&page->overflow_threads);
+
+    size_t len = 0;
+    append(buf, size, &len, "HUD: %.0f ticks/s | %.1f fps | %d threads", moves / dt, frames / dt, active);
+    if (max_lines < 2) return;
+    append(buf, size, &len, "\nMove: avg %.1f us max %.1f us | Lock wait: %.2f ms/s (%lu)",
+           moves ? move_ns / 1e3 / moves : 0.0, move_max / 1e3, lock_wait_ns / 1e6 / dt, lock_waits);
+
+    // CPU por thread, em linhas de até 'width' colunas
+    static const char* const kind_names[N_HUD_KINDS] = { "ui", "p", "g" };
+    int lines = 2, col = width; // Força a quebra antes da primeira entrada
+    int shown = 0;
+    for (int s = 0; s < HUD_MAX_THREADS; s++) {
+        if (cpu[s] < 0) continue;
+        hud_slot_t* slot = &page->slots[s];
+        char name[32];
+        if (slot->kind == HUD_THREAD_UI) snprintf(name, sizeof(name), "ui");
+        else if (slot->kind == HUD_THREAD_GHOSTS && slot->count > 1)
+            snprintf(name, sizeof(name), "g%d-%d", slot->index, slot->index + slot->count - 1);
+        else snprintf(name, sizeof(name), "%s%d", kind_names[slot->kind], slot->index);
+
+        char entry[48];
+        int n = snprintf(entry, sizeof(entry), " %s %.1f%%", name, cpu[s]);
+        if (col + n > width || (lines == max_lines && col + n + 6 > width)) {
+            if (lines == max_lines) {
+                append(buf, size, &len, " +%d", active - shown);
+                return;
+            }
+            append(buf, size, &len, "\nCPU:");
+            col = 4;
+            lines++;
+        }
+        append(buf, size, &len, "%s", entry);
+        col += n;
+        shown++;
+    }
+    // Threads sem slot não têm CPU: só contam
+    if (shown < active) {
+        if (col + 6 > width && lines < max_lines) append(buf, size, &len, "\nCPU:");
+        append(buf, size, &len, " +%d", active - shown);
+    }
+}
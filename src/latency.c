@@ -0,0 +1,83 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+#include "latency.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <sys/mman.h>
+
+static const char* const category_names[N_LAT_CATEGORIES] = {
+    [LAT_MOVE_PACMAN] = "move_pacman",
+    [LAT_MOVE_GHOST] = "move_ghost",
+    [LAT_SLEEP_OVERSHOOT] = "sleep_overshoot",
+    [LAT_FRAME] = "frame",
+    [LAT_KEY_TO_SCREEN] = "key_to_screen",
+};
+
+static hdr_histogram_t* hists; // N_LAT_CATEGORIES, em memória partilhada
+
+int latency_init(void) {
+    if (hists) return 0;
+    void* mem = mmap(NULL, sizeof(hdr_histogram_t) * N_LAT_CATEGORIES, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("latency: mmap");
+        return -1;
+    }
+    hists = mem; // mmap anónimo já vem a zeros
+    return 0;
+}
+
+void latency_close(void) {
+    if (!hists) return;
+    munmap(hists, sizeof(hdr_histogram_t) * N_LAT_CATEGORIES);
+    hists = NULL;
+}
+
+int latency_enabled(void) {
+    return hists != NULL;
+}
+
+void latency_record(latency_category_t category, uint64_t ns) {
+    if (hists) hdr_record(&hists[category], ns);
+}
+
+// Escreve uma string JSON entre aspas (escapa ", \ e caracteres de controlo)
+static void write_json_string(FILE* out, const char* value) {
+    fputc('"', out);
+    for (const unsigned char* c = (const unsigned char*)value; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+        else if (*c < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+int latency_report(const char* path, const char* dir, const char* render) {
+    if (!hists) return 0;
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+
+    fputs("{\n  \"dir\": ", out);
+    write_json_string(out, dir);
+    fputs(",\n  \"render\": ", out);
+    write_json_string(out, render);
+    fputs(",\n  \"latency\": {\n", out);
+    for (int c = 0; c < N_LAT_CATEGORIES; c++) {
+        const hdr_histogram_t* h = &hists[c];
+        uint64_t count = atomic_load(&h->count);
+        fprintf(out, "    \"%s\": {\"count\": %llu, \"mean_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, "
+                     "\"p99_ns\": %llu, \"max_ns\": %llu}%s\n",
+                category_names[c], (unsigned long long)count,
+                count ? (double)atomic_load(&h->sum) / count : 0.0,
+                (unsigned long long)hdr_percentile(h, 50),
+                (unsigned long long)hdr_percentile(h, 90),
+                (unsigned long long)hdr_percentile(h, 99),
+                (unsigned long long)atomic_load(&h->max),
+                (c + 1 < N_LAT_CATEGORIES) ? "," : "");
+    }
+    fprintf(out, "  }\n}\n");
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Gerador de níveis sintéticos (.lvl, .p, .m) no formato lido por load_level.
+// Serve para reproduzir tabuleiros grandes com muitos agentes (testes de carga e bench).
+
+#define MON_PER_LINE 16
+
+typedef struct {
+    const char* out_dir;
+    const char* name;
+    int height, width;
+    double wall_density;  // fração das células interiores que são parede
+    double dot_fraction;  // fração das células livres com ponto
+    int portals;
+    int ghosts;
+    int scripts;          // 0 = um .m por monstro; k = monstros partilham k scripts
+    int script_len;
+    int weight_move, weight_random, weight_charge, weight_wait, weight_hunt;
+    int passo;
+    int tempo;
+    int levels;
+    unsigned long long seed;
+} gen_opts_t;
+
+// xorshift64*: reprodutível para a mesma seed, independente do rand() da libc
+static unsigned long long rng_state;
+
+static unsigned long long rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ull;
+}
+
+static int rng_range(int n) {
+    return (int)(rng_next() % (unsigned long long)n);
+}
+
+static double rng_unit(void) {
+    return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static FILE* open_out(const gen_opts_t* o, const char* file) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", o->out_dir, file);
+    FILE* f = fopen(path, "w");
+    if (!f) perror(path);
+    return f;
+}
+
+// Escolhe uma célula livre ainda não ocupada por outro agente
+static int take_free_cell(char* map, int* free_cells, int* n_free, const gen_opts_t* o, int* y, int* x) {
+    while (*n_free > 0) {
+        int k = rng_range(*n_free);
+        int idx = free_cells[k];
+        free_cells[k] = free_cells[--(*n_free)];
+        if (map[idx] != '@') {
+            *y = idx / o->width;
+            *x = idx % o->width;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void write_script(FILE* f, const gen_opts_t* o, int is_pacman) {
+    const char dirs[] = "WASD";
+    int total = o->weight_move + o->weight_random + o->weight_wait
+              + (is_pacman ? 0 : o->weight_charge + o->weight_hunt);
+    if (total <= 0) total = 1;
+
+    for (int i = 0; i < o->script_len; i++) {
+        int r = rng_range(total);
+        if ((r -= o->weight_move) < 0) {
+            fprintf(f, "%c\n", dirs[rng_range(4)]);
+        } else if ((r -= o->weight_random) < 0) {
+            fprintf(f, "R\n");
+        } else if ((r -= o->weight_wait) < 0) {
+            fprintf(f, "T %d\n", 1 + rng_range(5));
+        } else if ((r -= o->weight_hunt) < 0) {
+            fprintf(f, "H\n");
+        } else {
+            // Carregar e disparar na mesma direção
+            fprintf(f, "C\n%c\n", dirs[rng_range(4)]);
+            i++;
+        }
+    }
+}
+
+static int generate_level(const gen_opts_t* o, int level) {
+    char base[256];
+    if (o->levels > 1) snprintf(base, sizeof(base), "%s_%03d", o->name, level);
+    else snprintf(base, sizeof(base), "%s", o->name);
+
+    size_t cells = (size_t)o->height * o->width;
+    char* map = malloc(cells);
+    int* free_cells = malloc(sizeof(int) * cells);
+    if (!map || !free_cells) { free(map); free(free_cells); return -1; }
+
+    int n_free = 0;
+    for (int y = 0; y < o->height; y++) {
+        for (int x = 0; x < o->width; x++) {
+            size_t idx = (size_t)y * o->width + x;
+            int border = (y == 0 || x == 0 || y == o->height - 1 || x == o->width - 1);
+            if (border || rng_unit() < o->wall_density) {
+                map[idx] = 'X';
+            } else {
+                map[idx] = (rng_unit() < o->dot_fraction) ? 'o' : ' ';
+                free_cells[n_free++] = (int)idx;
+            }
+        }
+    }
+
+    for (int p = 0; p < o->portals && n_free > 0; p++) {
+        map[free_cells[rng_range(n_free)]] = '@';
+    }
+
+    // --- .lvl ---
+    char file[300];
+    snprintf(file, sizeof(file), "%s.lvl", base);
+    FILE* lvl = open_out(o, file);
+    if (!lvl) { free(map); free(free_cells); return -1; }
+
+    fprintf(lvl, "#DIM: linhas colunas\nDIM %d %d\n", o->height, o->width);
+    fprintf(lvl, "#TEMPO: ms por jogada\nTEMPO %d\n", o->tempo);
+    fprintf(lvl, "#PAC: ficheiro do pacman\nPAC %s.p\n", base);
+    fprintf(lvl, "#MON: ficheiros dos monstros\n");
+    int n_scripts = (o->scripts > 0) ? o->scripts : o->ghosts;
+    for (int g = 0; g < o->ghosts; g++) {
+        if (g % MON_PER_LINE == 0) fprintf(lvl, "%sMON", g ? "\n" : "");
+        fprintf(lvl, " %s_%d.m", base, g % n_scripts);
+    }
+    if (o->ghosts > 0) fprintf(lvl, "\n");
+    for (int y = 0; y < o->height; y++) {
+        fwrite(map + (size_t)y * o->width, 1, o->width, lvl);
+        fputc('\n', lvl);
+    }
+    fclose(lvl);
+
+    // --- .p ---
+    int y, x;
+    snprintf(file, sizeof(file), "%s.p", base);
+    FILE* pac = open_out(o, file);
+    if (!pac) { free(map); free(free_cells); return -1; }
+    if (take_free_cell(map, free_cells, &n_free, o, &y, &x) != 0) { y = 1; x = 1; }
+    fprintf(pac, "PASSO %d\nPOS %d %d\n", o->passo, y, x);
+    write_script(pac, o, 1);
+    fclose(pac);
+
+    // --- .m ---
+    for (int g = 0; g < n_scripts && g < o->ghosts; g++) {
+        snprintf(file, sizeof(file), "%s_%d.m", base, g);
+        FILE* mon = open_out(o, file);
+        if (!mon) { free(map); free(free_cells); return -1; }
+        if (take_free_cell(map, free_cells, &n_free, o, &y, &x) != 0) { y = 1; x = 1; }
+        fprintf(mon, "PASSO %d\nPOS %d %d\n", o->passo, y, x);
+        write_script(mon, o, 0);
+        fclose(mon);
+    }
+
+    free(map);
+    free(free_cells);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s -o <dir> [options]\n"
+        "  -n name      prefixo dos ficheiros (default: gen)\n"
+        "  -H rows      linhas (default: 20)\n"
+        "  -W cols      colunas (default: 40)\n"
+        "  -w density   fração de paredes interiores, 0..1 (default: 0.15)\n"
+        "  -d fraction  fração de células livres com ponto, 0..1 (default: 0.8)\n"
+        "  -p portals   número de portais (default: 1)\n"
+        "  -g ghosts    número de monstros (default: 4)\n"
+        "  -k scripts   monstros partilham k ficheiros .m, e nascem à volta do POS de cada um\n"
+        "               (default: um por monstro)\n"
+        "  -l length    comandos por script (default: 50)\n"
+        "  -m mix       pesos move,R,C,T[,H] (default: 70,15,10,5,0)\n"
+        "  -P passo     PASSO dos agentes (default: 0)\n"
+        "  -t tempo     TEMPO do nível em ms (default: 200)\n"
+        "  -L levels    número de níveis a gerar (default: 1)\n"
+        "  -s seed      seed do gerador (default: 1)\n", prog);
+}
+
+int main(int argc, char** argv) {
+    gen_opts_t o = {
+        .out_dir = NULL, .name = "gen",
+        .height = 20, .width = 40,
+        .wall_density = 0.15, .dot_fraction = 0.8,
+        .portals = 1, .ghosts = 4, .scripts = 0, .script_len = 50,
+        .weight_move = 70, .weight_random = 15, .weight_charge = 10, .weight_wait = 5, .weight_hunt = 0,
+        .passo = 0, .tempo = 200, .levels = 1, .seed = 1,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:n:H:W:w:d:p:g:k:l:m:P:t:L:s:h")) != -1) {
+        switch (opt) {
+            case 'o': o.out_dir = optarg; break;
+            case 'n': o.name = optarg; break;
+            case 'H': o.height = atoi(optarg); break;
+            case 'W': o.width = atoi(optarg); break;
+            case 'w': o.wall_density = atof(optarg); break;
+            case 'd': o.dot_fraction = atof(optarg); break;
+            case 'p': o.portals = atoi(optarg); break;
+            case 'g': o.ghosts = atoi(optarg); break;
+            case 'k': o.scripts = atoi(optarg); break;
+            case 'l': o.script_len = atoi(optarg); break;
+            case 'm':
+                if (sscanf(optarg, "%d,%d,%d,%d,%d", &o.weight_move, &o.weight_random,
+                           &o.weight_charge, &o.weight_wait, &o.weight_hunt) < 4) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'P': o.passo = atoi(optarg); break;
+            case 't': o.tempo = atoi(optarg); break;
+            case 'L': o.levels = atoi(optarg); break;
+            case 's': o.seed = strtoull(optarg, NULL, 10); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+
+    if (!o.out_dir || o.height < 3 || o.width < 3 || o.ghosts < 0 || o.levels < 1 || o.script_len < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    mkdir(o.out_dir, 0755);
+    rng_state = o.seed ? o.seed : 1;
+
+    for (int l = 0; l < o.levels; l++) {
+        if (generate_level(&o, l) != 0) return 1;
+    }
+    return 0;
+}
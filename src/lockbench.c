@@ -0,0 +1,167 @@
+#include "spinlock.h"
+#include "histogram.h"
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Benchmark dos row locks: pthread_mutex_t (o default) contra o spin_lock_t
+// adaptativo, de 1 a 64 threads. Cada operação é o que uma jogada faz com a
+// linha trancada (ler e escrever duas células). Layouts:
+//   row       todas as threads na mesma linha (contenção máxima)
+//   adjacent  cada thread na sua linha, com as linhas seguidas em memória
+//             como em board->row_locks (mostra o false sharing dos mutexes)
+
+#define DEFAULT_OPS 200000
+#define DEFAULT_MAX_THREADS 64
+#define ROW_CELLS 64
+
+typedef enum { LOCK_MUTEX, LOCK_SPIN } lock_kind_t;
+static const char* const kind_names[] = { "mutex", "spin" };
+
+typedef struct {
+    int kind;
+    int adjacent;
+    int n_threads;
+    long ops;
+    int work;              // Pausas fora do lock entre operações (o "sleep" de um agente)
+    pthread_mutex_t* mutexes;
+    spin_lock_t* spins;
+    char (*cells)[ROW_CELLS]; // Uma linha de células por lock
+    pthread_barrier_t start;
+    hdr_histogram_t wait;  // ns até obter o lock (os das threads, somados depois do join)
+} lock_bench_t;
+
+typedef struct {
+    lock_bench_t* bench;
+    int id;
+    // Histograma só desta thread, registado já fora do lock: um partilhado punha
+    // RMWs contendidos dentro da secção crítica e o seu true sharing escondia o
+    // false sharing do layout adjacent
+    alignas(64) hdr_histogram_t wait;
+} worker_arg_t;
+
+static void* worker(void* arg) {
+    worker_arg_t* w = arg;
+    lock_bench_t* b = w->bench;
+    int row = b->adjacent ? w->id : 0;
+    int x = (w->id * 2) % (ROW_CELLS - 1);
+    volatile int sink = 0;
+
+    pthread_barrier_wait(&b->start);
+    for (long i = 0; i < b->ops; i++) {
+        uint64_t t0 = now_ns();
+        if (b->kind == LOCK_SPIN) spin_lock(&b->spins[row]);
+        else pthread_mutex_lock(&b->mutexes[row]);
+        uint64_t waited = now_ns() - t0;
+
+        // Secção crítica de uma jogada: célula antiga e célula nova
+        char* cells = b->cells[row];
+        char old = cells[x];
+        cells[x] = cells[x + 1];
+        cells[x + 1] = old;
+
+        if (b->kind == LOCK_SPIN) spin_unlock(&b->spins[row]);
+        else pthread_mutex_unlock(&b->mutexes[row]);
+        hdr_record(&w->wait, waited);
+
+        for (int k = 0; k < b->work; k++) sink += k;
+    }
+    (void)sink;
+    return NULL;
+}
+
+static void run_case(int kind, int adjacent, int n_threads, long ops, int work) {
+    int n_rows = adjacent ? n_threads : 1;
+    lock_bench_t* b = calloc(1, sizeof(lock_bench_t));
+    b->kind = kind;
+    b->adjacent = adjacent;
+    b->n_threads = n_threads;
+    b->ops = ops;
+    b->work = work;
+    b->mutexes = malloc(sizeof(pthread_mutex_t) * n_rows);
+    b->spins = aligned_alloc(SPIN_CACHE_LINE, sizeof(spin_lock_t) * n_rows);
+    b->cells = calloc(n_rows, ROW_CELLS);
+    for (int r = 0; r < n_rows; r++) {
+        pthread_mutex_init(&b->mutexes[r], NULL);
+        spin_lock_init(&b->spins[r]);
+    }
+    pthread_barrier_init(&b->start, NULL, n_threads + 1);
+
+    pthread_t* threads = malloc(sizeof(pthread_t) * n_threads);
+    worker_arg_t* args = aligned_alloc(alignof(worker_arg_t), sizeof(worker_arg_t) * n_threads);
+    for (int t = 0; t < n_threads; t++) {
+        memset(&args[t], 0, sizeof(worker_arg_t));
+        args[t].bench = b;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    pthread_barrier_wait(&b->start);
+    uint64_t start = now_ns();
+    for (int t = 0; t < n_threads; t++) pthread_join(threads[t], NULL);
+    uint64_t elapsed = now_ns() - start;
+    for (int t = 0; t < n_threads; t++) hdr_merge(&b->wait, &args[t].wait);
+
+    uint64_t total_ops = (uint64_t)ops * n_threads;
+    double ns_per_op = (double)elapsed / total_ops;
+    printf("{\"bench\":\"row_lock\",\"lock\":\"%s\",\"layout\":\"%s\",\"threads\":%d,\"ops\":%llu,"
+           "\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f,\"wait_p50_ns\":%llu,\"wait_p99_ns\":%llu,\"wait_max_ns\":%llu}\n",
+           kind_names[kind], adjacent ? "adjacent" : "row", n_threads, (unsigned long long)total_ops,
+           ns_per_op, ns_per_op > 0 ? 1e9 / ns_per_op : 0.0,
+           (unsigned long long)hdr_percentile(&b->wait, 50),
+           (unsigned long long)hdr_percentile(&b->wait, 99),
+           (unsigned long long)atomic_load(&b->wait.max));
+    fflush(stdout);
+
+    for (int r = 0; r < n_rows; r++) pthread_mutex_destroy(&b->mutexes[r]);
+    pthread_barrier_destroy(&b->start);
+    free(threads);
+    free(args);
+    free(b->mutexes);
+    free(b->spins);
+    free(b->cells);
+    free(b);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [-t max_threads] [-n ops] [-w work] [-l mutex|spin] [-L row|adjacent]\n"
+        "  -t  número máximo de threads (1, 2, 4, ... até este valor; default %d)\n"
+        "  -n  operações por thread (default %d)\n"
+        "  -w  iterações de trabalho fora do lock entre operações (default 0)\n",
+        prog, DEFAULT_MAX_THREADS, DEFAULT_OPS);
+}
+
+int main(int argc, char** argv) {
+    int max_threads = DEFAULT_MAX_THREADS;
+    long ops = DEFAULT_OPS;
+    int work = 0;
+    const char* only_lock = NULL;
+    const char* only_layout = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "t:n:w:l:L:h")) != -1) {
+        switch (opt) {
+            case 't': max_threads = atoi(optarg); break;
+            case 'n': ops = atol(optarg); break;
+            case 'w': work = atoi(optarg); break;
+            case 'l': only_lock = optarg; break;
+            case 'L': only_layout = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (max_threads < 1 || ops < 1) { usage(argv[0]); return 1; }
+
+    for (int adjacent = 0; adjacent <= 1; adjacent++) {
+        if (only_layout && strcmp(only_layout, adjacent ? "adjacent" : "row") != 0) continue;
+        for (int n = 1; n <= max_threads; n *= 2) {
+            for (int kind = LOCK_MUTEX; kind <= LOCK_SPIN; kind++) {
+                if (only_lock && strcmp(only_lock, kind_names[kind]) != 0) continue;
+                run_case(kind, adjacent, n, ops, work);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "metrics.h"
+#include "hud.h"
+#include "board.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define REQUEST_MAX 4096
+#define REQUEST_TIMEOUT_MS 1000
+
+struct metrics_server {
+    int listen_fd;
+    int stop_fd[2];       // Pipe para acordar a thread no metrics_stop
+    pthread_t thread;
+    pid_t owner;          // Processo que tem a thread (o filho de um fork não a tem)
+    char path[108];       // Socket UNIX a apagar no fim ("" = TCP)
+};
+
+static const char* const kind_labels[N_HUD_KINDS] = { "ui", "pacman", "ghost" };
+
+// Escapa um valor de label (\, " e mudança de linha)
+static void write_label(FILE* out, const char* value) {
+    for (const char* c = value; *c; c++) {
+        if (*c == '\\' || *c == '"') fputc('\\', out);
+        if (*c == '\n') fputs("\\n", out);
+        else fputc(*c, out);
+    }
+}
+
+static void write_header(FILE* out, const char* name, const char* type, const char* help) {
+    fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+int metrics_write(FILE* out) {
+    hud_totals_t t;
+    if (hud_totals(&t) != 0) return -1;
+
+    write_header(out, "pacmanist_moves_total", "counter", "Moves made, by agent type.");
+    for (int k = HUD_THREAD_PACMAN; k < N_HUD_KINDS; k++) {
+        fprintf(out, "pacmanist_moves_total{agent=\"%s\"} %lu\n", kind_labels[k], t.moves[k]);
+    }
+    write_header(out, "pacmanist_invalid_moves_total", "counter", "Moves rejected by the board (walls, edges, bad commands), by agent type.");
+    for (int k = HUD_THREAD_PACMAN; k < N_HUD_KINDS; k++) {
+        fprintf(out, "pacmanist_invalid_moves_total{agent=\"%s\"} %lu\n", kind_labels[k], t.invalid_moves[k]);
+    }
+    write_header(out, "pacmanist_move_seconds_total", "counter", "Time spent inside moves, by agent type.");
+    for (int k = HUD_THREAD_PACMAN; k < N_HUD_KINDS; k++) {
+        fprintf(out, "pacmanist_move_seconds_total{agent=\"%s\"} %.9f\n", kind_labels[k], t.move_ns[k] / 1e9);
+    }
+    write_header(out, "pacmanist_deaths_total", "counter", "Pacmans killed.");
+    fprintf(out, "pacmanist_deaths_total %lu\n", t.counts[HUD_DEATHS]);
+    write_header(out, "pacmanist_dots_eaten_total", "counter", "Dots eaten by pacmans.");
+    fprintf(out, "pacmanist_dots_eaten_total %lu\n", t.counts[HUD_DOTS]);
+    write_header(out, "pacmanist_lock_waits_total", "counter", "Row lock acquisitions that found the lock busy.");
+    fprintf(out, "pacmanist_lock_waits_total %lu\n", t.lock_waits);
+    write_header(out, "pacmanist_lock_wait_seconds_total", "counter", "Time spent waiting for busy row locks.");
+    fprintf(out, "pacmanist_lock_wait_seconds_total %.9f\n", t.lock_wait_ns / 1e9);
+    write_header(out, "pacmanist_frames_total", "counter", "Frames rendered by the UI.");
+    fprintf(out, "pacmanist_frames_total %lu\n", t.frames);
+    write_header(out, "pacmanist_save_seconds", "summary", "Quicksaves: from the request until the child is playing.");
+    fprintf(out, "pacmanist_save_seconds_sum %.9f\npacmanist_save_seconds_count %lu\n",
+            t.counts[HUD_SAVE_NS] / 1e9, t.counts[HUD_SAVES]);
+    write_header(out, "pacmanist_restore_seconds", "summary", "Restores: from the quicksave child exiting until the parent is playing.");
+    fprintf(out, "pacmanist_restore_seconds_sum %.9f\npacmanist_restore_seconds_count %lu\n",
+            t.counts[HUD_RESTORE_NS] / 1e9, t.counts[HUD_RESTORES]);
+    write_header(out, "pacmanist_threads", "gauge", "Game threads and worker groups currently running.");
+    fprintf(out, "pacmanist_threads %d\n", t.threads);
+    write_header(out, "pacmanist_level", "gauge", "Index of the current level in the level directory (-1 before the first).");
+    fprintf(out, "pacmanist_level %d\n", t.level_index);
+    write_header(out, "pacmanist_level_info", "gauge", "Name of the current level.");
+    fputs("pacmanist_level_info{name=\"", out);
+    write_label(out, t.level);
+    fputs("\"} 1\n", out);
+    return 0;
+}
+
+static void send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL); // Cliente que fecha cedo: EPIPE, não SIGPIPE
+        if (n <= 0) return;
+        data += n;
+        len -= n;
+    }
+}
+
+// Lê o pedido até à linha em branco (ou ao limite) e responde com uma só resposta HTTP/1.0
+static void serve_client(int fd) {
+    char request[REQUEST_MAX + 1];
+    size_t len = 0;
+    while (len < REQUEST_MAX) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, REQUEST_TIMEOUT_MS) <= 0) break;
+        ssize_t n = read(fd, request + len, REQUEST_MAX - len);
+        if (n <= 0) break;
+        len += n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[len] = '\0';
+
+    char path[256] = "";
+    int is_get = sscanf(request, "GET %255s", path) == 1;
+    char* query = strchr(path, '?');
+    if (query) *query = '\0';
+
+    char* body = NULL;
+    size_t body_len = 0;
+    FILE* out = open_memstream(&body, &body_len);
+    if (!out) return;
+    const char* status = "200 OK";
+    if (!is_get) {
+        status = "405 Method Not Allowed";
+        fputs("Only GET /metrics\n", out);
+    }
+    else if (strcmp(path, "/metrics") != 0 && strcmp(path, "/") != 0) {
+        status = "404 Not Found";
+        fputs("Only GET /metrics\n", out);
+    }
+    else if (metrics_write(out) != 0) {
+        status = "503 Service Unavailable";
+        fputs("No counters\n", out);
+    }
+    fclose(out);
+
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: %zu\r\nConnection: close\r\n\r\n", status, body_len);
+    send_all(fd, header, header_len);
+    send_all(fd, body, body_len);
+    free(body);
+}
+
+static void* server_thread(void* arg) {
+    metrics_server_t* server = arg;
+    for (;;) {
+        struct pollfd fds[2] = {
+            { .fd = server->listen_fd, .events = POLLIN },
+            { .fd = server->stop_fd[0], .events = POLLIN },
+        };
+        if (poll(fds, 2, -1) < 0) continue; // EINTR
+        if (fds[1].revents) break;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        serve_client(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+static int listen_unix(const char* path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "metrics: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Só se apaga um socket (de uma corrida anterior): um engano no caminho não pode apagar um ficheiro
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "metrics: %s exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { perror("metrics: socket"); return -1; }
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(int port) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Só local
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { perror("metrics: socket"); return -1; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 8) != 0) {
+        perror("metrics: bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+metrics_server_t* metrics_start(const char* where) {
+    int is_port = *where != '\0';
+    for (const char* c = where; *c; c++) is_port = is_port && isdigit((unsigned char)*c);
+    if (is_port && (atoi(where) < 1 || atoi(where) > 65535)) {
+        fprintf(stderr, "metrics: bad port %s\n", where);
+        return NULL;
+    }
+
+    metrics_server_t* server = calloc(1, sizeof(metrics_server_t));
+    if (!server) return NULL;
+    server->listen_fd = is_port ? listen_tcp(atoi(where)) : listen_unix(where);
+    if (server->listen_fd < 0) {
+        free(server);
+        return NULL;
+    }
+    if (!is_port) snprintf(server->path, sizeof(server->path), "%s", where);
+
+    int piped = pipe(server->stop_fd) == 0;
+    if (!piped || pthread_create(&server->thread, NULL, server_thread, server) != 0) {
+        perror("metrics");
+        if (piped) {
+            close(server->stop_fd[0]);
+            close(server->stop_fd[1]);
+        }
+        close(server->listen_fd);
+        if (server->path[0]) unlink(server->path);
+        free(server);
+        return NULL;
+    }
+    server->owner = getpid();
+    return server;
+}
+
+void metrics_stop(metrics_server_t* server) {
+    if (!server) return;
+    if (server->owner == getpid()) {
+        if (write(server->stop_fd[1], "x", 1) < 0) debug("[METRICS] stop: write failed\n");
+        pthread_join(server->thread, NULL);
+        if (server->path[0]) unlink(server->path);
+    }
+    close(server->listen_fd);
+    close(server->stop_fd[0]);
+    close(server->stop_fd[1]);
+    free(server);
+}
@@ -0,0 +1,191 @@
+#include "pacmanist.h"
+#include "sim.h"
+#include "chase.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct pacmanist {
+    board_t board;
+    long tick;
+    unsigned int seed; // 'R' com rand_r (board.rand_seed aponta para aqui)
+    char* commands;   // Jogadas do próximo tick, uma por pacman ('\0' = script)
+    int has_commands;
+};
+
+struct pacmanist_snapshot {
+    const pacmanist_t* owner;
+    long tick;
+    unsigned int seed;
+    int game_running, exit_status;
+    pacman_t* pacmans;
+    ghost_t* ghosts;
+    board_pos_t* cells; // Denso: o mapa todo; chunks: os tiles alocados, pela ordem de board->chunks->tiles
+    long n_cells;
+};
+
+static pacmanist_t* pacmanist_ready(pacmanist_t* game) {
+    board_t* board = &game->board;
+    game->commands = calloc(board->n_pacmans, 1);
+    game->seed = 1; // Como o rand() sem srand
+    board->rand_seed = &game->seed;
+    // Uma só thread joga neste tabuleiro: as jogadas não precisam dos row locks
+    board->rows_owned = 1;
+    return game;
+}
+
+pacmanist_t* pacmanist_open(const char* dir_path, const char* level_file) {
+    pacmanist_t* game = calloc(1, sizeof(pacmanist_t));
+    if (!game) return NULL;
+    if (load_level(&game->board, dir_path, level_file, NULL, 0) != 0) {
+        free(game);
+        return NULL;
+    }
+    return pacmanist_ready(game);
+}
+
+pacmanist_t* pacmanist_open_memory(const char* level_text, const pacmanist_file_t* files, int n_files) {
+    pacmanist_t* game = calloc(1, sizeof(pacmanist_t));
+    if (!game) return NULL;
+    if (load_level_memory(&game->board, "memory", level_text, files, n_files, NULL, 0) != 0) {
+        free(game);
+        return NULL;
+    }
+    return pacmanist_ready(game);
+}
+
+void pacmanist_close(pacmanist_t* game) {
+    if (!game) return;
+    unload_level(&game->board);
+    free(game->commands);
+    free(game);
+}
+
+void pacmanist_seed(pacmanist_t* game, unsigned int seed) {
+    game->seed = seed;
+}
+
+int pacmanist_command(pacmanist_t* game, int pacman, char command) {
+    if (pacman < 0 || pacman >= game->board.n_pacmans) return -1;
+    if (command != '\0' && !strchr("WASDRTQ", command)) return -1;
+    game->commands[pacman] = command;
+    game->has_commands = 0;
+    for (int p = 0; p < game->board.n_pacmans; p++) game->has_commands |= (game->commands[p] != '\0');
+    return 0;
+}
+
+long pacmanist_step(pacmanist_t* game, long n_ticks) {
+    board_t* board = &game->board;
+    long ticks = 0;
+    if (n_ticks > 0 && board->game_running && game->has_commands) {
+        sim_step_with(board, game->commands);
+        memset(game->commands, 0, board->n_pacmans);
+        game->has_commands = 0;
+        ticks++;
+    }
+    while (ticks < n_ticks && board->game_running) {
+        sim_step(board);
+        ticks++;
+    }
+    game->tick += ticks;
+    return ticks;
+}
+
+int pacmanist_status(const pacmanist_t* game) {
+    return game->board.game_running ? 0 : game->board.exit_status;
+}
+
+long pacmanist_tick(const pacmanist_t* game) {
+    return game->tick;
+}
+
+const board_t* pacmanist_board(const pacmanist_t* game) {
+    return &game->board;
+}
+
+char pacmanist_cell(const pacmanist_t* game, int x, int y) {
+    const board_t* board = &game->board;
+    if (x < 0 || x >= board->width || y < 0 || y >= board->height) return '\0';
+    const board_pos_t* cell = board_cell(board, x, y);
+    if (cell->content == 'W') return 'X';
+    if (cell->content == 'P' || cell->content == 'M') return cell->content;
+    return cell->has_portal ? '@' : cell->has_dot ? 'o' : ' ';
+}
+
+// Os tiles alocados não mudam depois do load (nenhum agente entra numa parede),
+// por isso a mesma ordem serve para copiar e para repor
+static long snapshot_cells(const board_t* board, board_pos_t* out, int restore) {
+    if (board->board) {
+        long n = (long)board->width * board->height;
+        if (out) {
+            if (restore) memcpy(board->board, out, sizeof(board_pos_t) * n);
+            else memcpy(out, board->board, sizeof(board_pos_t) * n);
+        }
+        return n;
+    }
+
+    const long tile_cells = BOARD_TILE * BOARD_TILE;
+    long n = 0;
+    long n_tiles = (long)board->chunks->tiles_w * board->chunks->tiles_h;
+    for (long t = 0; t < n_tiles; t++) {
+        board_pos_t* tile = board->chunks->tiles[t];
+        if (!tile) continue;
+        if (out) {
+            if (restore) memcpy(tile, out + n, sizeof(board_pos_t) * tile_cells);
+            else memcpy(out + n, tile, sizeof(board_pos_t) * tile_cells);
+        }
+        n += tile_cells;
+    }
+    return n;
+}
+
+pacmanist_snapshot_t* pacmanist_snapshot(pacmanist_t* game) {
+    board_t* board = &game->board;
+    pacmanist_snapshot_t* snap = calloc(1, sizeof(pacmanist_snapshot_t));
+    if (!snap) return NULL;
+    snap->owner = game;
+    snap->tick = game->tick;
+    snap->seed = game->seed;
+    snap->game_running = board->game_running;
+    snap->exit_status = board->exit_status;
+    snap->n_cells = snapshot_cells(board, NULL, 0);
+    snap->cells = malloc(sizeof(board_pos_t) * (snap->n_cells > 0 ? snap->n_cells : 1));
+    snap->pacmans = malloc(sizeof(pacman_t) * (board->n_pacmans > 0 ? board->n_pacmans : 1));
+    snap->ghosts = malloc(sizeof(ghost_t) * (board->n_ghosts > 0 ? board->n_ghosts : 1));
+    if (!snap->cells || !snap->pacmans || !snap->ghosts) {
+        pacmanist_snapshot_free(snap);
+        return NULL;
+    }
+    snapshot_cells(board, snap->cells, 0);
+    sim_sched_sync(board); // ghosts[].waiting com os ticks de espera já passados
+    // Os scripts são os mesmos enquanto a instância existir: basta copiar os ponteiros
+    memcpy(snap->pacmans, board->pacmans, sizeof(pacman_t) * board->n_pacmans);
+    memcpy(snap->ghosts, board->ghosts, sizeof(ghost_t) * board->n_ghosts);
+    return snap;
+}
+
+int pacmanist_restore(pacmanist_t* game, const pacmanist_snapshot_t* snap) {
+    board_t* board = &game->board;
+    if (!snap || snap->owner != game) return -1;
+
+    snapshot_cells(board, snap->cells, 1);
+    memcpy(board->pacmans, snap->pacmans, sizeof(pacman_t) * board->n_pacmans);
+    memcpy(board->ghosts, snap->ghosts, sizeof(ghost_t) * board->n_ghosts);
+    board->game_running = snap->game_running;
+    board->exit_status = snap->exit_status;
+    game->tick = snap->tick;
+    game->seed = snap->seed;
+    memset(game->commands, 0, board->n_pacmans);
+    game->has_commands = 0;
+
+    chase_invalidate(board); // Os pacmans podem estar noutras células
+    sim_sched_free(board);   // A agenda dos fantasmas era a do estado antigo
+    return 0;
+}
+
+void pacmanist_snapshot_free(pacmanist_snapshot_t* snap) {
+    if (!snap) return;
+    free(snap->cells);
+    free(snap->pacmans);
+    free(snap->ghosts);
+    free(snap);
+}
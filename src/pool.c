@@ -0,0 +1,334 @@
+#include "pool.h"
+#include "histogram.h"
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+typedef struct {
+    task_fn_t fn;
+    void* arg;
+} task_t;
+
+typedef struct {
+    uint64_t deadline;
+    task_t task;
+} timed_task_t;
+
+// Deque circular: o dono usa o fundo (bottom), os ladrões o topo (top).
+// Um mutex por deque chega: só há contenção quando alguém está a roubar.
+typedef struct {
+    pthread_mutex_t lock;
+    task_t* items;
+    int cap;
+    int top, bottom; // Índices crescentes; posição = índice % cap
+} deque_t;
+
+typedef struct {
+    pool_t* pool;
+    int id;
+    pthread_t thread;
+    deque_t deque;
+    unsigned int seed; // Escolha da vítima para roubar
+    uint64_t executed, stolen, timed;
+} worker_t;
+
+struct pool {
+    int n_workers;
+    worker_t* workers;
+
+    // Tarefas marcadas (min-heap por deadline) e sono dos workers
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    timed_task_t* heap;
+    int n_heap, heap_cap;
+    _Atomic uint64_t next_deadline; // UINT64_MAX = heap vazio
+
+    atomic_int queued;   // Tarefas nas deques
+    atomic_int pending;  // Tarefas por acabar (nas deques, a correr ou marcadas)
+    atomic_int sleeping;
+    atomic_uint next_external; // Round-robin das submissões de fora do pool
+    int stopping;
+};
+
+static _Thread_local worker_t* current_worker = NULL;
+
+// --- Deque ---
+
+static void deque_init(deque_t* d) {
+    pthread_mutex_init(&d->lock, NULL);
+    d->cap = 64;
+    d->items = malloc(sizeof(task_t) * d->cap);
+    d->top = d->bottom = 0;
+}
+
+static void deque_push(deque_t* d, task_t t) {
+    pthread_mutex_lock(&d->lock);
+    if (d->bottom - d->top == d->cap) {
+        task_t* items = malloc(sizeof(task_t) * d->cap * 2);
+        for (int i = d->top; i < d->bottom; i++) items[i % (d->cap * 2)] = d->items[i % d->cap];
+        free(d->items);
+        d->items = items;
+        d->cap *= 2;
+    }
+    d->items[d->bottom % d->cap] = t;
+    d->bottom++;
+    pthread_mutex_unlock(&d->lock);
+}
+
+// Dono: LIFO (a tarefa mais recente ainda tem os dados na cache)
+static int deque_pop(deque_t* d, task_t* t) {
+    pthread_mutex_lock(&d->lock);
+    int ok = d->bottom > d->top;
+    if (ok) *t = d->items[--d->bottom % d->cap];
+    if (d->top == d->bottom) d->top = d->bottom = 0; // Vazia: os índices não crescem para sempre
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+// Ladrão: FIFO (a tarefa mais antiga)
+static int deque_steal(deque_t* d, task_t* t) {
+    if (pthread_mutex_trylock(&d->lock) != 0) return 0; // Ocupada: tentar outra vítima
+    int ok = d->bottom > d->top;
+    if (ok) *t = d->items[d->top++ % d->cap];
+    if (d->top == d->bottom) d->top = d->bottom = 0;
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+// --- Heap de tarefas marcadas (com pool->lock) ---
+
+static void heap_push(pool_t* pool, timed_task_t tt) {
+    if (pool->n_heap == pool->heap_cap) {
+        pool->heap_cap = pool->heap_cap ? pool->heap_cap * 2 : 64;
+        pool->heap = realloc(pool->heap, sizeof(timed_task_t) * pool->heap_cap);
+    }
+    int i = pool->n_heap++;
+    while (i > 0 && pool->heap[(i - 1) / 2].deadline > tt.deadline) {
+        pool->heap[i] = pool->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    pool->heap[i] = tt;
+    atomic_store(&pool->next_deadline, pool->heap[0].deadline);
+}
+
+static timed_task_t heap_pop(pool_t* pool) {
+    timed_task_t top = pool->heap[0];
+    timed_task_t last = pool->heap[--pool->n_heap];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= pool->n_heap) break;
+        if (child + 1 < pool->n_heap && pool->heap[child + 1].deadline < pool->heap[child].deadline) child++;
+        if (pool->heap[child].deadline >= last.deadline) break;
+        pool->heap[i] = pool->heap[child];
+        i = child;
+    }
+    if (pool->n_heap > 0) pool->heap[i] = last;
+    atomic_store(&pool->next_deadline, pool->n_heap ? pool->heap[0].deadline : UINT64_MAX);
+    return top;
+}
+
+// --- Submissão ---
+
+static void wake_one(pool_t* pool) {
+    if (atomic_load(&pool->sleeping) == 0) return;
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// 'queued' sobe antes do push e só desce depois do pop: nunca fica abaixo
+// do número real de tarefas nas deques (um worker não adormece com trabalho)
+static void enqueue(pool_t* pool, worker_t* w, task_t t) {
+    atomic_fetch_add(&pool->queued, 1);
+    deque_push(&w->deque, t);
+    wake_one(pool);
+}
+
+void pool_submit(pool_t* pool, task_fn_t fn, void* arg) {
+    task_t t = { fn, arg };
+    atomic_fetch_add(&pool->pending, 1);
+
+    worker_t* w = current_worker;
+    if (!w || w->pool != pool) {
+        w = &pool->workers[atomic_fetch_add(&pool->next_external, 1) % pool->n_workers];
+    }
+    enqueue(pool, w, t);
+}
+
+void pool_submit_at(pool_t* pool, uint64_t deadline, task_fn_t fn, void* arg) {
+    timed_task_t tt = { deadline, { fn, arg } };
+    atomic_fetch_add(&pool->pending, 1);
+
+    pthread_mutex_lock(&pool->lock);
+    int earliest = (pool->n_heap == 0 || deadline < pool->heap[0].deadline);
+    heap_push(pool, tt);
+    // Um worker a dormir pode estar à espera de um deadline mais tarde
+    if (earliest) pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Passa as tarefas marcadas que já venceram para a deque do worker
+static int release_due(pool_t* pool, worker_t* w, uint64_t now) {
+    int moved = 0;
+    while (pool->n_heap > 0 && pool->heap[0].deadline <= now) {
+        timed_task_t tt = heap_pop(pool);
+        atomic_fetch_add(&pool->queued, 1);
+        deque_push(&w->deque, tt.task);
+        w->timed++;
+        moved++;
+    }
+    if (moved > 1) pthread_cond_broadcast(&pool->wake); // Há trabalho para os outros roubarem
+    return moved;
+}
+
+// --- Workers ---
+
+static int find_task(worker_t* w, task_t* t) {
+    pool_t* pool = w->pool;
+    if (deque_pop(&w->deque, t)) return 1;
+
+    // Roubar: começar numa vítima aleatória para espalhar a contenção
+    int start = rand_r(&w->seed) % pool->n_workers;
+    for (int i = 0; i < pool->n_workers; i++) {
+        worker_t* victim = &pool->workers[(start + i) % pool->n_workers];
+        if (victim == w) continue;
+        if (deque_steal(&victim->deque, t)) {
+            w->stolen++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void finish_task(pool_t* pool) {
+    if (atomic_fetch_sub(&pool->pending, 1) == 1) {
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_broadcast(&pool->idle);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker_t* w = arg;
+    pool_t* pool = w->pool;
+    current_worker = w;
+
+    for (;;) {
+        // Tarefas marcadas vencidas têm prioridade sobre o sono, mesmo com o pool ocupado
+        if (atomic_load(&pool->next_deadline) <= now_ns()) {
+            pthread_mutex_lock(&pool->lock);
+            release_due(pool, w, now_ns());
+            pthread_mutex_unlock(&pool->lock);
+        }
+
+        task_t t;
+        if (find_task(w, &t)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            t.fn(t.arg);
+            w->executed++;
+            finish_task(pool);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        if (release_due(pool, w, now_ns()) > 0) {
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+
+        // Contar como adormecido antes de olhar para 'queued': quem submete
+        // incrementa 'queued' antes de olhar para 'sleeping' (não se perde o sinal)
+        atomic_fetch_add(&pool->sleeping, 1);
+        if (atomic_load(&pool->queued) == 0) {
+            if (pool->n_heap > 0) {
+                // now_ns() e o timedwait usam ambos CLOCK_MONOTONIC
+                uint64_t deadline = pool->heap[0].deadline;
+                struct timespec ts = { (time_t)(deadline / 1000000000ull), (long)(deadline % 1000000000ull) };
+                pthread_cond_timedwait(&pool->wake, &pool->lock, &ts);
+            } else {
+                pthread_cond_wait(&pool->wake, &pool->lock);
+            }
+        }
+        atomic_fetch_sub(&pool->sleeping, 1);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+pool_t* pool_create(int n_workers) {
+    if (n_workers <= 0) {
+        long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+        n_workers = (nproc > 0) ? (int)nproc : 1;
+    }
+
+    pool_t* pool = calloc(1, sizeof(pool_t));
+    pool->n_workers = n_workers;
+    pool->workers = calloc(n_workers, sizeof(worker_t));
+    pthread_mutex_init(&pool->lock, NULL);
+
+    // O timedwait usa CLOCK_MONOTONIC, o mesmo relógio do now_ns() dos deadlines
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&pool->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&pool->idle, NULL);
+    atomic_store(&pool->next_deadline, UINT64_MAX);
+
+    for (int i = 0; i < n_workers; i++) {
+        worker_t* w = &pool->workers[i];
+        w->pool = pool;
+        w->id = i;
+        w->seed = 0x9e3779b9u * (i + 1);
+        deque_init(&w->deque);
+    }
+    for (int i = 0; i < n_workers; i++) {
+        pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]);
+    }
+    return pool;
+}
+
+void pool_wait(pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->pending) > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_destroy(pool_t* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->n_workers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+        pthread_mutex_destroy(&pool->workers[i].deque.lock);
+        free(pool->workers[i].deque.items);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->heap);
+    free(pool->workers);
+    free(pool);
+}
+
+void pool_get_stats(pool_t* pool, pool_stats_t* stats) {
+    stats->workers = pool->n_workers;
+    stats->executed = stats->stolen = stats->timed = 0;
+    for (int i = 0; i < pool->n_workers; i++) {
+        stats->executed += pool->workers[i].executed;
+        stats->stolen += pool->workers[i].stolen;
+        stats->timed += pool->workers[i].timed;
+    }
+}
@@ -0,0 +1,247 @@
+#include "procs.h"
+#include "files.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+// Benchmark dos fantasmas em threads contra fantasmas em processos (--procs).
+// O mesmo nível sintético (mapa aberto, fantasmas a patrulhar D/A em colunas
+// alternadas) corre durante -d ms sem TEMPO, com os fantasmas divididos em N
+// grupos, de 1 até -w:
+//   threads  um grupo por thread; tabuleiro privado e pthread_mutex_t normais
+//   procs    um grupo por processo (procs.c); tabuleiro em shm e mutexes
+//            process-shared e robustos
+// Mede-se o arranque (threads, ou segmento + forks) e, no modelo procs,
+// quanto tempo vai de um SIGKILL ao worker 0 até o seu grupo voltar a jogar.
+// Saída: uma linha JSON por caso (stdout).
+
+#define DEFAULT_GHOSTS 256
+#define DEFAULT_SIDE 64
+#define DEFAULT_DURATION_MS 1000
+#define DEFAULT_MAX_WORKERS 8
+#define RECOVER_TIMEOUT_NS 10000000000ull
+
+typedef enum { MODEL_THREADS, MODEL_PROCS } model_t;
+static const char* const model_names[] = { "threads", "procs" };
+
+typedef struct {
+    char* text;           // O .lvl
+    agent_text_t* agents; // bench.p e um .m por fantasma
+    int n_agents;
+} bench_level_t;
+
+typedef struct {
+    board_t* board;
+    int first, last;
+    atomic_ulong rounds;
+} group_arg_t;
+
+static void nap_ms(int milliseconds) {
+    struct timespec ts = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static char* format_text(const char* format, int a, int b) {
+    int len = snprintf(NULL, 0, format, a, b);
+    char* text = malloc(len + 1);
+    snprintf(text, len + 1, format, a, b);
+    return text;
+}
+
+// Fantasmas nas colunas 1, 4, 7, ... de cada linha, a patrulhar para a coluna
+// seguinte e de volta; o pacman fica numa coluna múltipla de 3, onde nenhum entra
+static int build_level(bench_level_t* level, int side, int n_ghosts) {
+    int per_row = (side - 1) / 3;
+    if (side < 5 || n_ghosts > per_row * (side - 2)) return -1;
+
+    size_t cap = (size_t)side * (side + 1) + 64 + (size_t)n_ghosts * 16;
+    char* text = malloc(cap);
+    size_t len = snprintf(text, cap, "DIM %d %d\nTEMPO 0\nPAC bench.p\n", side, side);
+    for (int g = 0; g < n_ghosts; g++) {
+        len += snprintf(text + len, cap - len, "%sg%d.m%s", (g % 16 == 0) ? "MON " : "", g,
+                        (g % 16 == 15 || g == n_ghosts - 1) ? "\n" : " ");
+    }
+    for (int y = 0; y < side; y++) {
+        for (int x = 0; x < side; x++) {
+            text[len++] = (y == 0 || x == 0 || y == side - 1 || x == side - 1) ? 'X' : 'o';
+        }
+        text[len++] = '\n';
+    }
+    text[len] = '\0';
+
+    level->text = text;
+    level->n_agents = n_ghosts + 1;
+    level->agents = malloc(sizeof(agent_text_t) * level->n_agents);
+    level->agents[0].name = strdup("bench.p");
+    level->agents[0].text = format_text("PASSO 0\nPOS %d %d\n", side - 2, 3);
+    for (int g = 0; g < n_ghosts; g++) {
+        char name[32];
+        snprintf(name, sizeof(name), "g%d.m", g);
+        level->agents[g + 1].name = strdup(name);
+        level->agents[g + 1].text = format_text("PASSO 0\nPOS %d %d\nD\nA\n", 1 + g / per_row, 1 + 3 * (g % per_row));
+    }
+    return 0;
+}
+
+static void free_level(bench_level_t* level) {
+    for (int a = 0; a < level->n_agents; a++) {
+        free((char*)level->agents[a].name);
+        free((char*)level->agents[a].text);
+    }
+    free(level->agents);
+    free(level->text);
+}
+
+static void* group_thread(void* arg) {
+    group_arg_t* group = arg;
+    ghost_group_run(group->board, group->first, group->last, 0, &group->rounds);
+    return NULL;
+}
+
+// Jogadas feitas pelos grupos (cada volta de um grupo joga todos os seus fantasmas)
+static unsigned long count_moves(int n_ghosts, int n_workers, const group_arg_t* groups, const ghost_procs_t* procs) {
+    unsigned long moves = 0;
+    for (int w = 0; w < n_workers; w++) {
+        unsigned long rounds = procs ? ghost_procs_rounds(procs, w) : atomic_load(&groups[w].rounds);
+        moves += rounds * (ghost_group_first(n_ghosts, n_workers, w + 1) - ghost_group_first(n_ghosts, n_workers, w));
+    }
+    return moves;
+}
+
+// SIGKILL ao worker 0 e espera até o substituto acabar uma volta; -1 se não recuperar
+static long long measure_recovery(ghost_procs_t* procs) {
+    pid_t victim = ghost_procs_pid(procs, 0);
+    uint64_t start = now_ns();
+    kill(victim, SIGKILL);
+
+    unsigned long rounds = 0;
+    int respawned = 0;
+    while (now_ns() - start < RECOVER_TIMEOUT_NS) {
+        ghost_procs_poll(procs);
+        pid_t pid = ghost_procs_pid(procs, 0);
+        if (!respawned && pid > 0 && pid != victim) {
+            respawned = 1;
+            rounds = ghost_procs_rounds(procs, 0);
+        }
+        if (respawned && ghost_procs_rounds(procs, 0) > rounds) return (long long)((now_ns() - start) / 1000);
+        nap_ms(1);
+    }
+    return -1;
+}
+
+static int run_case(const bench_level_t* level, model_t model, int n_workers, int duration_ms) {
+    board_t board;
+    if (load_level_memory(&board, "procbench", level->text, level->agents, level->n_agents, NULL, 0) != 0) {
+        fprintf(stderr, "procbench: could not load the synthetic level\n");
+        return -1;
+    }
+    int n_ghosts = board.n_ghosts;
+
+    group_arg_t* groups = NULL;
+    pthread_t* threads = NULL;
+    ghost_procs_t* procs = NULL;
+    board_t* running = &board;
+
+    uint64_t setup_start = now_ns();
+    if (model == MODEL_PROCS) {
+        procs = ghost_procs_start(&board, n_workers, 0);
+        if (!procs) {
+            fprintf(stderr, "procbench: ghost_procs_start failed (spin row locks?)\n");
+            unload_level(&board);
+            return -1;
+        }
+        running = ghost_procs_board(procs);
+    }
+    else {
+        groups = calloc(n_workers, sizeof(group_arg_t));
+        threads = malloc(sizeof(pthread_t) * n_workers);
+        for (int w = 0; w < n_workers; w++) {
+            groups[w].board = &board;
+            groups[w].first = ghost_group_first(n_ghosts, n_workers, w);
+            groups[w].last = ghost_group_first(n_ghosts, n_workers, w + 1);
+            atomic_init(&groups[w].rounds, 0);
+            pthread_create(&threads[w], NULL, group_thread, &groups[w]);
+        }
+    }
+    uint64_t start = now_ns();
+    unsigned long moves_before = count_moves(n_ghosts, n_workers, groups, procs);
+
+    nap_ms(duration_ms);
+
+    unsigned long moves = count_moves(n_ghosts, n_workers, groups, procs) - moves_before;
+    uint64_t elapsed = now_ns() - start;
+    long long recover_us = procs ? measure_recovery(procs) : -1;
+
+    if (procs) {
+        ghost_procs_stop(procs);
+    }
+    else {
+        running->game_running = 0;
+        for (int w = 0; w < n_workers; w++) pthread_join(threads[w], NULL);
+    }
+
+    double ns_per_move = moves ? (double)elapsed / moves : 0.0;
+    printf("{\"bench\":\"ghost_workers\",\"model\":\"%s\",\"workers\":%d,\"ghosts\":%d,\"duration_ms\":%.0f,"
+           "\"moves\":%lu,\"moves_per_sec\":%.0f,\"ns_per_move\":%.1f,\"setup_us\":%.1f,\"recover_us\":%lld}\n",
+           model_names[model], n_workers, n_ghosts, elapsed / 1e6, moves,
+           elapsed ? moves * 1e9 / elapsed : 0.0, ns_per_move, (start - setup_start) / 1e3, recover_us);
+    fflush(stdout);
+
+    free(groups);
+    free(threads);
+    unload_level(&board);
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [-g ghosts] [-s side] [-d ms] [-w max_workers] [-m threads|procs]\n"
+        "  -g  fantasmas (default %d)\n"
+        "  -s  lado do mapa quadrado (default %d; cabem (s-1)/3 fantasmas por linha)\n"
+        "  -d  duração de cada caso em ms (default %d)\n"
+        "  -w  número máximo de grupos (1, 2, 4, ... até este valor; default %d)\n",
+        prog, DEFAULT_GHOSTS, DEFAULT_SIDE, DEFAULT_DURATION_MS, DEFAULT_MAX_WORKERS);
+}
+
+int main(int argc, char** argv) {
+    int n_ghosts = DEFAULT_GHOSTS;
+    int side = DEFAULT_SIDE;
+    int duration_ms = DEFAULT_DURATION_MS;
+    int max_workers = DEFAULT_MAX_WORKERS;
+    const char* only_model = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "g:s:d:w:m:h")) != -1) {
+        switch (opt) {
+            case 'g': n_ghosts = atoi(optarg); break;
+            case 's': side = atoi(optarg); break;
+            case 'd': duration_ms = atoi(optarg); break;
+            case 'w': max_workers = atoi(optarg); break;
+            case 'm': only_model = optarg; break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (n_ghosts < 1 || duration_ms < 1 || max_workers < 1) { usage(argv[0]); return 1; }
+
+    bench_level_t level;
+    if (build_level(&level, side, n_ghosts) != 0) {
+        fprintf(stderr, "procbench: %d ghosts do not fit in a %dx%d map\n", n_ghosts, side, side);
+        return 1;
+    }
+
+    int status = 0;
+    for (int n = 1; n <= max_workers && n <= n_ghosts && status == 0; n *= 2) {
+        for (int model = MODEL_THREADS; model <= MODEL_PROCS && status == 0; model++) {
+            if (only_model && strcmp(only_model, model_names[model]) != 0) continue;
+            status = run_case(&level, model, n, duration_ms);
+        }
+    }
+    free_level(&level);
+    agent_cache_clear();
+    return status ? 1 : 0;
+}
@@ -0,0 +1,403 @@
+#define _DEFAULT_SOURCE // SIGWINCH
+#include "procs.h"
+#include "rowlock.h"
+#include "chase.h"
+#include "events.h"
+#include "hud.h"
+#include "histogram.h"
+#include "latency.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#define SEGMENT_ALIGN 64
+#define POLL_INTERVAL_NS 100000000ull // ghost_procs_poll olha para os workers no máximo 10 vezes por segundo
+
+struct ghost_procs {
+    board_t* board;               // O original, em memória privada
+    board_t* shared;              // A cópia no segmento
+    void* segment;
+    size_t segment_size;
+    atomic_ulong* rounds;         // No segmento: voltas completas de cada worker
+    board_pos_t** private_tiles;  // Chunks: os tiles originais (tiles[] aponta para o segmento)
+    int n_workers;
+    int period_ms;
+    pid_t parent;
+    pid_t* pids;                  // -1 = sem processo (grupo parado)
+    int* restarts;
+    unsigned long* seen_rounds;   // Último valor de rounds visto pelo poll
+    uint64_t* seen_at;            // Quando mudou (ns)
+    uint64_t last_poll;
+};
+
+// ==================================================================
+// GRUPOS DE FANTASMAS
+// ==================================================================
+static void ghost_turn(board_t* board, int ghost_idx) {
+    ghost_t* self = &board->ghosts[ghost_idx];
+
+    // Um fetch por tick; o estado do 'T' fica na VM do fantasma
+    command_t cmd = { 'R', 1, 0 };
+    if (script_runnable(self->script)) {
+        const instr_t* ins = script_fetch(board, self->script, &self->vm, self->pos_x, self->pos_y);
+        if (!ins) return;
+        cmd.command = ins->dir;
+        cmd.turns = ins->arg;
+        cmd.scripted = 1;
+    }
+    // Sem ficheiro: movimento aleatório
+    uint64_t start = now_ns();
+    int result = move_ghost(board, ghost_idx, &cmd);
+    uint64_t ns = now_ns() - start;
+    latency_record(LAT_MOVE_GHOST, ns);
+    hud_record_move(ns, result == INVALID_MOVE);
+}
+
+void ghost_group_run(board_t* board, int first, int last, int period_ms, atomic_ulong* rounds) {
+    hud_thread_start(HUD_THREAD_GHOSTS, first, last - first);
+    while (board->game_running) {
+        // Simular velocidade (sleep fora do lock; o move_ghost trata dos locks)
+        if (period_ms > 0) sleep_ms(period_ms);
+
+        // Verificar se o jogo acabou enquanto dormia
+        if (!board->game_running) break;
+
+        for (int g = first; g < last && board->game_running; g++) ghost_turn(board, g);
+        if (rounds) {
+            atomic_fetch_add_explicit(rounds, 1, memory_order_relaxed);
+            hud_sample_cpu(); // Worker de --procs: a UI não consegue ler o relógio desta thread
+        }
+    }
+    hud_thread_exit();
+}
+
+int ghost_group_first(int n_ghosts, int n_groups, int group) {
+    return (int)((long)n_ghosts * group / n_groups);
+}
+
+// ==================================================================
+// WORKERS
+// ==================================================================
+static size_t align_up(size_t n) {
+    return (n + SEGMENT_ALIGN - 1) & ~(size_t)(SEGMENT_ALIGN - 1);
+}
+
+static void nap_ms(int milliseconds) {
+    struct timespec ts = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// Segmento POSIX com o nome só durante a criação: os workers herdam o
+// mapeamento no fork e nada fica em /dev/shm se o jogo morrer
+static void* segment_create(size_t size) {
+    static int counter = 0;
+    char name[64];
+    snprintf(name, sizeof(name), "/pacmanist-procs-%d-%d", (int)getpid(), counter++);
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) {
+        debug("[PROCS] shm_open %s falhou\n", name);
+        return NULL;
+    }
+    shm_unlink(name);
+
+    void* mem = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        debug("[PROCS] segmento de %zu bytes falhou\n", size);
+        return NULL;
+    }
+    return mem;
+}
+
+static void worker_main(ghost_procs_t* procs, int worker) {
+    // Ctrl+C e o terminal são do jogo (o ncurses repõe o ecrã); o worker sai com o pai
+    signal(SIGINT, SIG_IGN);
+    signal(SIGQUIT, SIG_IGN);
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGWINCH, SIG_DFL);
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+    if (getppid() != procs->parent) _exit(0); // O pai morreu antes do prctl
+
+    // Sem isto todos os workers (e os relançados) tiravam a mesma sequência de 'R'
+    srand((unsigned)time(NULL) ^ ((unsigned)getpid() << 8));
+
+    board_t* board = procs->shared;
+    int first = ghost_group_first(board->n_ghosts, procs->n_workers, worker);
+    int last = ghost_group_first(board->n_ghosts, procs->n_workers, worker + 1);
+    ghost_group_run(board, first, last, procs->period_ms, &procs->rounds[worker]);
+    _exit(0); // Sem atexit nem flush de buffers herdados do pai
+}
+
+static int spawn_worker(ghost_procs_t* procs, int worker) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        debug("[PROCS] fork do worker %d falhou\n", worker);
+        return -1;
+    }
+    if (pid == 0) worker_main(procs, worker);
+
+    procs->pids[worker] = pid;
+    procs->seen_rounds[worker] = atomic_load(&procs->rounds[worker]);
+    procs->seen_at[worker] = now_ns();
+    debug("[PROCS] worker %d: pid %d, fantasmas %d a %d\n", worker, (int)pid,
+          ghost_group_first(procs->shared->n_ghosts, procs->n_workers, worker),
+          ghost_group_first(procs->shared->n_ghosts, procs->n_workers, worker + 1) - 1);
+    return 0;
+}
+
+// Um worker morto a meio de uma jogada pode ter deixado o seu fantasma em duas
+// células ou em nenhuma: com o tabuleiro parado, apagar os 'M' e voltar a pô-los
+// onde os fantasmas estão
+static void repair_ghost_cells(board_t* board) {
+    lock_all_rows(board, LOCK_CALLER_RENDER);
+    for (int y = 0; y < board->height; y++) {
+        for (int x = 0; x < board->width; x++) {
+            board_pos_t* cell = board_cell(board, x, y);
+            if (cell->content == 'M') cell->content = ' ';
+        }
+    }
+    for (int g = 0; g < board->n_ghosts; g++) {
+        const ghost_t* ghost = &board->ghosts[g];
+        // Fantasmas sem .m legível ficam fora do mapa (-1,-1)
+        if (ghost->pos_x < 0 || ghost->pos_x >= board->width || ghost->pos_y < 0 || ghost->pos_y >= board->height) continue;
+        board_pos_t* cell = board_cell(board, ghost->pos_x, ghost->pos_y);
+        if (cell->content != 'W') cell->content = 'M';
+    }
+    unlock_all_rows(board);
+    board_changed(board);
+}
+
+// Espera pelos workers, copia o estado para o board original e desfaz o segmento
+static void procs_teardown(ghost_procs_t* procs) {
+    board_t* shared = procs->shared;
+    board_t* board = procs->board;
+
+    // Cada worker sai no fim da volta em curso; um que não saia é morto
+    uint64_t deadline = now_ns() + (PROCS_STALL_MS + 2ull * procs->period_ms) * 1000000ull;
+    for (int w = 0; w < procs->n_workers; w++) {
+        pid_t pid = procs->pids[w];
+        if (pid < 0) continue;
+        while (waitpid(pid, NULL, WNOHANG) == 0) {
+            if (now_ns() > deadline) {
+                kill(pid, SIGKILL);
+                waitpid(pid, NULL, 0);
+                break;
+            }
+            nap_ms(1);
+        }
+        hud_forget(pid); // Um worker morto não chegou a largar o seu slot
+        procs->pids[w] = -1;
+    }
+
+    memcpy(board->pacmans, shared->pacmans, sizeof(pacman_t) * board->n_pacmans);
+    memcpy(board->ghosts, shared->ghosts, sizeof(ghost_t) * board->n_ghosts);
+    if (board->board) {
+        memcpy(board->board, shared->board, sizeof(board_pos_t) * board->width * board->height);
+    }
+    else {
+        long n_tiles = (long)board->chunks->tiles_w * board->chunks->tiles_h;
+        for (long t = 0; t < n_tiles; t++) {
+            if (!procs->private_tiles[t]) continue;
+            memcpy(procs->private_tiles[t], board->chunks->tiles[t], sizeof(board_pos_t) * BOARD_TILE * BOARD_TILE);
+            board->chunks->tiles[t] = procs->private_tiles[t];
+        }
+    }
+    board->game_running = shared->game_running;
+    board->exit_status = shared->exit_status;
+    board->next_pacman_cmd = shared->next_pacman_cmd;
+    board->save_request = shared->save_request;
+    atomic_store(&board->generation, atomic_load(&shared->generation));
+    atomic_store(&board->pacman_version, atomic_load(&shared->pacman_version));
+
+#ifndef SPIN_ROW_LOCKS
+    for (int y = 0; y < shared->height; y++) pthread_mutex_destroy(&shared->row_locks[y]);
+#endif
+    pthread_mutex_destroy(&shared->board_lock);
+    pthread_mutex_destroy(&shared->global_stats_lock);
+    chase_release_shared(shared);
+    munmap(procs->segment, procs->segment_size);
+
+    free(procs->private_tiles);
+    free(procs->pids);
+    free(procs->restarts);
+    free(procs->seen_rounds);
+    free(procs->seen_at);
+    free(procs);
+}
+
+ghost_procs_t* ghost_procs_start(board_t* board, int n_workers, int period_ms) {
+#ifdef SPIN_ROW_LOCKS
+    // O futex do spin_lock_t é privado ao processo: não acordaria quem espera noutro
+    debug("[PROCS] --procs precisa dos row locks pthread (build sem -DSPIN_ROW_LOCKS)\n");
+    return NULL;
+#endif
+    if (board->n_ghosts < 1) return NULL;
+    if (n_workers > board->n_ghosts) n_workers = board->n_ghosts;
+    if (n_workers < 1) n_workers = 1;
+
+    // Segmento: board_t | rounds | row locks | pacmans | fantasmas | células | campo de caça | fila de eventos
+    const long tile_cells = BOARD_TILE * BOARD_TILE;
+    long n_cells = board->board ? (long)board->width * board->height : board->chunks->n_allocated * tile_cells;
+    size_t off_rounds = align_up(sizeof(board_t));
+    size_t off_locks = off_rounds + align_up(sizeof(atomic_ulong) * n_workers);
+    size_t off_pacmans = off_locks + align_up(sizeof(row_lock_t) * board->height);
+    size_t off_ghosts = off_pacmans + align_up(sizeof(pacman_t) * board->n_pacmans);
+    size_t off_cells = off_ghosts + align_up(sizeof(ghost_t) * board->n_ghosts);
+    size_t off_chase = off_cells + align_up(sizeof(board_pos_t) * n_cells);
+    size_t off_events = off_chase + align_up(chase_shared_bytes(board));
+    int event_capacity = board->events ? event_queue_capacity(board->events) : 0;
+    size_t size = off_events + (board->events ? align_up(event_queue_bytes(event_capacity)) : 0);
+
+    char* mem = segment_create(size);
+    if (!mem) return NULL;
+
+    ghost_procs_t* procs = calloc(1, sizeof(ghost_procs_t));
+    procs->board = board;
+    procs->segment = mem;
+    procs->segment_size = size;
+    procs->n_workers = n_workers;
+    procs->period_ms = period_ms;
+    procs->parent = getpid();
+    procs->pids = malloc(sizeof(pid_t) * n_workers);
+    procs->restarts = calloc(n_workers, sizeof(int));
+    procs->seen_rounds = calloc(n_workers, sizeof(unsigned long));
+    procs->seen_at = calloc(n_workers, sizeof(uint64_t));
+    for (int w = 0; w < n_workers; w++) procs->pids[w] = -1;
+
+    board_t* shared = (board_t*)mem;
+    *shared = *board;
+    procs->shared = shared;
+    procs->rounds = (atomic_ulong*)(mem + off_rounds);
+    for (int w = 0; w < n_workers; w++) atomic_init(&procs->rounds[w], 0);
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&shared->board_lock, &attr);
+    pthread_mutex_init(&shared->global_stats_lock, &attr);
+    shared->row_locks = (row_lock_t*)(mem + off_locks);
+#ifndef SPIN_ROW_LOCKS
+    for (int y = 0; y < board->height; y++) pthread_mutex_init(&shared->row_locks[y], &attr);
+#endif
+    pthread_mutexattr_destroy(&attr);
+
+    shared->pacmans = (pacman_t*)(mem + off_pacmans);
+    memcpy(shared->pacmans, board->pacmans, sizeof(pacman_t) * board->n_pacmans);
+    shared->ghosts = (ghost_t*)(mem + off_ghosts);
+    memcpy(shared->ghosts, board->ghosts, sizeof(ghost_t) * board->n_ghosts);
+
+    // Os scripts e o array de tiles não mudam depois do load: os workers usam as cópias do fork
+    board_pos_t* cells = (board_pos_t*)(mem + off_cells);
+    if (board->board) {
+        memcpy(cells, board->board, sizeof(board_pos_t) * n_cells);
+        shared->board = cells;
+    }
+    else {
+        long n_tiles = (long)board->chunks->tiles_w * board->chunks->tiles_h;
+        procs->private_tiles = malloc(sizeof(board_pos_t*) * n_tiles);
+        long n = 0;
+        for (long t = 0; t < n_tiles; t++) {
+            procs->private_tiles[t] = board->chunks->tiles[t];
+            if (!board->chunks->tiles[t]) continue;
+            memcpy(cells + n, board->chunks->tiles[t], sizeof(board_pos_t) * tile_cells);
+            board->chunks->tiles[t] = cells + n;
+            n += tile_cells;
+        }
+    }
+    chase_place_shared(shared, mem + off_chase);
+    // Os workers publicam na fila partilhada; a UI tira de lá (ghost_procs_board(procs)->events)
+    if (board->events) shared->events = event_queue_init(mem + off_events, event_capacity);
+
+    for (int w = 0; w < n_workers; w++) {
+        if (spawn_worker(procs, w) != 0) {
+            int running = board->game_running;
+            shared->game_running = 0;
+            procs_teardown(procs);
+            board->game_running = running;
+            return NULL;
+        }
+    }
+    procs->last_poll = now_ns();
+    return procs;
+}
+
+board_t* ghost_procs_board(ghost_procs_t* procs) {
+    return procs->shared;
+}
+
+int ghost_procs_poll(ghost_procs_t* procs) {
+    board_t* board = procs->shared;
+    uint64_t now = now_ns();
+    if (!board->game_running || now - procs->last_poll < POLL_INTERVAL_NS) return 0;
+    procs->last_poll = now;
+
+    uint64_t stall_ns = (PROCS_STALL_MS + 4ull * procs->period_ms) * 1000000ull;
+    int restarted = 0;
+    for (int w = 0; w < procs->n_workers; w++) {
+        pid_t pid = procs->pids[w];
+        if (pid < 0) continue;
+
+        int status;
+        if (waitpid(pid, &status, WNOHANG) != pid) {
+            unsigned long rounds = atomic_load(&procs->rounds[w]);
+            if (rounds != procs->seen_rounds[w]) {
+                procs->seen_rounds[w] = rounds;
+                procs->seen_at[w] = now;
+                continue;
+            }
+            if (now - procs->seen_at[w] < stall_ns) continue;
+
+            // Preso (script em ciclo, lock perdido...): os row locks robustos aguentam o SIGKILL
+            debug("[PROCS] worker %d (pid %d) parado há %llu ms\n", w, (int)pid,
+                  (unsigned long long)((now - procs->seen_at[w]) / 1000000ull));
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+        }
+        else if (WIFSIGNALED(status)) {
+            debug("[PROCS] worker %d (pid %d) morreu com o sinal %d\n", w, (int)pid, WTERMSIG(status));
+        }
+        else {
+            debug("[PROCS] worker %d (pid %d) saiu com %d\n", w, (int)pid, WEXITSTATUS(status));
+        }
+        hud_forget(pid);
+        procs->pids[w] = -1;
+        repair_ghost_cells(board);
+
+        if (++procs->restarts[w] > PROCS_MAX_RESTARTS) {
+            debug("[PROCS] worker %d: %d reinícios, os seus fantasmas ficam parados\n", w, PROCS_MAX_RESTARTS);
+            continue;
+        }
+        if (spawn_worker(procs, w) == 0) restarted++;
+    }
+    return restarted;
+}
+
+void ghost_procs_stop(ghost_procs_t* procs) {
+    procs->shared->game_running = 0;
+    procs_teardown(procs);
+}
+
+int ghost_procs_workers(const ghost_procs_t* procs) {
+    return procs->n_workers;
+}
+
+pid_t ghost_procs_pid(const ghost_procs_t* procs, int worker) {
+    return procs->pids[worker];
+}
+
+unsigned long ghost_procs_rounds(const ghost_procs_t* procs, int worker) {
+    return atomic_load(&procs->rounds[worker]);
+}
@@ -0,0 +1,186 @@
+#include "rowlock.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef LOCK_PROFILE
+
+static const char* caller_names[N_LOCK_CALLERS] = {
+    "pacman", "ghost", "charged", "render", "save", "quit", "autopilot"
+};
+
+typedef struct {
+    histogram_t wait; // ns desde o pedido até obter o lock
+    histogram_t hold; // ns desde obter o lock até ao unlock
+} lock_caller_stats_t;
+
+// Estatísticas de uma linha. Só são escritas por quem tem o lock dessa linha,
+// por isso não precisam de sincronização própria.
+struct row_lock_stats {
+    lock_caller_stats_t callers[N_LOCK_CALLERS];
+    uint64_t acquired_at;
+    lock_caller_t holder;
+};
+
+void row_lock(board_t* board, int row, lock_caller_t caller) {
+    if (!board->row_stats) { // O calloc das estatísticas falhou: trancar sem medir
+        row_lock_acquire(&board->row_locks[row]);
+        return;
+    }
+    uint64_t start = now_ns();
+    row_lock_acquire(&board->row_locks[row]);
+    uint64_t acquired = now_ns();
+
+    struct row_lock_stats* st = &board->row_stats[row];
+    hist_record(&st->callers[caller].wait, acquired - start);
+    st->acquired_at = acquired;
+    st->holder = caller;
+}
+
+void row_unlock(board_t* board, int row) {
+    if (!board->row_stats) {
+        row_lock_release(&board->row_locks[row]);
+        return;
+    }
+    struct row_lock_stats* st = &board->row_stats[row];
+    hist_record(&st->callers[st->holder].hold, now_ns() - st->acquired_at);
+    row_lock_release(&board->row_locks[row]);
+}
+
+// Caracteres do heatmap, do mais frio para o mais quente
+static const char heat_chars[] = " .:-=+*#%@";
+
+void lockprof_report(board_t* board, const char* path) {
+    if (!board->row_stats) return;
+
+    // O global_stats_lock serializa os relatórios (save fork, vários níveis)
+    pthread_mutex_lock(&board->global_stats_lock);
+
+    FILE* out = fopen(path, "a");
+    if (!out) {
+        pthread_mutex_unlock(&board->global_stats_lock);
+        return;
+    }
+
+    lock_caller_stats_t totals[N_LOCK_CALLERS] = {0};
+    uint64_t max_row_wait = 0;
+    uint64_t contended_rows = 0;
+
+    for (int y = 0; y < board->height; y++) {
+        uint64_t row_wait = 0;
+        for (int c = 0; c < N_LOCK_CALLERS; c++) {
+            hist_merge(&totals[c].wait, &board->row_stats[y].callers[c].wait);
+            hist_merge(&totals[c].hold, &board->row_stats[y].callers[c].hold);
+            row_wait += board->row_stats[y].callers[c].wait.sum;
+        }
+        if (row_wait > max_row_wait) max_row_wait = row_wait;
+    }
+
+    fprintf(out, "=== LOCK PROFILE: %s (%d rows) ===\n", board->level_name, board->height);
+    fprintf(out, "%-8s %10s %12s %10s %10s %12s %10s %10s\n",
+            "caller", "acquires", "wait_tot_us", "wait_p50", "wait_p99",
+            "hold_tot_us", "hold_p50", "hold_p99");
+    for (int c = 0; c < N_LOCK_CALLERS; c++) {
+        lock_caller_stats_t* t = &totals[c];
+        if (t->wait.count == 0) continue;
+        fprintf(out, "%-8s %10llu %12llu %10llu %10llu %12llu %10llu %10llu\n",
+                caller_names[c],
+                (unsigned long long)t->wait.count,
+                (unsigned long long)(t->wait.sum / 1000),
+                (unsigned long long)hist_percentile(&t->wait, 50),
+                (unsigned long long)hist_percentile(&t->wait, 99),
+                (unsigned long long)(t->hold.sum / 1000),
+                (unsigned long long)hist_percentile(&t->hold, 50),
+                (unsigned long long)hist_percentile(&t->hold, 99));
+    }
+
+    // Heatmap por linha: intensidade = espera acumulada relativa à linha mais quente
+    fprintf(out, "\n%5s %10s %12s %10s %10s  heat (wait)\n",
+            "row", "acquires", "wait_tot_us", "wait_p99", "hold_p99");
+    for (int y = 0; y < board->height; y++) {
+        histogram_t wait = {0}, hold = {0};
+        for (int c = 0; c < N_LOCK_CALLERS; c++) {
+            hist_merge(&wait, &board->row_stats[y].callers[c].wait);
+            hist_merge(&hold, &board->row_stats[y].callers[c].hold);
+        }
+
+        int level = 0;
+        if (max_row_wait > 0) level = (int)((wait.sum * (sizeof(heat_chars) - 2)) / max_row_wait);
+        if (wait.count > 0 && hist_percentile(&wait, 99) > 10000) contended_rows++;
+
+        char bar[33];
+        int bar_len = (max_row_wait > 0) ? (int)((wait.sum * 32) / max_row_wait) : 0;
+        for (int i = 0; i < 32; i++) bar[i] = (i < bar_len) ? heat_chars[level] : ' ';
+        bar[32] = '\0';
+
+        fprintf(out, "%5d %10llu %12llu %10llu %10llu |%s|\n", y,
+                (unsigned long long)wait.count,
+                (unsigned long long)(wait.sum / 1000),
+                (unsigned long long)hist_percentile(&wait, 99),
+                (unsigned long long)hist_percentile(&hold, 99), bar);
+    }
+
+    // Pista sobre a granularidade: contenção concentrada em poucas linhas
+    // sugere locks mais finos (tiles); contenção nula sugere que as linhas chegam.
+    fprintf(out, "\nrows with wait p99 > 10us: %llu of %d -> %s\n\n",
+            (unsigned long long)contended_rows, board->height,
+            (contended_rows == 0) ? "row granularity is enough" :
+            (contended_rows * 4 < (uint64_t)board->height) ? "hot spots, consider tile locks" :
+            "contention everywhere, consider lock-free cells");
+
+    fclose(out);
+    pthread_mutex_unlock(&board->global_stats_lock);
+}
+
+#endif
+
+int row_locks_init(board_t* board) {
+#ifdef SPIN_ROW_LOCKS
+    // Um bloco de cache por linha (sizeof(spin_lock_t) já é múltiplo do alinhamento)
+    board->row_locks = aligned_alloc(SPIN_CACHE_LINE, sizeof(row_lock_t) * board->height);
+    if (!board->row_locks) return -1;
+    for (int i = 0; i < board->height; i++) spin_lock_init(&board->row_locks[i]);
+#else
+    board->row_locks = malloc(sizeof(row_lock_t) * board->height);
+    if (!board->row_locks) return -1;
+    for (int i = 0; i < board->height; i++) {
+        pthread_mutex_init(&board->row_locks[i], NULL);
+    }
+#endif
+    pthread_mutex_init(&board->global_stats_lock, NULL);
+
+    board->row_stats = NULL;
+#ifdef LOCK_PROFILE
+    board->row_stats = calloc(board->height, sizeof(struct row_lock_stats));
+#endif
+    return 0;
+}
+
+void row_locks_destroy(board_t* board) {
+    if (board->row_locks) {
+#ifndef SPIN_ROW_LOCKS
+        for (int i = 0; i < board->height; i++) {
+            pthread_mutex_destroy(&board->row_locks[i]);
+        }
+#endif
+        free(board->row_locks);
+        board->row_locks = NULL;
+    }
+    pthread_mutex_destroy(&board->global_stats_lock);
+
+    free(board->row_stats);
+    board->row_stats = NULL;
+}
+
+void lock_all_rows(board_t* board, lock_caller_t caller) {
+    // Ordem crescente obrigatória
+    for (int i = 0; i < board->height; i++) {
+        row_lock(board, i, caller);
+    }
+}
+
+void unlock_all_rows(board_t* board) {
+    for (int i = 0; i < board->height; i++) {
+        row_unlock(board, i);
+    }
+}
@@ -0,0 +1,201 @@
+#include "script.h"
+#include "board.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Máximo de instruções de controlo resolvidas num só fetch
+// (protege contra LOOPs sem ações, que nunca chegariam a um OP_ACT)
+#define MAX_FETCH_STEPS 4096
+
+typedef enum { BLOCK_LOOP, BLOCK_IF, BLOCK_ELSE } block_kind_t;
+
+typedef struct {
+    block_kind_t kind;
+    int at;    // LOOP: índice do OP_LOOP; IF: índice do OP_IF; ELSE: índice do OP_JUMP
+    int slot;  // Contador usado pelo LOOP
+} block_t;
+
+struct script_builder {
+    instr_t* code;
+    int n_ops, cap;
+    int n_actions;
+    block_t blocks[MAX_LOOP_DEPTH * 2];
+    int depth;
+    int loop_depth;
+};
+
+static const char* cond_names[] = { "WALL", "FREE", "DOT", "GHOST", "PAC" };
+
+static int emit(script_builder_t* b, uint8_t op, char dir, uint8_t slot, int32_t arg) {
+    if (b->n_ops == b->cap) {
+        b->cap = b->cap ? b->cap * 2 : 32;
+        b->code = realloc(b->code, sizeof(instr_t) * b->cap);
+    }
+    instr_t* ins = &b->code[b->n_ops];
+    ins->op = op;
+    ins->dir = dir;
+    ins->slot = slot;
+    ins->pad = 0;
+    ins->arg = arg;
+    return b->n_ops++;
+}
+
+script_builder_t* script_builder_new(void) {
+    return calloc(1, sizeof(script_builder_t));
+}
+
+static int is_direction(char c) {
+    return c == 'W' || c == 'A' || c == 'S' || c == 'D';
+}
+
+static int close_block(script_builder_t* b) {
+    if (b->depth == 0) return -1;
+    block_t* blk = &b->blocks[--b->depth];
+
+    if (blk->kind == BLOCK_LOOP) {
+        instr_t* loop = &b->code[blk->at];
+        b->loop_depth--;
+        if (loop->arg <= 0) {
+            // LOOP 0: o bloco nunca corre, salta diretamente para depois do END
+            loop->op = OP_JUMP;
+            loop->arg = b->n_ops;
+            return 0;
+        }
+        emit(b, OP_ENDLOOP, 0, blk->slot, blk->at + 1);
+    } else {
+        // IF sem ELSE: o OP_IF salta para aqui; com ELSE: o OP_JUMP do fim do ramo "then"
+        b->code[blk->at].arg = b->n_ops;
+    }
+    return 0;
+}
+
+int script_builder_add_line(script_builder_t* b, const char* line) {
+    char word[16];
+    if (sscanf(line, "%15s", word) != 1) return -1;
+
+    if (strcmp(word, "LOOP") == 0) {
+        int count = 0;
+        if (sscanf(line, " LOOP %d", &count) != 1) return -1;
+        if (b->loop_depth == MAX_LOOP_DEPTH || b->depth == MAX_LOOP_DEPTH * 2) return -1;
+        block_t* blk = &b->blocks[b->depth++];
+        blk->kind = BLOCK_LOOP;
+        blk->slot = b->loop_depth++;
+        blk->at = emit(b, OP_LOOP, 0, blk->slot, count);
+        return 0;
+    }
+    if (strcmp(word, "IF") == 0) {
+        char cond[16], dir[4];
+        if (sscanf(line, " IF %15s %3s", cond, dir) != 2 || !is_direction(dir[0])) return -1;
+        if (b->depth == MAX_LOOP_DEPTH * 2) return -1;
+        int c;
+        for (c = 0; c <= COND_PAC; c++) {
+            if (strcmp(cond, cond_names[c]) == 0) break;
+        }
+        if (c > COND_PAC) return -1;
+        block_t* blk = &b->blocks[b->depth++];
+        blk->kind = BLOCK_IF;
+        blk->at = emit(b, OP_IF, dir[0], (uint8_t)c, -1);
+        return 0;
+    }
+    if (strcmp(word, "ELSE") == 0) {
+        if (b->depth == 0 || b->blocks[b->depth - 1].kind != BLOCK_IF) return -1;
+        block_t* blk = &b->blocks[b->depth - 1];
+        int jump = emit(b, OP_JUMP, 0, 0, -1);
+        b->code[blk->at].arg = b->n_ops; // Condição falsa: começa o ramo ELSE
+        blk->kind = BLOCK_ELSE;
+        blk->at = jump;
+        return 0;
+    }
+    if (strcmp(word, "END") == 0) {
+        return close_block(b);
+    }
+
+    // Comando simples: só conta a primeira letra ("T3" e "T 3" são o mesmo)
+    char cmd = word[0];
+    if (!strchr("WASDRCHTGQ", cmd)) return -1;
+
+    int turns = 1;
+    const char* ptr = strchr(line, cmd) + 1;
+    while (*ptr == ' ' || *ptr == '\t') ptr++;
+    if (isdigit((unsigned char)*ptr)) turns = atoi(ptr);
+
+    emit(b, OP_ACT, cmd, 0, turns);
+    b->n_actions++;
+    return 0;
+}
+
+script_t* script_builder_finish(script_builder_t* b) {
+    // Blocos por fechar terminam no fim do ficheiro
+    while (b->depth > 0) close_block(b);
+    emit(b, OP_JUMP, 0, 0, 0); // O script recomeça do início
+
+    script_t* script = malloc(sizeof(script_t));
+    script->code = realloc(b->code, sizeof(instr_t) * b->n_ops);
+    script->n_ops = b->n_ops;
+    script->n_actions = b->n_actions;
+    atomic_init(&script->refs, 1);
+    free(b);
+    return script;
+}
+
+script_t* script_retain(script_t* script) {
+    if (script) atomic_fetch_add_explicit(&script->refs, 1, memory_order_relaxed);
+    return script;
+}
+
+void script_free(script_t* script) {
+    if (!script) return;
+    if (atomic_fetch_sub_explicit(&script->refs, 1, memory_order_acq_rel) != 1) return;
+    free(script->code);
+    free(script);
+}
+
+// Avalia uma condição sobre a célula vizinha (fora do tabuleiro conta como parede)
+static int eval_cond(const board_t* board, uint8_t cond, char dir, int x, int y) {
+    switch (dir) {
+        case 'W': y--; break;
+        case 'S': y++; break;
+        case 'A': x--; break;
+        case 'D': x++; break;
+    }
+
+    int inside = (x >= 0 && x < board->width && y >= 0 && y < board->height);
+    const board_pos_t* cell = inside ? board_cell(board, x, y) : NULL;
+
+    switch (cond) {
+        case COND_WALL:  return !cell || cell->content == 'W';
+        case COND_FREE:  return cell && cell->content == ' ';
+        case COND_DOT:   return cell && cell->has_dot;
+        case COND_GHOST: return cell && cell->content == 'M';
+        case COND_PAC:   return cell && cell->content == 'P';
+    }
+    return 0;
+}
+
+const instr_t* script_fetch(const board_t* board, const script_t* script, vm_state_t* vm, int x, int y) {
+    if (!script_runnable(script)) return NULL;
+
+    for (int steps = 0; steps < MAX_FETCH_STEPS; steps++) {
+        const instr_t* ins = &script->code[vm->pc];
+        switch (ins->op) {
+            case OP_ACT:
+                return ins;
+            case OP_LOOP:
+                vm->counters[ins->slot] = ins->arg;
+                vm->pc++;
+                break;
+            case OP_ENDLOOP:
+                vm->pc = (--vm->counters[ins->slot] > 0) ? ins->arg : vm->pc + 1;
+                break;
+            case OP_IF:
+                vm->pc = eval_cond(board, ins->slot, ins->dir, x, y) ? vm->pc + 1 : ins->arg;
+                break;
+            case OP_JUMP:
+                vm->pc = ins->arg;
+                break;
+        }
+    }
+    return NULL; // Continua no próximo tick a partir do mesmo pc
+}
@@ -0,0 +1,241 @@
+#include "server.h"
+#include "batch.h"
+#include "board.h"
+#include "files.h"
+#include "sim.h"
+#include "pool.h"
+#include "histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#define DEFAULT_SESSIONS 64
+#define DEFAULT_MAX_TICKS 100000
+
+typedef struct {
+    const char* dir;
+    char (*levels)[MAX_FILENAME];
+    int n_levels;
+} level_list_t;
+
+typedef struct {
+    int id;
+    const level_list_t* list;
+    int level;           // Índice do nível atual em list
+    board_t board;
+    unsigned int seed;   // 'R' desta sessão com rand_r (board.rand_seed aponta para aqui)
+    int* points;         // Pontos acumulados de cada pacman (passam para o nível seguinte)
+    int n_points;
+    long ticks;          // Total da sessão
+    long level_ticks;
+    int levels_won;
+    int status;
+    uint64_t start;
+    uint64_t next_tick;  // Deadline do próximo tick (0 = sem ritmo)
+    double wall_ms;
+    histogram_t lateness; // ns entre o deadline e o início real de cada tick
+} session_t;
+
+// Configuração partilhada (só leitura depois de arrancar)
+static pool_t* server_pool;
+static long server_max_ticks;
+static int server_fast;
+
+static void session_tick(void* arg);
+
+static void schedule_next(session_t* s) {
+    if (server_fast || s->board.tempo <= 0) {
+        s->next_tick = 0;
+        pool_submit(server_pool, session_tick, s);
+        return;
+    }
+    // Deadlines absolutos: um tick atrasado não empurra os seguintes
+    uint64_t now = now_ns();
+    if (s->next_tick == 0) s->next_tick = now;
+    s->next_tick += (uint64_t)s->board.tempo * 1000000ull;
+    pool_submit_at(server_pool, s->next_tick, session_tick, s);
+}
+
+static int start_level(session_t* s) {
+    s->level_ticks = 0;
+    if (load_level(&s->board, s->list->dir, s->list->levels[s->level], s->points, s->n_points) != 0) {
+        s->status = BATCH_LOAD_ERROR;
+        return -1;
+    }
+    // Sem o rand() da libc: não é partilhado com as outras sessões nem depende da ordem dos ticks
+    s->board.rand_seed = &s->seed;
+    return 0;
+}
+
+static void finish_session(session_t* s, int status) {
+    s->status = status;
+    s->wall_ms = (now_ns() - s->start) / 1e6;
+}
+
+static void session_tick(void* arg) {
+    session_t* s = arg;
+    if (s->next_tick) {
+        uint64_t now = now_ns();
+        hist_record(&s->lateness, (now > s->next_tick) ? now - s->next_tick : 0);
+    }
+
+    sim_step(&s->board);
+    s->ticks++;
+    s->level_ticks++;
+
+    if (s->board.game_running && (server_max_ticks <= 0 || s->level_ticks < server_max_ticks)) {
+        schedule_next(s);
+        return;
+    }
+
+    // Fim do nível: guardar os pontos e seguir para o próximo se ganhou
+    int status = s->board.game_running ? GAME_TIMEOUT : s->board.exit_status;
+    free(s->points);
+    s->n_points = s->board.n_pacmans;
+    s->points = malloc(sizeof(int) * s->n_points);
+    for (int p = 0; p < s->n_points; p++) s->points[p] = s->board.pacmans[p].points;
+    unload_level(&s->board);
+
+    if (status == GAME_WON) s->levels_won++;
+    if (status == GAME_WON && s->level + 1 < s->list->n_levels) {
+        s->level++;
+        if (start_level(s) == 0) {
+            schedule_next(s);
+            return;
+        }
+        status = BATCH_LOAD_ERROR;
+    }
+    finish_session(s, status);
+}
+
+static int collect_levels(char** dirs, int n_dirs, level_list_t* lists) {
+    int total = 0;
+    for (int d = 0; d < n_dirs; d++) {
+        lists[d].dir = dirs[d];
+        lists[d].levels = NULL;
+        lists[d].n_levels = 0;
+
+        struct dirent **namelist;
+        int n = scandir(dirs[d], &namelist, filter_levels, alphasort);
+        if (n < 0) { perror(dirs[d]); continue; }
+
+        lists[d].levels = malloc(sizeof(*lists[d].levels) * (n > 0 ? n : 1));
+        for (int i = 0; i < n; i++) {
+            snprintf(lists[d].levels[i], MAX_FILENAME, "%s", namelist[i]->d_name);
+            free(namelist[i]);
+        }
+        free(namelist);
+        lists[d].n_levels = n;
+        total += n;
+    }
+    return total;
+}
+
+static int session_points(const session_t* s) {
+    int points = 0;
+    for (int p = 0; p < s->n_points; p++) points += s->points[p];
+    return points;
+}
+
+static void write_csv(FILE* out, const session_t* sessions, int n) {
+    fprintf(out, "session,dir,levels_won,status,exit_status,points,ticks,wall_ms,late_p99_us\n");
+    for (int i = 0; i < n; i++) {
+        const session_t* s = &sessions[i];
+        fprintf(out, "%d,%s,%d,%s,%d,%d,%ld,%.3f,%.1f\n", s->id, s->list->dir, s->levels_won,
+                batch_status_name(s->status), s->status, session_points(s), s->ticks, s->wall_ms,
+                hist_percentile(&s->lateness, 99) / 1e3);
+    }
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "Usage: Pacmanist --server [-j workers] [-n sessions] [-t max_ticks] [-f] [-o file] [-s seed] <dir>...\n"
+        "  -j  threads do pool (default: uma por core)\n"
+        "  -n  sessões; a sessão i joga os níveis da pasta i %% <número de pastas> (default: %d)\n"
+        "  -t  ticks máximos por nível (default: %d, 0 = sem limite)\n"
+        "  -f  ignorar o TEMPO dos níveis (ticks o mais depressa possível)\n", DEFAULT_SESSIONS, DEFAULT_MAX_TICKS);
+}
+
+int run_server(int argc, char** argv) {
+    int workers = 0;
+    int n_sessions = DEFAULT_SESSIONS;
+    const char* out_path = NULL;
+    unsigned int seed = 1;
+    server_max_ticks = DEFAULT_MAX_TICKS;
+    server_fast = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:n:t:fo:s:h")) != -1) {
+        switch (opt) {
+            case 'j': workers = atoi(optarg); break;
+            case 'n': n_sessions = atoi(optarg); break;
+            case 't': server_max_ticks = atol(optarg); break;
+            case 'f': server_fast = 1; break;
+            case 'o': out_path = optarg; break;
+            case 's': seed = (unsigned int)strtoul(optarg, NULL, 10); break;
+            default: usage(); return 1;
+        }
+    }
+    if (optind >= argc || n_sessions < 1) { usage(); return 1; }
+
+    int n_dirs = argc - optind;
+    level_list_t* lists = calloc(n_dirs, sizeof(level_list_t));
+    if (collect_levels(&argv[optind], n_dirs, lists) == 0) {
+        fprintf(stderr, "server: no levels found\n");
+        free(lists);
+        return 1;
+    }
+
+    session_t* sessions = calloc(n_sessions, sizeof(session_t));
+    server_pool = pool_create(workers);
+    uint64_t start = now_ns();
+
+    for (int i = 0; i < n_sessions; i++) {
+        session_t* s = &sessions[i];
+        s->id = i;
+        s->seed = seed + i; // Como o srand(seed + job) do batch
+        s->list = &lists[i % n_dirs];
+        s->start = start;
+        if (s->list->n_levels == 0 || start_level(s) != 0) {
+            finish_session(s, BATCH_LOAD_ERROR);
+            continue;
+        }
+        schedule_next(s);
+    }
+
+    pool_wait(server_pool);
+    double total_ms = (now_ns() - start) / 1e6;
+
+    pool_stats_t stats;
+    pool_get_stats(server_pool, &stats);
+    pool_destroy(server_pool);
+
+    FILE* out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) { perror(out_path); out = stdout; }
+    write_csv(out, sessions, n_sessions);
+    if (out != stdout) fclose(out);
+
+    long total_ticks = 0;
+    int failed = 0;
+    histogram_t lateness = {0};
+    for (int i = 0; i < n_sessions; i++) {
+        total_ticks += sessions[i].ticks;
+        if (sessions[i].status == BATCH_LOAD_ERROR) failed++;
+        hist_merge(&lateness, &sessions[i].lateness);
+        free(sessions[i].points);
+    }
+    fprintf(stderr, "server: %d sessions, %d workers, %.1f ms, %ld ticks (%.0f ticks/s), "
+                    "tasks %llu (stolen %llu, timed %llu), late p99 %.1f us, %d failed\n",
+            n_sessions, stats.workers, total_ms, total_ticks,
+            total_ms > 0 ? total_ticks / (total_ms / 1e3) : 0.0,
+            (unsigned long long)stats.executed, (unsigned long long)stats.stolen,
+            (unsigned long long)stats.timed, hist_percentile(&lateness, 99) / 1e3, failed);
+
+    for (int d = 0; d < n_dirs; d++) free(lists[d].levels);
+    free(lists);
+    free(sessions);
+    agent_cache_clear();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+#include "sim.h"
+#include "wheel.h"
+#include "chase.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void sim_pacman(board_t* board, int pacman_idx) {
+    pacman_t* pac = &board->pacmans[pacman_idx];
+    if (!pac->alive) return;
+
+    const instr_t* ins = script_fetch(board, pac->script, &pac->vm, pac->pos_x, pac->pos_y);
+    if (!ins) return;
+
+    if (ins->dir == 'G') { // Sem saves em modo headless
+        vm_advance(&pac->vm);
+        return;
+    }
+    if (ins->dir == 'Q') {
+        board->exit_status = GAME_QUIT;
+        board->game_running = 0;
+        return;
+    }
+
+    command_t cmd = { ins->dir, ins->arg, 1 };
+    update_game_status(board, move_pacman(board, pacman_idx, &cmd));
+}
+
+// Comando externo (tecla ou bot): não mexe na posição do script
+static void sim_pacman_command(board_t* board, int pacman_idx, char command) {
+    if (!board->pacmans[pacman_idx].alive || command == 'G') return;
+    if (command == 'Q') {
+        board->exit_status = GAME_QUIT;
+        board->game_running = 0;
+        return;
+    }
+    command_t cmd = { command, 1, 0 };
+    update_game_status(board, move_pacman(board, pacman_idx, &cmd));
+}
+
+static void sim_ghost(board_t* board, int ghost_idx) {
+    ghost_t* ghost = &board->ghosts[ghost_idx];
+    command_t cmd = { 'R', 1, 0 }; // Movimento aleatório se não houver ficheiro
+
+    if (script_runnable(ghost->script)) {
+        const instr_t* ins = script_fetch(board, ghost->script, &ghost->vm, ghost->pos_x, ghost->pos_y);
+        if (!ins) return;
+        cmd.command = ins->dir;
+        cmd.turns = ins->arg;
+        cmd.scripted = 1;
+    }
+    move_ghost(board, ghost_idx, &cmd);
+}
+
+// Agenda dos fantasmas: um fantasma só é visitado nos ticks em que pode
+// acontecer alguma coisa. Parado numa ação, cada tick até ela seria só um
+// "waiting--" do passo (o fetch não muda nada), por isso o fantasma é agendado
+// para daqui a waiting+1 ticks e chega lá com a espera toda cumprida. Num 'T',
+// as ações antes da última só descontam o vm.wait_left: o fantasma é agendado
+// para a ação que acaba o 'T' e as do meio são acertadas de uma vez.
+struct sim_sched {
+    timing_wheel_t* wheel;
+    uint64_t* first; // Tick da próxima ação de cada fantasma parado numa ação
+};
+
+// LOOP/IF/saltos por avaliar: o fetch do próximo tick pode mexer no pc (e lê o tabuleiro).
+// O pc só muda nas visitas, por isso a resposta é a mesma até à próxima
+static int ghost_at_action(const ghost_t* ghost) {
+    return !script_runnable(ghost->script) || ghost->script->code[ghost->vm.pc].op == OP_ACT;
+}
+
+static int ghost_at_wait(const ghost_t* ghost) {
+    if (!script_runnable(ghost->script)) return 0;
+    const instr_t* ins = &ghost->script->code[ghost->vm.pc];
+    return ins->op == OP_ACT && ins->dir == 'T';
+}
+
+// Ações que faltam ao 'T' atual, contando a que o acaba (como no vm_wait_tick)
+static int wait_actions(const ghost_t* ghost) {
+    if (ghost->vm.wait_left > 0) return ghost->vm.wait_left;
+    int turns = ghost->script->code[ghost->vm.pc].arg;
+    return (turns > 0) ? turns : 1;
+}
+
+// Agenda o fantasma (já jogado no tick 'now') para a próxima visita
+static void ghost_schedule(struct sim_sched* s, int g, const ghost_t* ghost, uint64_t now) {
+    uint64_t when = now + 1;
+    if (ghost_at_action(ghost)) {
+        s->first[g] = now + ghost->waiting + 1;
+        when = s->first[g];
+        if (ghost_at_wait(ghost)) when += (uint64_t)(wait_actions(ghost) - 1) * (ghost->passo + 1);
+    }
+    wheel_schedule(s->wheel, g, when);
+}
+
+// Acerta o waiting e o vm.wait_left de um fantasma parado numa ação com os
+// ticks até 'upto' (inclusive) que não foram visitados
+static void ghost_catch_up(struct sim_sched* s, int g, ghost_t* ghost, uint64_t upto) {
+    uint64_t first = s->first[g];
+    if (upto < first) {
+        ghost->waiting = (int)(first - upto - 1);
+    }
+    else { // Só num 'T': ações pelo meio, a última fica depois de 'upto'
+        uint64_t period = (uint64_t)ghost->passo + 1;
+        int actions = (int)((upto - first) / period) + 1;
+        ghost->waiting = ghost->passo - (int)((upto - first) % period);
+        ghost->vm.wait_left = wait_actions(ghost) - actions;
+    }
+    s->first[g] = upto + ghost->waiting + 1;
+}
+
+static struct sim_sched* sched_get(board_t* board) {
+    if (board->sched) return board->sched;
+    int n = board->n_ghosts > 0 ? board->n_ghosts : 1;
+    struct sim_sched* s = malloc(sizeof(struct sim_sched));
+    s->wheel = wheel_create(n, 0);
+    s->first = malloc(sizeof(uint64_t) * n);
+    for (int g = 0; g < board->n_ghosts; g++) ghost_schedule(s, g, &board->ghosts[g], 0);
+    board->sched = s;
+    return s;
+}
+
+void sim_sched_sync(board_t* board) {
+    struct sim_sched* s = board->sched;
+    if (!s) return;
+    uint64_t now = wheel_now(s->wheel);
+    for (int g = 0; g < board->n_ghosts; g++) {
+        // Parado numa ação: está na wheel para o tick dessa ação (ou do fim do 'T')
+        if (ghost_at_action(&board->ghosts[g])) ghost_catch_up(s, g, &board->ghosts[g], now);
+    }
+}
+
+void sim_sched_free(board_t* board) {
+    struct sim_sched* s = board->sched;
+    if (!s) return;
+    wheel_destroy(s->wheel);
+    free(s->first);
+    free(s);
+    board->sched = NULL;
+}
+
+// --- Cópias (sim_clone) ---
+
+struct sim_clone {
+    board_t board;
+    board_chunks_t chunks;    // Níveis em chunks: a tabela de tiles da cópia
+    board_pos_t* tile_block;  // ... e os seus tiles, seguidos
+    long* tile_of;            // Índice (na tabela) de cada tile alocado, pela ordem de tile_block
+    struct sim_sched sched;   // board.sched aponta para aqui (nunca passa pelo sim_sched_free)
+    unsigned int seed;        // board.rand_seed aponta para aqui
+};
+
+sim_clone_t* sim_clone_create(const board_t* source, unsigned int seed) {
+    sim_clone_t* clone = calloc(1, sizeof(sim_clone_t));
+    if (!clone) return NULL;
+    board_t* b = &clone->board;
+
+    b->width = source->width;
+    b->height = source->height;
+    b->n_pacmans = source->n_pacmans;
+    b->n_ghosts = source->n_ghosts;
+    b->tempo = source->tempo;
+    memcpy(b->level_name, source->level_name, sizeof(b->level_name));
+    pthread_mutex_init(&b->board_lock, NULL);
+    pthread_mutex_init(&b->global_stats_lock, NULL); // Só para o chase_get alocar o campo
+    atomic_init(&b->chase, NULL);
+    atomic_init(&b->pacman_version, 0);
+    atomic_init(&b->generation, 0);
+    atomic_init(&b->render_armed, 0);
+    b->wake_fd[0] = b->wake_fd[1] = -1;
+    b->rows_owned = 1; // Uma só thread por cópia: sem row locks nem board_changed
+    b->quiet = 1;
+    clone->seed = seed;
+    b->rand_seed = &clone->seed;
+
+    b->pacmans = malloc(sizeof(pacman_t) * (b->n_pacmans > 0 ? b->n_pacmans : 1));
+    b->ghosts = malloc(sizeof(ghost_t) * (b->n_ghosts > 0 ? b->n_ghosts : 1));
+    clone->sched.wheel = wheel_create(b->n_ghosts > 0 ? b->n_ghosts : 1, 0);
+    clone->sched.first = malloc(sizeof(uint64_t) * (b->n_ghosts > 0 ? b->n_ghosts : 1));
+    b->sched = &clone->sched;
+    int ok = b->pacmans && b->ghosts && clone->sched.wheel && clone->sched.first;
+
+    if (source->board) {
+        b->board = malloc(sizeof(board_pos_t) * (size_t)b->width * b->height);
+        ok = ok && b->board;
+    }
+    else {
+        const board_chunks_t* from = source->chunks;
+        long n_tiles = (long)from->tiles_w * from->tiles_h;
+        clone->chunks.tiles_w = from->tiles_w;
+        clone->chunks.tiles_h = from->tiles_h;
+        clone->chunks.n_allocated = from->n_allocated;
+        // A ordem dos tiles não muda depois do load: a cópia usa as tabelas do original (não as liberta)
+        clone->chunks.tile_order = from->tile_order;
+        clone->chunks.allocated = from->allocated;
+        clone->chunks.tiles = calloc(n_tiles, sizeof(board_pos_t*));
+        clone->tile_block = malloc(sizeof(board_pos_t) * BOARD_TILE * BOARD_TILE * (from->n_allocated > 0 ? from->n_allocated : 1));
+        clone->tile_of = malloc(sizeof(long) * (from->n_allocated > 0 ? from->n_allocated : 1));
+        b->chunks = &clone->chunks;
+        ok = ok && clone->chunks.tiles && clone->tile_block && clone->tile_of;
+        for (long t = 0, k = 0; ok && t < n_tiles; t++) {
+            if (!from->tiles[t]) continue;
+            clone->chunks.tiles[t] = clone->tile_block + k * BOARD_TILE * BOARD_TILE;
+            clone->tile_of[k++] = t;
+        }
+    }
+
+    if (!ok) {
+        sim_clone_free(clone);
+        return NULL;
+    }
+    sim_clone_copy(clone, source);
+    return clone;
+}
+
+void sim_clone_copy(sim_clone_t* clone, const board_t* source) {
+    board_t* b = &clone->board;
+
+    if (b->board) {
+        memcpy(b->board, source->board, sizeof(board_pos_t) * (size_t)b->width * b->height);
+    }
+    else {
+        for (long k = 0; k < clone->chunks.n_allocated; k++) {
+            long t = clone->tile_of[k];
+            memcpy(clone->chunks.tiles[t], source->chunks->tiles[t], sizeof(board_pos_t) * BOARD_TILE * BOARD_TILE);
+        }
+    }
+    memcpy(b->pacmans, source->pacmans, sizeof(pacman_t) * b->n_pacmans);
+    memcpy(b->ghosts, source->ghosts, sizeof(ghost_t) * b->n_ghosts);
+    b->game_running = source->game_running;
+    b->exit_status = source->exit_status;
+    b->next_pacman_cmd = '\0';
+    b->save_request = 0;
+
+    // A versão da cópia só cresce: o campo de caça da cópia anterior fica desatualizado
+    chase_invalidate(b);
+
+    // A agenda recomeça do waiting de cada fantasma, como no primeiro sim_step
+    wheel_reset(clone->sched.wheel, 0);
+    for (int g = 0; g < b->n_ghosts; g++) ghost_schedule(&clone->sched, g, &b->ghosts[g], 0);
+}
+
+board_t* sim_clone_board(sim_clone_t* clone) {
+    return &clone->board;
+}
+
+void sim_clone_free(sim_clone_t* clone) {
+    if (!clone) return;
+    board_t* b = &clone->board;
+    chase_free(b);
+    wheel_destroy(clone->sched.wheel);
+    free(clone->sched.first);
+    pthread_mutex_destroy(&b->board_lock);
+    pthread_mutex_destroy(&b->global_stats_lock);
+    free(b->board);
+    free(b->pacmans);
+    free(b->ghosts);
+    free(clone->chunks.tiles);
+    free(clone->tile_block);
+    free(clone->tile_of);
+    free(clone);
+}
+
+// --- Ticks ---
+
+int sim_step(board_t* board) {
+    return sim_step_with(board, NULL);
+}
+
+int sim_step_with(board_t* board, const char* pacman_cmds) {
+    for (int p = 0; p < board->n_pacmans && board->game_running; p++) {
+        if (pacman_cmds && pacman_cmds[p] != '\0') sim_pacman_command(board, p, pacman_cmds[p]);
+        else sim_pacman(board, p);
+    }
+
+    struct sim_sched* s = sched_get(board);
+    const int* due;
+    int n_due = wheel_advance(s->wheel, &due);
+    uint64_t now = wheel_now(s->wheel);
+    for (int i = 0; i < n_due; i++) {
+        int g = due[i];
+        ghost_t* ghost = &board->ghosts[g];
+        if (ghost_at_action(ghost)) ghost_catch_up(s, g, ghost, now - 1); // Os ticks que não foram visitados
+        if (board->game_running) sim_ghost(board, g); // Fim do nível a meio do tick: fica para o seguinte
+        ghost_schedule(s, g, ghost, now);
+    }
+
+    // Um fantasma pode ter morto o último pacman neste tick
+    if (board->game_running && pacmans_alive(board) == 0) {
+        board->exit_status = GAME_LOST;
+        board->game_running = 0;
+    }
+    return board->game_running;
+}
+
+long sim_run(board_t* board, long max_ticks, int* status) {
+    long ticks = 0;
+    while (board->game_running && (max_ticks <= 0 || ticks < max_ticks)) {
+        sim_step(board);
+        ticks++;
+    }
+
+    if (board->game_running) board->exit_status = GAME_TIMEOUT;
+    if (status) *status = board->exit_status;
+    return ticks;
+}
@@ -0,0 +1,127 @@
+#include "board.h"
+#include "files.h"
+#include "script.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+// Verificação da agenda dos fantasmas do sim_step (timing wheel, ver sim.h):
+// o mesmo nível corre pelo sim_step e por um ciclo que joga todos os fantasmas
+// em todos os ticks (o caminho sem agenda). Os fantasmas têm de acabar no
+// mesmo estado, e um 'T n' tem de custar uma visita e não n.
+// Sai com 1 (e uma mensagem no stderr) se alguma coisa falhar.
+
+#define TICKS 3000
+
+static const char level_text[] =
+    "DIM 12 12\nTEMPO 0\nPAC check.p\nMON t500.m t200.m t1.m t0.m\n"
+    "XXXXXXXXXXXX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XooooooooooX\n"
+    "XXXXXXXXXXXX\n";
+
+// Pacman sem comandos (fica parado); fantasmas com esperas de vários tamanhos e PASSOs
+static const agent_text_t agents[] = {
+    { "check.p", "PASSO 0\nPOS 10 10\n" },
+    { "t500.m",  "PASSO 0\nPOS 2 2\nT 500\nD\nT 500\nA\n" },
+    { "t200.m",  "PASSO 3\nPOS 2 4\nT 200\nD\nA\n" },
+    { "t1.m",    "PASSO 2\nPOS 2 6\nD\nT 1\nA\nT 7\n" },
+    { "t0.m",    "PASSO 1\nPOS 2 8\nT 0\nD\nT 33\nA\n" },
+};
+
+static int load(board_t* board) {
+    return load_level_memory(board, "check", level_text, agents, sizeof(agents) / sizeof(agents[0]), NULL, 0);
+}
+
+// Um tick sem agenda: todos os fantasmas jogam (como o sim_ghost)
+static void step_every_ghost(board_t* board) {
+    for (int g = 0; g < board->n_ghosts; g++) {
+        ghost_t* ghost = &board->ghosts[g];
+        const instr_t* ins = script_fetch(board, ghost->script, &ghost->vm, ghost->pos_x, ghost->pos_y);
+        if (!ins) continue;
+        command_t cmd = { ins->dir, ins->arg, 1 };
+        move_ghost(board, g, &cmd);
+    }
+}
+
+static int same_ghost(const ghost_t* a, const ghost_t* b) {
+    return a->pos_x == b->pos_x && a->pos_y == b->pos_y && a->waiting == b->waiting &&
+           a->vm.pc == b->vm.pc && a->vm.wait_left == b->vm.wait_left;
+}
+
+static int compare(const board_t* got, const board_t* want, const char* run, int tick) {
+    int failed = 0;
+    for (int g = 0; g < want->n_ghosts; g++) {
+        const ghost_t* a = &got->ghosts[g];
+        const ghost_t* b = &want->ghosts[g];
+        if (same_ghost(a, b)) continue;
+        fprintf(stderr, "simcheck: %s, tick %d, ghost %d: pos %d,%d waiting %d pc %d wait_left %d"
+                " (expected pos %d,%d waiting %d pc %d wait_left %d)\n",
+                run, tick, g, a->pos_x, a->pos_y, a->waiting, a->vm.pc, a->vm.wait_left,
+                b->pos_x, b->pos_y, b->waiting, b->vm.pc, b->vm.wait_left);
+        failed = 1;
+    }
+    return failed;
+}
+
+int main(void) {
+    board_t want, lazy, synced;
+    memset(&want, 0, sizeof(want));
+    memset(&lazy, 0, sizeof(lazy));
+    memset(&synced, 0, sizeof(synced));
+    open_debug_file("/dev/null");
+    if (load(&want) != 0 || load(&lazy) != 0 || load(&synced) != 0) {
+        fprintf(stderr, "simcheck: failed to load the level\n");
+        return 1;
+    }
+
+    // lazy: só o sim_step; uma visita é um tick em que o fantasma muda.
+    // synced: sim_sched_sync depois de cada tick, comparado tick a tick
+    int n = want.n_ghosts;
+    int visits[n], actions[n];
+    ghost_t before[n];
+    memset(visits, 0, sizeof(visits));
+    memset(actions, 0, sizeof(actions));
+    int failed = 0;
+    for (int t = 1; t <= TICKS && !failed; t++) {
+        memcpy(before, want.ghosts, sizeof(before));
+        step_every_ghost(&want);
+        for (int g = 0; g < n; g++) actions[g] += want.ghosts[g].vm.pc != before[g].vm.pc;
+
+        memcpy(before, lazy.ghosts, sizeof(before));
+        sim_step(&lazy);
+        for (int g = 0; g < n; g++) visits[g] += !same_ghost(&lazy.ghosts[g], &before[g]);
+
+        sim_step(&synced);
+        sim_sched_sync(&synced);
+        failed = compare(&synced, &want, "sim_sched_sync every tick", t);
+    }
+    if (!failed) {
+        sim_sched_sync(&lazy);
+        failed = compare(&lazy, &want, "sim_sched_sync at the end", TICKS);
+    }
+
+    // Cada visita tem de acabar uma ação (mudar o pc): as esperas não são visitadas
+    for (int g = 0; g < n && !failed; g++) {
+        printf("ghost %d: %d visits, %d actions in %d ticks\n", g, visits[g], actions[g], TICKS);
+        if (visits[g] > actions[g]) {
+            fprintf(stderr, "simcheck: ghost %d visited %d times for %d actions\n", g, visits[g], actions[g]);
+            failed = 1;
+        }
+    }
+
+    unload_level(&want);
+    unload_level(&lazy);
+    unload_level(&synced);
+    close_debug_file();
+    if (!failed) printf("simcheck: ok\n");
+    return failed;
+}
@@ -0,0 +1,162 @@
+#include "spectate.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+// Estado do publicador (o jogo só publica de uma thread: a da UI)
+static int shm_fd = -1;
+static spectate_header_t* shm_frame = NULL;
+static size_t shm_mapped = 0;
+static char shm_name[MAX_FILENAME];
+static pid_t shm_owner; // O filho do quicksave publica no mesmo segmento mas não o remove
+
+static size_t frame_size(int height, int width, int n_pacmans, int n_ghosts) {
+    return sizeof(spectate_header_t) + (size_t)height * width
+         + sizeof(spectate_pacman_t) * n_pacmans + sizeof(spectate_ghost_t) * n_ghosts
+         + 16; // Folga para alinhar os arrays dos agentes
+}
+
+// Garante que o segmento tem pelo menos 'size' bytes
+static int shm_reserve(size_t size) {
+    if (size <= shm_mapped) return 0;
+    if (ftruncate(shm_fd, size) == -1) return -1;
+
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (map == MAP_FAILED) return -1;
+    if (shm_frame) munmap(shm_frame, shm_mapped);
+    shm_frame = map;
+    shm_mapped = size;
+    return 0;
+}
+
+int spectate_open(const char* name) {
+    snprintf(shm_name, sizeof(shm_name), "%s", name);
+    shm_fd = shm_open(shm_name, O_CREAT | O_RDWR, 0644);
+    if (shm_fd == -1) {
+        perror("shm_open");
+        return -1;
+    }
+    if (shm_reserve(sizeof(spectate_header_t)) != 0) {
+        perror("spectate");
+        close(shm_fd);
+        shm_unlink(shm_name);
+        shm_fd = -1;
+        return -1;
+    }
+    shm_owner = getpid();
+
+    shm_frame->magic = SPECTATE_MAGIC;
+    shm_frame->running = 1;
+    atomic_store(&shm_frame->seq, 0);
+    shm_frame->size = sizeof(spectate_header_t);
+    return 0;
+}
+
+static char cell_char(const board_pos_t* cell) {
+    switch (cell->content) {
+        case 'W': return '#';
+        case 'P': return 'C';
+        case 'M': return 'M';
+        default:
+            if (cell->has_portal) return '@';
+            if (cell->has_dot) return '.';
+            return ' ';
+    }
+}
+
+void spectate_publish(board_t* board, int mode) {
+    if (!shm_frame) return;
+
+    size_t size = frame_size(board->height, board->width, board->n_pacmans, board->n_ghosts);
+    if (shm_reserve(size) != 0) return; // Sem memória: salta este frame
+
+    spectate_header_t* f = shm_frame;
+    size_t cells_off = sizeof(spectate_header_t);
+    size_t pacmans_off = (cells_off + (size_t)board->height * board->width + 7) & ~(size_t)7;
+    size_t ghosts_off = pacmans_off + sizeof(spectate_pacman_t) * board->n_pacmans;
+
+    // Seqlock: seq ímpar durante a escrita
+    uint64_t seq = atomic_load_explicit(&f->seq, memory_order_relaxed);
+    atomic_store_explicit(&f->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    f->size = size;
+    f->frame++;
+    f->mode = mode;
+    f->height = board->height;
+    f->width = board->width;
+    f->n_pacmans = board->n_pacmans;
+    f->n_ghosts = board->n_ghosts;
+    snprintf(f->level_name, sizeof(f->level_name), "%s", board->level_name);
+    f->cells_off = cells_off;
+    f->pacmans_off = pacmans_off;
+    f->ghosts_off = ghosts_off;
+
+    char* cells = (char*)f + cells_off;
+    if (board->board) {
+        long n_cells = (long)board->height * board->width;
+        for (long i = 0; i < n_cells; i++) cells[i] = cell_char(&board->board[i]);
+    } else {
+        for (int y = 0; y < board->height; y++) {
+            for (int x = 0; x < board->width; x++) cells[(long)y * board->width + x] = cell_char(board_cell(board, x, y));
+        }
+    }
+
+    spectate_pacman_t* pacs = (spectate_pacman_t*)((char*)f + pacmans_off);
+    for (int p = 0; p < board->n_pacmans; p++) {
+        pacs[p].x = board->pacmans[p].pos_x;
+        pacs[p].y = board->pacmans[p].pos_y;
+        pacs[p].alive = board->pacmans[p].alive;
+        pacs[p].points = board->pacmans[p].points;
+    }
+
+    spectate_ghost_t* ghosts = (spectate_ghost_t*)((char*)f + ghosts_off);
+    for (int g = 0; g < board->n_ghosts; g++) {
+        ghosts[g].x = board->ghosts[g].pos_x;
+        ghosts[g].y = board->ghosts[g].pos_y;
+        ghosts[g].charged = board->ghosts[g].charged;
+    }
+
+    atomic_store_explicit(&f->seq, seq + 2, memory_order_release);
+}
+
+void spectate_close(void) {
+    if (!shm_frame) return;
+
+    uint64_t seq = atomic_load_explicit(&shm_frame->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm_frame->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    shm_frame->running = 0;
+    atomic_store_explicit(&shm_frame->seq, seq + 2, memory_order_release);
+
+    munmap(shm_frame, shm_mapped);
+    close(shm_fd);
+    if (getpid() == shm_owner) shm_unlink(shm_name);
+    shm_frame = NULL;
+    shm_mapped = 0;
+    shm_fd = -1;
+}
+
+size_t spectate_read(const spectate_header_t* shm, size_t mapped, void* buf, size_t cap) {
+    // Limite de tentativas: um jogo morto a meio de uma escrita deixa seq ímpar para sempre
+    for (int tries = 0; tries < 1000; tries++) {
+        uint64_t before = atomic_load_explicit(&shm->seq, memory_order_acquire);
+        if (before & 1) { // Escrita a meio
+            sched_yield();
+            continue;
+        }
+
+        size_t size = shm->size;
+        if (size <= mapped && size <= cap) memcpy(buf, shm, size);
+
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t after = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+        if (before != after) continue;
+
+        // size > mapped/cap: o chamador tem de remapear ou crescer o buffer
+        return size;
+    }
+    return 0;
+}
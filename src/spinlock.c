@@ -0,0 +1,72 @@
+#define _GNU_SOURCE // syscall(SYS_futex)
+#include "spinlock.h"
+#include <sched.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Dorme enquanto state == value (sem futex: cede o CPU)
+static void futex_wait(atomic_int* addr, int value) {
+#ifdef __linux__
+    syscall(SYS_futex, (int*)addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    if (atomic_load_explicit(addr, memory_order_relaxed) == value) sched_yield();
+#endif
+}
+
+static void futex_wake_one(atomic_int* addr) {
+#ifdef __linux__
+    syscall(SYS_futex, (int*)addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void)addr;
+#endif
+}
+
+void spin_lock_init(spin_lock_t* lock) {
+    atomic_init(&lock->state, 0);
+}
+
+// Com um só CPU o dono do lock não corre enquanto esperamos: girar é só desperdício
+static int max_backoff(void) {
+    static atomic_int limit = -1;
+    int value = atomic_load_explicit(&limit, memory_order_relaxed);
+    if (value < 0) {
+        value = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? SPIN_MAX_BACKOFF : 0;
+        atomic_store_explicit(&limit, value, memory_order_relaxed);
+    }
+    return value;
+}
+
+void spin_lock_slow(spin_lock_t* lock) {
+    // 1. Backoff exponencial: só lê (a linha de cache fica partilhada) e tenta quando parece livre
+    int limit = max_backoff();
+    for (int backoff = 1; backoff <= limit; backoff <<= 1) {
+        for (int i = 0; i < backoff; i++) cpu_relax();
+        int expected = 0;
+        if (atomic_load_explicit(&lock->state, memory_order_relaxed) == 0 &&
+            atomic_compare_exchange_weak_explicit(&lock->state, &expected, 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return;
+        }
+    }
+
+    // 2. Dormir: marcar o lock como "com threads à espera" (2) para o unlock acordar alguém.
+    // Quem o apanha assim fica com 2, o que pode custar um wake a mais mas nunca um a menos.
+    while (atomic_exchange_explicit(&lock->state, 2, memory_order_acquire) != 0) {
+        futex_wait(&lock->state, 2);
+    }
+}
+
+void spin_unlock_wake(spin_lock_t* lock) {
+    futex_wake_one(&lock->state);
+}
@@ -0,0 +1,185 @@
+#include "spectate.h"
+#include "display.h"
+#include <ncurses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Espectador: mapeia (só leitura) o frame buffer publicado pelo jogo com
+// --spectate e desenha-o. Não mexe no jogo: o jogo nunca espera por nós.
+
+#define VIEWER_FPS_MS 33
+#define VIEWER_RETRY_MS 250
+
+typedef struct {
+    int fd;
+    const spectate_header_t* shm;
+    size_t mapped;
+} viewer_map_t;
+
+static void viewer_sleep(int milliseconds) {
+    struct timespec ts = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void unmap_frame(viewer_map_t* m) {
+    if (m->shm) munmap((void*)m->shm, m->mapped);
+    if (m->fd != -1) close(m->fd);
+    m->shm = NULL;
+    m->mapped = 0;
+    m->fd = -1;
+}
+
+// (Re)mapeia o segmento com o tamanho que tem agora
+static int map_frame(viewer_map_t* m, const char* name) {
+    if (m->fd == -1) {
+        m->fd = shm_open(name, O_RDONLY, 0);
+        if (m->fd == -1) return -1;
+    }
+
+    struct stat st;
+    if (fstat(m->fd, &st) == -1 || (size_t)st.st_size < sizeof(spectate_header_t)) {
+        unmap_frame(m);
+        return -1;
+    }
+
+    if (m->shm) munmap((void*)m->shm, m->mapped);
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, m->fd, 0);
+    if (map == MAP_FAILED) {
+        m->shm = NULL;
+        unmap_frame(m);
+        return -1;
+    }
+    m->shm = map;
+    m->mapped = st.st_size;
+    return 0;
+}
+
+// Os offsets vêm de outro processo: confirmar que cabem no que foi copiado
+static int frame_fits(const spectate_header_t* f, size_t size) {
+    if (f->height < 0 || f->width < 0 || f->n_pacmans < 0 || f->n_ghosts < 0) return 0;
+    return f->cells_off + (uint64_t)f->height * f->width <= size
+        && f->pacmans_off + sizeof(spectate_pacman_t) * (uint64_t)f->n_pacmans <= size
+        && f->ghosts_off + sizeof(spectate_ghost_t) * (uint64_t)f->n_ghosts <= size;
+}
+
+static void draw_waiting(const char* name, const char* why) {
+    clear();
+    attron(COLOR_PAIR(5));
+    mvprintw(0, 0, "=== PACMAN SPECTATOR ===");
+    mvprintw(1, 0, "%s: %s | Q to quit", name, why);
+    attroff(COLOR_PAIR(5));
+    refresh();
+}
+
+static void draw_frame(const spectate_header_t* f, const char* name) {
+    const char* cells = (const char*)f + f->cells_off;
+    const spectate_pacman_t* pacs = (const spectate_pacman_t*)((const char*)f + f->pacmans_off);
+    const spectate_ghost_t* ghosts = (const spectate_ghost_t*)((const char*)f + f->ghosts_off);
+
+    clear();
+    attron(COLOR_PAIR(5));
+    mvprintw(0, 0, "=== PACMAN SPECTATOR === %s | frame %llu | Q to quit", name, (unsigned long long)f->frame);
+    switch (f->mode) {
+        case DRAW_GAME_OVER: mvprintw(1, 0, " GAME OVER "); break;
+        case DRAW_WIN: mvprintw(1, 0, " VICTORY "); break;
+        default: mvprintw(1, 0, "Level: %s", f->level_name); break;
+    }
+    attroff(COLOR_PAIR(5));
+
+    // Mesmas cores que o draw_board do jogo
+    int start_row = 3;
+    for (int y = 0; y < f->height; y++) {
+        move(start_row + y, 0);
+        for (int x = 0; x < f->width; x++) {
+            char c = cells[y * f->width + x];
+            int attr = 0;
+            switch (c) {
+                case '#': attr = COLOR_PAIR(3); break;
+                case 'C': attr = COLOR_PAIR(1) | A_BOLD; break;
+                case 'M': attr = COLOR_PAIR(2) | A_BOLD; break;
+                case '.': attr = COLOR_PAIR(4); break;
+                case '@': attr = COLOR_PAIR(6); break;
+            }
+            attron(attr);
+            addch(c);
+            attroff(attr);
+        }
+    }
+
+    // Fantasmas carregados aparecem esbatidos
+    for (int g = 0; g < f->n_ghosts; g++) {
+        if (!ghosts[g].charged || ghosts[g].x < 0 || ghosts[g].y < 0) continue;
+        attron(COLOR_PAIR(2) | A_BOLD | A_DIM);
+        mvaddch(start_row + ghosts[g].y, ghosts[g].x, 'M');
+        attroff(COLOR_PAIR(2) | A_BOLD | A_DIM);
+    }
+
+    attron(COLOR_PAIR(5));
+    move(start_row + f->height + 1, 0);
+    printw("Points:");
+    for (int p = 0; p < f->n_pacmans; p++) {
+        printw(" P%d %d%s |", p + 1, pacs[p].points, pacs[p].alive ? "" : " (dead)");
+    }
+    attroff(COLOR_PAIR(5));
+    refresh();
+}
+
+int main(int argc, char** argv) {
+    const char* name = (argc > 1) ? argv[1] : SPECTATE_DEFAULT_NAME;
+
+    terminal_init();
+
+    viewer_map_t m = { -1, NULL, 0 };
+    char* buf = NULL;
+    size_t cap = 0;
+    uint64_t last_frame = 0;
+
+    while (get_input() != 'Q') {
+        if (!m.shm && map_frame(&m, name) != 0) {
+            draw_waiting(name, "waiting for a game (Pacmanist --spectate)");
+            viewer_sleep(VIEWER_RETRY_MS);
+            continue;
+        }
+
+        size_t size = spectate_read(m.shm, m.mapped, buf, cap);
+        if (size > m.mapped) { // O tabuleiro cresceu: remapear
+            map_frame(&m, name);
+            continue;
+        }
+        if (size > cap) {
+            free(buf);
+            buf = malloc(size);
+            cap = buf ? size : 0;
+            continue;
+        }
+
+        const spectate_header_t* f = (const spectate_header_t*)buf;
+        if (size == 0 || f->magic != SPECTATE_MAGIC || !frame_fits(f, size)) {
+            viewer_sleep(VIEWER_RETRY_MS);
+            continue;
+        }
+        if (!f->running) {
+            // O jogo terminou: largar o segmento e esperar pelo próximo
+            unmap_frame(&m);
+            last_frame = 0;
+            draw_waiting(name, "game ended, waiting for the next one");
+            viewer_sleep(VIEWER_RETRY_MS);
+            continue;
+        }
+
+        if (f->frame != last_frame && f->frame > 0) {
+            draw_frame(f, name);
+            last_frame = f->frame;
+        }
+        viewer_sleep(VIEWER_FPS_MS);
+    }
+
+    unmap_frame(&m);
+    free(buf);
+    terminal_cleanup();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "wheel.h"
+#include <stdlib.h>
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_NONE -1
+
+struct timing_wheel {
+    uint64_t now;
+    int n_items;
+    int* next;      // Lista ligada de cada slot (índices dos itens)
+    uint64_t* when; // Tick em que cada item está agendado
+    int slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    int overflow;   // Itens além do último nível
+    int* soon;      // Itens do próximo tick, pela ordem em que foram agendados
+    int n_soon;
+    int soon_sorted;
+    int* ready;     // Itens devolvidos pelo último wheel_advance (troca com soon)
+    int* scratch;   // Itens do slot do tick atual, antes de juntar aos de soon
+};
+
+// Nível de um tick: o primeiro em que os bits acima dele coincidem com os de now
+static void place(timing_wheel_t* w, int item) {
+    uint64_t when = w->when[item];
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        int shift = WHEEL_BITS * (level + 1);
+        if ((when >> shift) == (w->now >> shift)) {
+            int* slot = &w->slots[level][(when >> (WHEEL_BITS * level)) & WHEEL_MASK];
+            w->next[item] = *slot;
+            *slot = item;
+            return;
+        }
+    }
+    w->next[item] = w->overflow;
+    w->overflow = item;
+}
+
+// Volta a colocar os itens de uma lista (cascata: descem de nível)
+static void replace_list(timing_wheel_t* w, int head) {
+    while (head != WHEEL_NONE) {
+        int item = head;
+        head = w->next[item];
+        place(w, item);
+    }
+}
+
+timing_wheel_t* wheel_create(int n_items, uint64_t now) {
+    timing_wheel_t* w = calloc(1, sizeof(timing_wheel_t));
+    if (!w) return NULL;
+    w->n_items = n_items;
+    w->next = malloc(sizeof(int) * (n_items > 0 ? n_items : 1));
+    w->when = malloc(sizeof(uint64_t) * (n_items > 0 ? n_items : 1));
+    w->soon = malloc(sizeof(int) * (n_items > 0 ? n_items : 1));
+    w->ready = malloc(sizeof(int) * (n_items > 0 ? n_items : 1));
+    w->scratch = malloc(sizeof(int) * (n_items > 0 ? n_items : 1));
+    if (!w->next || !w->when || !w->soon || !w->ready || !w->scratch) {
+        wheel_destroy(w);
+        return NULL;
+    }
+    wheel_reset(w, now);
+    return w;
+}
+
+void wheel_destroy(timing_wheel_t* w) {
+    if (!w) return;
+    free(w->next);
+    free(w->when);
+    free(w->soon);
+    free(w->ready);
+    free(w->scratch);
+    free(w);
+}
+
+void wheel_reset(timing_wheel_t* w, uint64_t now) {
+    w->now = now;
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        for (int s = 0; s < WHEEL_SLOTS; s++) w->slots[level][s] = WHEEL_NONE;
+    }
+    w->overflow = WHEEL_NONE;
+    w->n_soon = 0;
+    w->soon_sorted = 1;
+}
+
+void wheel_schedule(timing_wheel_t* w, int item, uint64_t when) {
+    if (when <= w->now + 1) {
+        // Caso comum (agentes sem PASSO): sem listas nem cascatas
+        if (w->n_soon > 0 && w->soon[w->n_soon - 1] > item) w->soon_sorted = 0;
+        w->soon[w->n_soon++] = item;
+        w->when[item] = w->now + 1;
+        return;
+    }
+    w->when[item] = when;
+    place(w, item);
+}
+
+static int compare_items(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+static void sort_items(int* items, int n) {
+    int ascending = 1, descending = 1;
+    for (int i = 1; i < n && (ascending || descending); i++) {
+        ascending &= items[i - 1] < items[i];
+        descending &= items[i - 1] > items[i];
+    }
+    if (ascending) return;
+    if (descending) {
+        for (int i = 0, j = n - 1; i < j; i++, j--) { int t = items[i]; items[i] = items[j]; items[j] = t; }
+    }
+    else qsort(items, n, sizeof(int), compare_items);
+}
+
+int wheel_advance(timing_wheel_t* w, const int** due) {
+    uint64_t now = ++w->now;
+
+    // Cascata de cima para baixo: cada nível cujo índice deu a volta desce o
+    // slot atual do nível de cima antes de o nível de baixo ser lido
+    if ((now & ((1ull << (WHEEL_BITS * WHEEL_LEVELS)) - 1)) == 0) {
+        int head = w->overflow;
+        w->overflow = WHEEL_NONE;
+        replace_list(w, head);
+    }
+    int top = 0;
+    while (top < WHEEL_LEVELS - 1 && ((now >> (WHEEL_BITS * (top + 1))) << (WHEEL_BITS * (top + 1))) == now) top++;
+    for (int level = top; level >= 1; level--) {
+        int* slot = &w->slots[level][(now >> (WHEEL_BITS * level)) & WHEEL_MASK];
+        int head = *slot;
+        *slot = WHEEL_NONE;
+        replace_list(w, head);
+    }
+
+    int n_slot = 0;
+    int* slot = &w->slots[0][now & WHEEL_MASK];
+    for (int item = *slot; item != WHEEL_NONE; item = w->next[item]) w->scratch[n_slot++] = item;
+    *slot = WHEEL_NONE;
+
+    // A simulação quer os índices por ordem: as listas saem pela ordem inversa
+    // da inserção e os de soon vêm, em geral, já ordenados
+    int n_soon = w->n_soon;
+    if (!w->soon_sorted) sort_items(w->soon, n_soon);
+    int* out = w->soon;
+    int n = n_soon;
+    if (n_slot > 0) {
+        sort_items(w->scratch, n_slot);
+        int i = 0, j = 0;
+        n = 0;
+        out = w->ready;
+        while (i < n_soon && j < n_slot) out[n++] = (w->soon[i] < w->scratch[j]) ? w->soon[i++] : w->scratch[j++];
+        while (i < n_soon) out[n++] = w->soon[i++];
+        while (j < n_slot) out[n++] = w->scratch[j++];
+    }
+    else {
+        // Devolve o próprio soon (sem copiar) e os próximos vão para o outro buffer
+        w->soon = w->ready;
+        w->ready = out;
+    }
+    w->n_soon = 0;
+    w->soon_sorted = 1;
+    *due = out;
+    return n;
+}
+
+uint64_t wheel_when(const timing_wheel_t* w, int item) {
+    return w->when[item];
+}
+
+uint64_t wheel_now(const timing_wheel_t* w) {
+    return w->now;
+}